@@ -32,7 +32,8 @@
 * limits memory fragmentation.
 *
 * This implementation is based on heap_4.c and add the function pvPortRealloc()
-* to the original implementation.
+* to the original implementation, as well as the statistics declared in
+* heap_4_infinitime.h.
 *
 * See heap_1.c, heap_2.c and heap_3.c for alternative implementations, and the
 * memory management pages of http://www.FreeRTOS.org for more information.
@@ -47,6 +48,7 @@ task.h is included from an application file. */
 
 #include "FreeRTOS.h"
 #include "task.h"
+#include "heap_4_infinitime.h"
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
@@ -93,6 +95,17 @@ static void prvInsertBlockIntoFreeList( BlockLink_t *pxBlockToInsert );
 */
 static void prvHeapInit( void );
 
+/*
+* The allocator behind pvPortMalloc() and pvPortRealloc(), pvCaller being the
+* code that requested the memory.
+*/
+static void *prvMalloc( size_t xWantedSize, void *pvCaller );
+
+/*
+* Adds a successful allocation to the statistics.
+*/
+static void prvRecordAllocation( size_t xRequestedSize, void *pvCaller );
+
 /*-----------------------------------------------------------*/
 
 /* The size of the structure placed at the beginning of each allocated memory
@@ -107,6 +120,20 @@ fragmentation. */
 static size_t xFreeBytesRemaining = 0U;
 static size_t xMinimumEverFreeBytesRemaining = 0U;
 
+/* Lowest number of free bytes since the last call to vPortResetHeapWatermark(). */
+static size_t xWatermarkFreeBytes = 0U;
+
+/* Statistics returned by vPortGetHeapStatistics(). */
+static size_t xNumberOfSuccessfulAllocations = 0U;
+static size_t xNumberOfSuccessfulFrees = 0U;
+static size_t xNumberOfFailedAllocations = 0U;
+static size_t xAllocationSizeHistogram[ heapHISTOGRAM_BUCKETS ] = { 0U };
+
+#if( configHEAP_TRACK_CALLERS == 1 )
+ static HeapCaller_t xCallers[ heapMAX_CALLERS ];
+ static size_t uxNumberOfCallers = 0U;
+#endif
+
 /* Gets set to the top bit of an size_t type.  When this bit in the xBlockSize
 member of an BlockLink_t structure is set then the block belongs to the
 application.  When the bit is free the block is still part of the free heap
@@ -116,9 +143,24 @@ static size_t xBlockAllocatedBit = 0;
 /*-----------------------------------------------------------*/
 
 void *pvPortMalloc( size_t xWantedSize )
+{
+ return prvMalloc( xWantedSize, __builtin_return_address( 0 ) );
+}
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_TRACK_CALLERS == 1 )
+ void *pvPortMallocFrom( size_t xWantedSize, void *pvCaller )
+ {
+   return prvMalloc( xWantedSize, pvCaller );
+ }
+#endif
+/*-----------------------------------------------------------*/
+
+static void *prvMalloc( size_t xWantedSize, void *pvCaller )
 {
  BlockLink_t *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
  void *pvReturn = NULL;
+ size_t xRequestedSize = xWantedSize;
 
  vTaskSuspendAll();
  {
@@ -229,6 +271,17 @@ void *pvPortMalloc( size_t xWantedSize )
            mtCOVERAGE_TEST_MARKER();
          }
 
+         if( xFreeBytesRemaining < xWatermarkFreeBytes )
+         {
+           xWatermarkFreeBytes = xFreeBytesRemaining;
+         }
+         else
+         {
+           mtCOVERAGE_TEST_MARKER();
+         }
+
+         prvRecordAllocation( xRequestedSize, pvCaller );
+
          /* The block is being returned - it is allocated and owned
          by the application and has no "next" block. */
          pxBlock->xBlockSize |= xBlockAllocatedBit;
@@ -250,6 +303,15 @@ void *pvPortMalloc( size_t xWantedSize )
    }
 
    traceMALLOC( pvReturn, xWantedSize );
+
+   if( pvReturn == NULL )
+   {
+     xNumberOfFailedAllocations++;
+   }
+   else
+   {
+     mtCOVERAGE_TEST_MARKER();
+   }
  }
  ( void ) xTaskResumeAll();
 
@@ -302,6 +364,7 @@ void vPortFree( void *pv )
        {
          /* Add this block to the list of free blocks. */
          xFreeBytesRemaining += pxLink->xBlockSize;
+         xNumberOfSuccessfulFrees++;
          traceFREE( pv, pxLink->xBlockSize );
          prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
        }
@@ -332,6 +395,138 @@ size_t xPortGetMinimumEverFreeHeapSize( void )
 }
 /*-----------------------------------------------------------*/
 
+size_t xPortGetHeapWatermark( void )
+{
+ return xWatermarkFreeBytes;
+}
+/*-----------------------------------------------------------*/
+
+void vPortResetHeapWatermark( void )
+{
+ vTaskSuspendAll();
+ {
+   xWatermarkFreeBytes = xFreeBytesRemaining;
+ }
+ ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStatistics( HeapStatistics_t *pxHeapStatistics )
+{
+ BlockLink_t *pxBlock;
+ size_t xBlocks = 0, xMaxSize = 0, xMinSize = 0;
+ size_t x;
+
+ vTaskSuspendAll();
+ {
+   if( pxEnd != NULL )
+   {
+     /* The list of free blocks is terminated by pxEnd. */
+     for( pxBlock = xStart.pxNextFreeBlock; pxBlock != pxEnd; pxBlock = pxBlock->pxNextFreeBlock )
+     {
+       xBlocks++;
+
+       if( pxBlock->xBlockSize > xMaxSize )
+       {
+         xMaxSize = pxBlock->xBlockSize;
+       }
+
+       if( ( xMinSize == 0 ) || ( pxBlock->xBlockSize < xMinSize ) )
+       {
+         xMinSize = pxBlock->xBlockSize;
+       }
+     }
+   }
+
+   pxHeapStatistics->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+   pxHeapStatistics->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+   pxHeapStatistics->xSizeOfSmallestFreeBlockInBytes = xMinSize;
+   pxHeapStatistics->xNumberOfFreeBlocks = xBlocks;
+   pxHeapStatistics->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+   pxHeapStatistics->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+   pxHeapStatistics->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+   pxHeapStatistics->xNumberOfFailedAllocations = xNumberOfFailedAllocations;
+
+   for( x = 0; x < heapHISTOGRAM_BUCKETS; x++ )
+   {
+     pxHeapStatistics->xAllocationSizeHistogram[ x ] = xAllocationSizeHistogram[ x ];
+   }
+ }
+ ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_TRACK_CALLERS == 1 )
+ size_t uxPortGetHeapCallers( HeapCaller_t *pxCallers, size_t uxMaxCallers )
+ {
+   size_t x, uxCount;
+
+   vTaskSuspendAll();
+   {
+     uxCount = ( uxNumberOfCallers < uxMaxCallers ) ? uxNumberOfCallers : uxMaxCallers;
+     for( x = 0; x < uxCount; x++ )
+     {
+       pxCallers[ x ] = xCallers[ x ];
+     }
+   }
+   ( void ) xTaskResumeAll();
+
+   return uxCount;
+ }
+#endif
+/*-----------------------------------------------------------*/
+
+static void prvRecordAllocation( size_t xRequestedSize, void *pvCaller )
+{
+ size_t uxBucket = 0;
+ size_t xLimit = heapHISTOGRAM_SMALLEST_SIZE;
+
+ xNumberOfSuccessfulAllocations++;
+
+ /* Buckets double in size, the last one holds all the larger requests. */
+ while( ( xRequestedSize > xLimit ) && ( uxBucket < ( heapHISTOGRAM_BUCKETS - 1 ) ) )
+ {
+   xLimit <<= 1;
+   uxBucket++;
+ }
+ xAllocationSizeHistogram[ uxBucket ]++;
+
+#if( configHEAP_TRACK_CALLERS == 1 )
+ {
+   size_t x;
+
+   for( x = 0; x < uxNumberOfCallers; x++ )
+   {
+     if( xCallers[ x ].pvCaller == pvCaller )
+     {
+       break;
+     }
+   }
+
+   if( x == uxNumberOfCallers )
+   {
+     if( uxNumberOfCallers < heapMAX_CALLERS )
+     {
+       xCallers[ x ].pvCaller = pvCaller;
+       uxNumberOfCallers++;
+     }
+     else
+     {
+       /* The table is full: the last entry gathers all the other callers. */
+       x = heapMAX_CALLERS - 1;
+       xCallers[ x ].pvCaller = NULL;
+     }
+   }
+
+   xCallers[ x ].xAllocations++;
+   xCallers[ x ].xBytes += xRequestedSize;
+ }
+#else
+ ( void ) pvCaller;
+#endif
+}
+/*-----------------------------------------------------------*/
+
 void vPortInitialiseBlocks( void )
 {
  /* This just exists to keep the linker quiet. */
@@ -379,6 +574,7 @@ static void prvHeapInit( void )
 
  /* Only one block exists - and it covers the entire usable heap space. */
  xMinimumEverFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
+ xWatermarkFreeBytes = pxFirstFreeBlock->xBlockSize;
  xFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
 
  /* Work out the position of the top bit in a size_t variable. */
@@ -462,7 +658,7 @@ void* pvPortRealloc(void* pv, size_t xWantedSize) {
 
  if (pv == NULL) {
    // pv points to NULL. Allocate a new buffer.
-   return pvPortMalloc(xWantedSize);
+   return prvMalloc(xWantedSize, __builtin_return_address(0));
  }
 
  // The memory being freed will have an BlockLink_t structure immediately before it.
@@ -477,7 +673,7 @@ void* pvPortRealloc(void* pv, size_t xWantedSize) {
    block_size = (pxLink->xBlockSize & ~xBlockAllocatedBit) - xHeapStructSize;
 
    // Allocate a new buffer
-   pvReturn = pvPortMalloc(xWantedSize);
+   pvReturn = prvMalloc(xWantedSize, __builtin_return_address(0));
 
    // Check creation and determine the data size to be copied to the new buffer
    if (pvReturn != NULL) {
@@ -495,7 +691,7 @@ void* pvPortRealloc(void* pv, size_t xWantedSize) {
    }
  } else {
    // pv does not point to a valid memory buffer. Allocate a new one
-   pvReturn = pvPortMalloc(xWantedSize);
+   pvReturn = prvMalloc(xWantedSize, __builtin_return_address(0));
  }
 
  return pvReturn;
@@ -0,0 +1,69 @@
+#ifndef HEAP_4_INFINITIME_H
+#define HEAP_4_INFINITIME_H
+
+/*
+* Statistics of the heap implemented in heap_4_infinitime.c, used to monitor
+* the memory usage and the fragmentation of the heap at runtime.
+*/
+
+#include <stddef.h>
+#include "FreeRTOS.h"
+
+#ifndef configHEAP_TRACK_CALLERS
+ #define configHEAP_TRACK_CALLERS 0
+#endif
+
+/* Allocations are counted per requested size: up to 16 bytes, up to 32 bytes,
+... up to 1024 bytes, and larger than 1024 bytes. */
+#define heapHISTOGRAM_BUCKETS 8
+#define heapHISTOGRAM_SMALLEST_SIZE ( ( size_t ) 16 )
+
+/* Number of call sites tracked when configHEAP_TRACK_CALLERS is 1. */
+#define heapMAX_CALLERS 16
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct xHeapStats
+{
+ size_t xAvailableHeapSpaceInBytes;      /* The total heap size currently available - this is the sum of all the free blocks, not the largest block that can be allocated. */
+ size_t xSizeOfLargestFreeBlockInBytes;  /* The maximum size, in bytes, of all the free blocks within the heap at the time vPortGetHeapStatistics() is called. */
+ size_t xSizeOfSmallestFreeBlockInBytes; /* The minimum size, in bytes, of all the free blocks within the heap at the time vPortGetHeapStatistics() is called. */
+ size_t xNumberOfFreeBlocks;             /* The number of free memory blocks within the heap at the time vPortGetHeapStatistics() is called. */
+ size_t xMinimumEverFreeBytesRemaining;  /* The minimum amount of total free memory (sum of all free blocks) there has been in the heap since the system booted. */
+ size_t xNumberOfSuccessfulAllocations;  /* The number of calls to pvPortMalloc() that have returned a valid memory block. */
+ size_t xNumberOfSuccessfulFrees;        /* The number of calls to vPortFree() that has successfully freed a block of memory. */
+ size_t xNumberOfFailedAllocations;      /* The number of calls to pvPortMalloc() that have returned NULL. */
+ size_t xAllocationSizeHistogram[ heapHISTOGRAM_BUCKETS ]; /* Successful allocations per requested size. */
+} HeapStatistics_t;
+
+typedef struct xHeapCaller
+{
+ void *pvCaller;      /* Return address of the allocation, NULL for the entry that gathers the callers past heapMAX_CALLERS. */
+ size_t xAllocations; /* Number of successful allocations. */
+ size_t xBytes;       /* Total number of bytes requested. */
+} HeapCaller_t;
+
+void vPortGetHeapStatistics( HeapStatistics_t *pxHeapStatistics );
+
+/* The watermark is the lowest number of free bytes since the last call to
+vPortResetHeapWatermark(), i.e. the peak usage of the heap over a period. */
+size_t xPortGetHeapWatermark( void );
+void vPortResetHeapWatermark( void );
+
+void *pvPortRealloc( void *pv, size_t xWantedSize );
+
+#if( configHEAP_TRACK_CALLERS == 1 )
+ /* Same as pvPortMalloc(), pvCaller being the code the allocation is accounted to. */
+ void *pvPortMallocFrom( size_t xWantedSize, void *pvCaller );
+
+ /* Copies up to uxMaxCallers entries of the call-site table, returns the number of entries copied. */
+ size_t uxPortGetHeapCallers( HeapCaller_t *pxCallers, size_t uxMaxCallers );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HEAP_4_INFINITIME_H */
@@ -83,8 +83,11 @@
 #define configCHECK_FOR_STACK_OVERFLOW 1
 #define configUSE_MALLOC_FAILED_HOOK   1
 
+/* Set to 1 to count the allocations per call site, see heap_4_infinitime.h. */
+#define configHEAP_TRACK_CALLERS 0
+
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS        0
+#define configGENERATE_RUN_TIME_STATS        1
 #define configUSE_TRACE_FACILITY             1
 #define configUSE_STATS_FORMATTING_FUNCTIONS 0
 
@@ -181,6 +184,28 @@ standard names - or at least those used in the unmodified vector table. */
     #error "This port requires __NVIC_PRIO_BITS to be defined"
   #endif
 
+  /* Run time stats are counted in CPU cycles, with the DWT cycle counter. It doesn't run while the CPU sleeps. */
+  #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()                                                                                       \
+    do {                                                                                                                                 \
+      CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;                                                                                    \
+      DWT->CYCCNT = 0;                                                                                                                   \
+      DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                                                                                               \
+    } while (0)
+  #define portGET_RUN_TIME_COUNTER_VALUE() (DWT->CYCCNT)
+
+  /* Profiling hooks, implemented in SystemMonitor.cpp */
+  #include <stdint.h>
+  #ifdef __cplusplus
+extern "C" {
+  #endif
+void SystemMonitorTaskSwitchedIn(uint32_t taskNumber);
+void SystemMonitorTicksSlept(uint32_t ticks);
+  #ifdef __cplusplus
+}
+  #endif
+  #define traceTASK_SWITCHED_IN()     SystemMonitorTaskSwitchedIn(pxCurrentTCB->uxTCBNumber)
+  #define traceINCREASE_TICK_COUNT(x) SystemMonitorTicksSlept(x)
+
   /* Access to current system core clock is required only if we are ticking the system by systimer */
   #if (configTICK_SOURCE == FREERTOS_USE_SYSTICK)
     #include <stdint.h>
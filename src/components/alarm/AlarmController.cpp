@@ -18,90 +18,127 @@
 #include "components/alarm/AlarmController.h"
 #include "systemtask/SystemTask.h"
 #include "task.h"
+#include <algorithm>
 #include <chrono>
 
 using namespace Pinetime::Controllers;
 using namespace std::chrono_literals;
 
-AlarmController::AlarmController(Controllers::DateTime& dateTimeController) : dateTimeController {dateTimeController} {
+namespace {
+  // An alarm may go off a bit late if that saves a wakeup
+  constexpr TickType_t alarmSlack = pdMS_TO_TICKS(500);
+
+  bool IsAllowedDay(AlarmController::RecurType recurrence, int64_t day) {
+    // The epoch (day 0) is a thursday
+    auto daysSinceMonday = (day + 3) % 7;
+    bool weekend = daysSinceMonday >= 5;
+    switch (recurrence) {
+      case AlarmController::RecurType::Weekdays:
+        return !weekend;
+      case AlarmController::RecurType::Weekends:
+        return weekend;
+      default:
+        return true;
+    }
+  }
 }
 
-namespace {
-  void SetOffAlarm(TimerHandle_t xTimer) {
-    auto* controller = static_cast<Pinetime::Controllers::AlarmController*>(pvTimerGetTimerID(xTimer));
-    controller->SetOffAlarmNow();
+AlarmController::AlarmController(Controllers::DateTime& dateTimeController, Controllers::Scheduler& scheduler)
+  : dateTimeController {dateTimeController}, scheduler {scheduler} {
+  for (uint8_t i = 0; i < nbAlarms; i++) {
+    contexts[i] = {this, i};
   }
 }
 
+void AlarmController::SetOffAlarm(void* context) {
+  auto* alarmContext = static_cast<AlarmContext*>(context);
+  alarmContext->controller->SetOffAlarmNow(alarmContext->index);
+}
+
 void AlarmController::Init(System::SystemTask* systemTask) {
   this->systemTask = systemTask;
-  alarmTimer = xTimerCreate("Alarm", 1, pdFALSE, this, SetOffAlarm);
 }
 
-void AlarmController::SetAlarmTime(uint8_t alarmHr, uint8_t alarmMin) {
-  hours = alarmHr;
-  minutes = alarmMin;
+void AlarmController::SetAlarmTime(uint8_t index, uint8_t alarmHr, uint8_t alarmMin) {
+  alarms[index].hours = alarmHr;
+  alarms[index].minutes = alarmMin;
 }
 
-void AlarmController::ScheduleAlarm() {
-  // Determine the next time the alarm needs to go off and set the timer
-  xTimerStop(alarmTimer, 0);
-
-  auto now = dateTimeController.CurrentDateTime();
-  alarmTime = now;
-  time_t ttAlarmTime = std::chrono::system_clock::to_time_t(std::chrono::time_point_cast<std::chrono::system_clock::duration>(alarmTime));
-  tm* tmAlarmTime = std::localtime(&ttAlarmTime);
-
-  // If the time being set has already passed today,the alarm should be set for tomorrow
-  if (hours < dateTimeController.Hours() || (hours == dateTimeController.Hours() && minutes <= dateTimeController.Minutes())) {
-    tmAlarmTime->tm_mday += 1;
-    // tm_wday doesn't update automatically
-    tmAlarmTime->tm_wday = (tmAlarmTime->tm_wday + 1) % 7;
+// Next local time matching the alarm time and its recurrence.
+// Local time is kept as time since the epoch, so days are always 24h long and DST changes only move the clock.
+Scheduler::LocalTime AlarmController::NextOccurrence(const Alarm& alarm) const {
+  auto now = dateTimeController.Now();
+  auto today = std::chrono::floor<std::chrono::days>(now);
+  auto timeOfDay = std::chrono::hours(alarm.hours) + std::chrono::minutes(alarm.minutes);
+
+  auto alarmTime = today + timeOfDay;
+  // If the time being set has already passed today, the alarm should be set for tomorrow
+  if (alarmTime <= now) {
+    alarmTime += std::chrono::days(1);
   }
-
-  tmAlarmTime->tm_hour = hours;
-  tmAlarmTime->tm_min = minutes;
-  tmAlarmTime->tm_sec = 0;
-
-  // if alarm is in weekday-only mode, make sure it shifts to the next weekday
-  if (recurrence == RecurType::Weekdays) {
-    if (tmAlarmTime->tm_wday == 0) { // Sunday, shift 1 day
-      tmAlarmTime->tm_mday += 1;
-    } else if (tmAlarmTime->tm_wday == 6) { // Saturday, shift 2 days
-      tmAlarmTime->tm_mday += 2;
-    }
+  while (!IsAllowedDay(alarm.recurrence, std::chrono::floor<std::chrono::days>(alarmTime).time_since_epoch().count())) {
+    alarmTime += std::chrono::days(1);
   }
-  tmAlarmTime->tm_isdst = -1; // use system timezone setting to determine DST
-
-  // now can convert back to a time_point
-  alarmTime = std::chrono::system_clock::from_time_t(std::mktime(tmAlarmTime));
-  auto secondsToAlarm = std::chrono::duration_cast<std::chrono::seconds>(alarmTime - now).count();
-  xTimerChangePeriod(alarmTimer, secondsToAlarm * configTICK_RATE_HZ, 0);
-  xTimerStart(alarmTimer, 0);
+  return alarmTime;
+}
 
-  state = AlarmState::Set;
+void AlarmController::ScheduleAlarm(uint8_t index) {
+  // Determine the next time the alarm needs to go off and set the timer
+  Alarm& alarm = alarms[index];
+  scheduler.Cancel(alarm.schedulerId);
+  alarm.alarmTime = NextOccurrence(alarm);
+  alarm.schedulerId = scheduler.ScheduleAt(alarm.alarmTime, alarmSlack, SetOffAlarm, &contexts[index]);
+  alarm.state = AlarmState::Set;
 }
 
-uint32_t AlarmController::SecondsToAlarm() const {
-  return std::chrono::duration_cast<std::chrono::seconds>(alarmTime - dateTimeController.CurrentDateTime()).count();
+uint32_t AlarmController::SecondsToAlarm(uint8_t index) const {
+  return std::chrono::duration_cast<std::chrono::seconds>(alarms[index].alarmTime - dateTimeController.Now()).count();
 }
 
-void AlarmController::DisableAlarm() {
-  xTimerStop(alarmTimer, 0);
-  state = AlarmState::Not_Set;
+void AlarmController::DisableAlarm(uint8_t index) {
+  scheduler.Cancel(alarms[index].schedulerId);
+  alarms[index].schedulerId = Scheduler::invalidId;
+  alarms[index].state = AlarmState::Not_Set;
 }
 
-void AlarmController::SetOffAlarmNow() {
-  state = AlarmState::Alerting;
-  systemTask->PushMessage(System::Messages::SetOffAlarm);
+void AlarmController::SetOffAlarmNow(uint8_t index) {
+  taskENTER_CRITICAL();
+  bool alreadyAlerting = alarms[index].state == AlarmState::Alerting;
+  if (!alreadyAlerting) {
+    alarms[index].state = AlarmState::Alerting;
+    alertingAlarms[nbAlerting++] = index;
+  }
+  taskEXIT_CRITICAL();
+
+  if (!alreadyAlerting) {
+    systemTask->PushMessage(System::Messages::SetOffAlarm);
+  }
 }
 
 void AlarmController::StopAlerting() {
+  taskENTER_CRITICAL();
+  if (nbAlerting == 0) {
+    taskEXIT_CRITICAL();
+    return;
+  }
+  uint8_t index = alertingAlarms[0];
+  std::copy(alertingAlarms.begin() + 1, alertingAlarms.begin() + nbAlerting, alertingAlarms.begin());
+  nbAlerting--;
+  taskEXIT_CRITICAL();
+
   // Alarm state is off unless this is a recurring alarm
-  if (recurrence == RecurType::None) {
-    state = AlarmState::Not_Set;
+  if (alarms[index].recurrence == RecurType::None) {
+    alarms[index].state = AlarmState::Not_Set;
   } else {
     // set next instance
-    ScheduleAlarm();
+    ScheduleAlarm(index);
+  }
+}
+
+void AlarmController::OnTimeChanged() {
+  for (uint8_t i = 0; i < nbAlarms; i++) {
+    if (alarms[i].state == AlarmState::Set) {
+      ScheduleAlarm(i);
+    }
   }
 }
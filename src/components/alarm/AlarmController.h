@@ -18,9 +18,10 @@
 #pragma once
 
 #include <FreeRTOS.h>
-#include <timers.h>
+#include <array>
 #include <cstdint>
 #include "components/datetime/DateTimeController.h"
+#include "components/scheduler/Scheduler.h"
 
 namespace Pinetime {
   namespace System {
@@ -30,47 +31,79 @@ namespace Pinetime {
   namespace Controllers {
     class AlarmController {
     public:
-      AlarmController(Controllers::DateTime& dateTimeController);
+      static constexpr uint8_t nbAlarms = 4;
+
+      AlarmController(Controllers::DateTime& dateTimeController, Controllers::Scheduler& scheduler);
 
       void Init(System::SystemTask* systemTask);
-      void SetAlarmTime(uint8_t alarmHr, uint8_t alarmMin);
-      void ScheduleAlarm();
-      void DisableAlarm();
-      void SetOffAlarmNow();
-      uint32_t SecondsToAlarm() const;
+      void SetAlarmTime(uint8_t index, uint8_t alarmHr, uint8_t alarmMin);
+      void ScheduleAlarm(uint8_t index);
+      void DisableAlarm(uint8_t index);
+      void SetOffAlarmNow(uint8_t index);
+      uint32_t SecondsToAlarm(uint8_t index) const;
       void StopAlerting();
+      // Reschedules the alarms after the time has been changed
+      void OnTimeChanged();
       enum class AlarmState { Not_Set, Set, Alerting };
-      enum class RecurType { None, Daily, Weekdays };
+      enum class RecurType { None, Daily, Weekdays, Weekends };
+
+      uint8_t Hours(uint8_t index) const {
+        return alarms[index].hours;
+      }
+
+      uint8_t Minutes(uint8_t index) const {
+        return alarms[index].minutes;
+      }
 
-      uint8_t Hours() const {
-        return hours;
+      AlarmState State(uint8_t index) const {
+        return alarms[index].state;
       }
 
-      uint8_t Minutes() const {
-        return minutes;
+      RecurType Recurrence(uint8_t index) const {
+        return alarms[index].recurrence;
       }
 
-      AlarmState State() const {
-        return state;
+      void SetRecurrence(uint8_t index, RecurType recurType) {
+        alarms[index].recurrence = recurType;
       }
 
-      RecurType Recurrence() const {
-        return recurrence;
+      bool IsAlerting() const {
+        return nbAlerting > 0;
       }
 
-      void SetRecurrence(RecurType recurType) {
-        recurrence = recurType;
+      // Index of the alarm currently alerting, only valid if IsAlerting(). Alarms that go off while another one is
+      // alerting are queued: StopAlerting() stops this one, and the next one becomes the alerting alarm.
+      uint8_t AlertingAlarm() const {
+        return alertingAlarms[0];
       }
 
     private:
+      struct Alarm {
+        uint8_t hours = 7;
+        uint8_t minutes = 0;
+        RecurType recurrence = RecurType::None;
+        AlarmState state = AlarmState::Not_Set;
+        Scheduler::LocalTime alarmTime {};
+        Scheduler::Id schedulerId = Scheduler::invalidId;
+      };
+
+      // The scheduler callback only receives a pointer, which points to one of these
+      struct AlarmContext {
+        AlarmController* controller;
+        uint8_t index;
+      };
+
       Controllers::DateTime& dateTimeController;
+      Controllers::Scheduler& scheduler;
       System::SystemTask* systemTask = nullptr;
-      TimerHandle_t alarmTimer;
-      uint8_t hours = 7;
-      uint8_t minutes = 0;
-      std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> alarmTime;
-      AlarmState state = AlarmState::Not_Set;
-      RecurType recurrence = RecurType::None;
+      std::array<Alarm, nbAlarms> alarms;
+      std::array<AlarmContext, nbAlarms> contexts;
+      // Set by the timer task and stopped by the display task, in critical sections. Oldest first.
+      std::array<uint8_t, nbAlarms> alertingAlarms {};
+      uint8_t nbAlerting = 0;
+
+      static void SetOffAlarm(void* context);
+      Scheduler::LocalTime NextOccurrence(const Alarm& alarm) const;
     };
   }
 }
@@ -1,5 +1,6 @@
 #include "components/ble/AlertNotificationClient.h"
 #include <algorithm>
+#include "components/ble/MbufReader.h"
 #include "components/ble/NotificationManager.h"
 #include "systemtask/SystemTask.h"
 #include <nrf_log.h>
@@ -73,16 +74,32 @@ int AlertNotificationClient::OnCharacteristicsDiscoveryEvent(uint16_t connection
                                                              const ble_gatt_chr* characteristic) {
   if (error->status != 0 && error->status != BLE_HS_EDONE) {
     NRF_LOG_INFO("ANS Characteristic discovery ERROR");
-    onServiceDiscovered(connectionHandle);
+    if (isUsingCachedHandles) {
+      DiscoverService(connectionHandle);
+    } else {
+      onServiceDiscovered(connectionHandle);
+    }
     return 0;
   }
 
   if (characteristic == nullptr && error->status == BLE_HS_EDONE) {
     NRF_LOG_INFO("ANS Characteristic discovery complete");
-    if (isCharacteristicDiscovered) {
+    if (isUsingCachedHandles) {
+      // The cached descriptor follows the value of the characteristic, which is still in place
+      if (!isCharacteristicDiscovered || Subscribe(connectionHandle) != 0) {
+        NRF_LOG_INFO("ANS cached handles are stale");
+        DiscoverService(connectionHandle);
+      }
+    } else if (isCharacteristicDiscovered) {
       ble_gattc_disc_all_dscs(connectionHandle, newAlertHandle, ansEndHandle, OnAlertNotificationDescriptorDiscoveryEventCallback, this);
     } else
       onServiceDiscovered(connectionHandle);
+  } else if (isUsingCachedHandles) {
+    if (characteristic != nullptr && ble_uuid_cmp(&newAlertUuid.u, &characteristic->uuid.u) == 0 &&
+        characteristic->val_handle == cachedNewAlertHandle && (characteristic->properties & BLE_GATT_CHR_PROP_NOTIFY) != 0) {
+      newAlertHandle = characteristic->val_handle;
+      isCharacteristicDiscovered = true;
+    }
   } else {
     if (characteristic != nullptr && ble_uuid_cmp(&supportedNewAlertCategoryUuid.u, &characteristic->uuid.u) == 0) {
       NRF_LOG_INFO("ANS Characteristic discovered : supportedNewAlertCategoryUuid");
@@ -110,8 +127,13 @@ int AlertNotificationClient::OnCharacteristicsDiscoveryEvent(uint16_t connection
 int AlertNotificationClient::OnNewAlertSubcribe(uint16_t connectionHandle, const ble_gatt_error* error) {
   if (error->status == 0) {
     NRF_LOG_INFO("ANS New alert subscribe OK");
+    isSubscribed = true;
   } else {
     NRF_LOG_INFO("ANS New alert subscribe ERROR");
+    if (isUsingCachedHandles) {
+      DiscoverService(connectionHandle);
+      return 0;
+    }
   }
   onServiceDiscovered(connectionHandle);
 
@@ -128,10 +150,7 @@ int AlertNotificationClient::OnDescriptorDiscoveryEventCallback(uint16_t connect
         NRF_LOG_INFO("ANS Descriptor discovered : %d", descriptor->handle);
         newAlertDescriptorHandle = descriptor->handle;
         isDescriptorFound = true;
-        uint8_t value[2];
-        value[0] = 1;
-        value[1] = 0;
-        ble_gattc_write_flat(connectionHandle, newAlertDescriptorHandle, value, sizeof(value), NewAlertSubcribeCallback, this);
+        Subscribe(connectionHandle);
       }
     }
   } else {
@@ -143,23 +162,17 @@ int AlertNotificationClient::OnDescriptorDiscoveryEventCallback(uint16_t connect
 
 void AlertNotificationClient::OnNotification(ble_gap_event* event) {
   if (event->notify_rx.attr_handle == newAlertHandle) {
-    constexpr size_t stringTerminatorSize = 1; // end of string '\0'
     constexpr size_t headerSize = 3;
     const auto maxMessageSize {NotificationManager::MaximumMessageSize()};
-    const auto maxBufferSize {maxMessageSize + headerSize};
 
     // Ignore notifications with empty message
-    const auto packetLen = OS_MBUF_PKTLEN(event->notify_rx.om);
-    if (packetLen <= headerSize)
+    MbufReader reader {event->notify_rx.om};
+    if (reader.Remaining() <= headerSize)
       return;
-
-    size_t bufferSize = std::min(packetLen + stringTerminatorSize, maxBufferSize);
-    auto messageSize = std::min(maxMessageSize, (bufferSize - headerSize));
+    reader.Skip(headerSize);
 
     NotificationManager::Notification notif;
-    os_mbuf_copydata(event->notify_rx.om, headerSize, messageSize - 1, notif.message.data());
-    notif.message[messageSize - 1] = '\0';
-    notif.size = messageSize;
+    notif.size = reader.ReadString(notif.message.data(), reader.Remaining(), maxMessageSize - 1) + 1;
     notif.category = Pinetime::Controllers::NotificationManager::Categories::SimpleAlert;
     notificationManager.Push(std::move(notif));
 
@@ -180,10 +193,55 @@ void AlertNotificationClient::Reset() {
   isDiscovered = false;
   isCharacteristicDiscovered = false;
   isDescriptorFound = false;
+  isSubscribed = false;
+  cachedNewAlertHandle = 0;
+  cachedNewAlertDescriptorHandle = 0;
+  isUsingCachedHandles = false;
 }
 
 void AlertNotificationClient::Discover(uint16_t connectionHandle, std::function<void(uint16_t)> onServiceDiscovered) {
-  NRF_LOG_INFO("[ANS] Starting discovery");
   this->onServiceDiscovered = onServiceDiscovered;
+  if (cachedNewAlertHandle > 1 && cachedNewAlertDescriptorHandle != 0) {
+    NRF_LOG_INFO("[ANS] Checking cached handles 0x%x 0x%x", cachedNewAlertHandle, cachedNewAlertDescriptorHandle);
+    newAlertDescriptorHandle = cachedNewAlertDescriptorHandle;
+    isDescriptorFound = true;
+    isUsingCachedHandles = true;
+    // Only the declaration of the characteristic, which precedes its value, is read: its UUID and properties are checked
+    // by OnCharacteristicsDiscoveryEvent() before subscribing
+    if (ble_gattc_disc_chrs_by_uuid(connectionHandle,
+                                    cachedNewAlertHandle - 1,
+                                    cachedNewAlertHandle,
+                                    &newAlertUuid.u,
+                                    OnAlertNotificationCharacteristicDiscoveredCallback,
+                                    this) == 0) {
+      return;
+    }
+  }
+  DiscoverService(connectionHandle);
+}
+
+void AlertNotificationClient::DiscoverService(uint16_t connectionHandle) {
+  NRF_LOG_INFO("[ANS] Starting discovery");
+  Reset();
   ble_gattc_disc_svc_by_uuid(connectionHandle, &ansServiceUuid.u, OnDiscoveryEventCallback, this);
 }
+
+int AlertNotificationClient::Subscribe(uint16_t connectionHandle) {
+  uint8_t value[2];
+  value[0] = 1;
+  value[1] = 0;
+  return ble_gattc_write_flat(connectionHandle, newAlertDescriptorHandle, value, sizeof(value), NewAlertSubcribeCallback, this);
+}
+
+void AlertNotificationClient::UseCachedHandles(uint16_t newAlertHandle, uint16_t newAlertDescriptorHandle) {
+  cachedNewAlertHandle = newAlertHandle;
+  cachedNewAlertDescriptorHandle = newAlertDescriptorHandle;
+}
+
+uint16_t AlertNotificationClient::NewAlertHandle() const {
+  return isSubscribed ? newAlertHandle : 0;
+}
+
+uint16_t AlertNotificationClient::NewAlertDescriptorHandle() const {
+  return isSubscribed ? newAlertDescriptorHandle : 0;
+}
@@ -34,6 +34,14 @@ namespace Pinetime {
       void Reset();
       void Discover(uint16_t connectionHandle, std::function<void(uint16_t)> lambda) override;
 
+      // The next Discover() subscribes to new alerts with these handles, found during a previous connection, instead of
+      // discovering the service. The service is discovered if the handle isn't the one of the characteristic anymore, or
+      // if the subscription fails.
+      void UseCachedHandles(uint16_t newAlertHandle, uint16_t newAlertDescriptorHandle);
+      // 0 until the subscription to new alerts succeeded
+      uint16_t NewAlertHandle() const;
+      uint16_t NewAlertDescriptorHandle() const;
+
     private:
       static constexpr uint16_t ansServiceId {0x1811};
       static constexpr uint16_t supportedNewAlertCategoryId = 0x2a47;
@@ -65,6 +73,13 @@ namespace Pinetime {
       std::function<void(uint16_t)> onServiceDiscovered;
       bool isCharacteristicDiscovered = false;
       bool isDescriptorFound = false;
+      bool isSubscribed = false;
+      uint16_t cachedNewAlertHandle = 0;
+      uint16_t cachedNewAlertDescriptorHandle = 0;
+      bool isUsingCachedHandles = false;
+
+      void DiscoverService(uint16_t connectionHandle);
+      int Subscribe(uint16_t connectionHandle);
     };
   }
 }
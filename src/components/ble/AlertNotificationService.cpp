@@ -2,6 +2,7 @@
 #include <hal/nrf_rtc.h>
 #include <cstring>
 #include <algorithm>
+#include "components/ble/MbufReader.h"
 #include "components/ble/NotificationManager.h"
 #include "systemtask/SystemTask.h"
 
@@ -46,26 +47,20 @@ AlertNotificationService::AlertNotificationService(System::SystemTask& systemTas
 
 int AlertNotificationService::OnAlert(struct ble_gatt_access_ctxt* ctxt) {
   if (ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
-    constexpr size_t stringTerminatorSize = 1; // end of string '\0'
     constexpr size_t headerSize = 3;
     const auto maxMessageSize {NotificationManager::MaximumMessageSize()};
-    const auto maxBufferSize {maxMessageSize + headerSize};
 
     // Ignore notifications with empty message
-    const auto packetLen = OS_MBUF_PKTLEN(ctxt->om);
-    if (packetLen <= headerSize) {
+    MbufReader reader {ctxt->om};
+    if (reader.Remaining() <= headerSize) {
       return 0;
     }
+    auto category = static_cast<Categories>(reader.ReadUint8());
+    reader.Skip(headerSize - 1);
 
-    size_t bufferSize = std::min(packetLen + stringTerminatorSize, maxBufferSize);
-    auto messageSize = std::min(maxMessageSize, (bufferSize - headerSize));
-    Categories category;
-
+    // Longer messages are truncated, keeping room for the string terminator
     NotificationManager::Notification notif;
-    os_mbuf_copydata(ctxt->om, headerSize, messageSize - 1, notif.message.data());
-    os_mbuf_copydata(ctxt->om, 0, 1, &category);
-    notif.message[messageSize - 1] = '\0';
-    notif.size = messageSize;
+    notif.size = reader.ReadString(notif.message.data(), reader.Remaining(), maxMessageSize - 1) + 1;
 
     // TODO convert all ANS categories to NotificationController categories
     switch (category) {
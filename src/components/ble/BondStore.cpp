@@ -0,0 +1,214 @@
+#include "components/ble/BondStore.h"
+#include <cstring>
+#include <nrf_log.h>
+#include "components/fs/FS.h"
+#include <FreeRTOS.h>
+#include <task.h>
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  constexpr const char* bondFile = "/bond.dat";
+  // Distinguishes the file from the one of older versions, which starts with the address type of the peer (0-3)
+  constexpr uint8_t magic = 0xB0;
+
+  struct Header {
+    uint8_t magic;
+    uint8_t version;
+    uint16_t size;
+    uint32_t checksum;
+  };
+}
+
+BondStore::BondStore(FS& fs) : fs {fs} {
+  std::memset(&record, 0, sizeof(record));
+}
+
+void BondStore::Restore() {
+  if (!Load() && !LoadLegacy()) {
+    return;
+  }
+  if (!record.bonded) {
+    return;
+  }
+
+  ble_store_write_our_sec(&record.ourSec);
+  ble_store_write_peer_sec(&record.peerSec);
+  for (uint8_t i = 0; i < record.nbCccds; i++) {
+    // Older versions could save empty CCCDs
+    if (record.cccds[i].chr_val_handle != 0) {
+      ble_store_write_cccd(&record.cccds[i]);
+    }
+  }
+  NRF_LOG_INFO("[BondStore] Bond restored, %d CCCDs, handles %d %d %d %d %d",
+               record.nbCccds,
+               record.handles.currentTime,
+               record.handles.newAlert,
+               record.handles.newAlertDescriptor,
+               record.handles.serviceChanged,
+               record.handles.serviceChangedDescriptor);
+}
+
+bool BondStore::Load() {
+  lfs_file_t file;
+  if (fs.FileOpen(&file, bondFile, LFS_O_RDONLY) != LFS_ERR_OK) {
+    return false;
+  }
+  Header header;
+  Record loaded;
+  bool valid = fs.FileRead(&file, reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) && header.magic == magic &&
+               header.version == version && header.size == sizeof(Record);
+  valid = valid && fs.FileRead(&file, reinterpret_cast<uint8_t*>(&loaded), sizeof(loaded)) == sizeof(loaded) &&
+          header.checksum == Checksum(loaded) && loaded.nbCccds <= maxCccds;
+  fs.FileClose(&file);
+  if (valid) {
+    std::memcpy(&record, &loaded, sizeof(Record));
+  }
+  return valid;
+}
+
+// Older versions saved the keys and the CCCDs only, and deleted the file once it was restored
+bool BondStore::LoadLegacy() {
+  lfs_file_t file;
+  if (fs.FileOpen(&file, bondFile, LFS_O_RDONLY) != LFS_ERR_OK) {
+    return false;
+  }
+  Record loaded;
+  std::memset(&loaded, 0, sizeof(loaded));
+  ble_store_value value;
+  bool valid = fs.FileRead(&file, reinterpret_cast<uint8_t*>(&value), sizeof(value)) == sizeof(value) &&
+               value.sec.peer_addr.type <= BLE_ADDR_RANDOM_ID;
+  loaded.ourSec = value.sec;
+  valid = valid && fs.FileRead(&file, reinterpret_cast<uint8_t*>(&value), sizeof(value)) == sizeof(value);
+  loaded.peerSec = value.sec;
+  valid = valid && fs.FileRead(&file, &loaded.nbCccds, 1) == 1 && loaded.nbCccds <= maxCccds;
+  for (uint8_t i = 0; valid && i < loaded.nbCccds; i++) {
+    valid = fs.FileRead(&file, reinterpret_cast<uint8_t*>(&loaded.cccds[i]), sizeof(loaded.cccds[i])) == sizeof(loaded.cccds[i]);
+  }
+  fs.FileClose(&file);
+  if (valid) {
+    loaded.bonded = true;
+    std::memcpy(&record, &loaded, sizeof(Record));
+    // Saved again in the current format
+    dirty = true;
+  }
+  return valid;
+}
+
+void BondStore::Save() {
+  if (!dirty.exchange(false)) {
+    return;
+  }
+
+  Record snapshot;
+  taskENTER_CRITICAL();
+  std::memcpy(&snapshot, &record, sizeof(Record));
+  taskEXIT_CRITICAL();
+
+  if (!snapshot.bonded) {
+    int result = fs.FileDelete(bondFile);
+    if (result != LFS_ERR_OK && result != LFS_ERR_NOENT) {
+      dirty = true;
+    }
+    return;
+  }
+
+  lfs_file_t file;
+  if (fs.FileOpen(&file, bondFile, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC) != LFS_ERR_OK) {
+    dirty = true;
+    return;
+  }
+  Header header {magic, version, sizeof(Record), Checksum(snapshot)};
+  bool success = fs.FileWrite(&file, reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+                 fs.FileWrite(&file, reinterpret_cast<const uint8_t*>(&snapshot), sizeof(snapshot)) == sizeof(snapshot);
+  success = fs.FileClose(&file) == LFS_ERR_OK && success;
+  if (!success) {
+    dirty = true;
+  }
+}
+
+void BondStore::Update(const ble_addr_t& peerAddress) {
+  // Objects deleted for all the peers
+  if (ble_addr_cmp(&peerAddress, BLE_ADDR_ANY) == 0) {
+    if (record.bonded) {
+      Update(record.peerSec.peer_addr);
+    }
+    return;
+  }
+
+  Record newRecord;
+  std::memset(&newRecord, 0, sizeof(newRecord));
+
+  ble_store_key_sec secKey {};
+  secKey.peer_addr = peerAddress;
+  if (ble_store_read_our_sec(&secKey, &newRecord.ourSec) != 0 || ble_store_read_peer_sec(&secKey, &newRecord.peerSec) != 0) {
+    // The bond is incomplete (pairing in progress) or was deleted
+    if (IsBondedWith(peerAddress)) {
+      Changed(newRecord);
+    }
+    return;
+  }
+  newRecord.bonded = true;
+
+  ble_store_key_cccd cccdKey {};
+  cccdKey.peer_addr = peerAddress;
+  for (cccdKey.idx = 0; cccdKey.idx < maxCccds; cccdKey.idx++) {
+    if (ble_store_read_cccd(&cccdKey, &newRecord.cccds[newRecord.nbCccds]) != 0) {
+      break;
+    }
+    newRecord.nbCccds++;
+  }
+
+  // The handles of the services of the phone remain valid as long as the bond does
+  if (IsBondedWith(peerAddress)) {
+    newRecord.handles = record.handles;
+  }
+
+  if (std::memcmp(&newRecord, &record, sizeof(Record)) != 0) {
+    Changed(newRecord);
+  }
+}
+
+bool BondStore::IsBondedWith(const ble_addr_t& peerAddress) const {
+  taskENTER_CRITICAL();
+  bool bonded = record.bonded && ble_addr_cmp(&record.peerSec.peer_addr, &peerAddress) == 0;
+  taskEXIT_CRITICAL();
+  return bonded;
+}
+
+BondStore::Handles BondStore::GetHandles() const {
+  taskENTER_CRITICAL();
+  Handles handles = record.handles;
+  taskEXIT_CRITICAL();
+  return handles;
+}
+
+void BondStore::SetHandles(const ble_addr_t& peerAddress, const Handles& handles) {
+  if (IsBondedWith(peerAddress) && std::memcmp(&handles, &record.handles, sizeof(Handles)) != 0) {
+    taskENTER_CRITICAL();
+    record.handles = handles;
+    taskEXIT_CRITICAL();
+    dirty = true;
+  }
+}
+
+// Records are copied and compared as bytes, padding included
+void BondStore::Changed(const Record& newRecord) {
+  taskENTER_CRITICAL();
+  std::memcpy(&record, &newRecord, sizeof(Record));
+  taskEXIT_CRITICAL();
+  dirty = true;
+}
+
+// CRC-32 (IEEE 802.3), computed bitwise: the record is only checked at boot and written when the bond changes
+uint32_t BondStore::Checksum(const Record& record) {
+  const auto* bytes = reinterpret_cast<const uint8_t*>(&record);
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < sizeof(Record); i++) {
+    crc ^= bytes[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#define min // workaround: nimble's min/max macros conflict with libstdc++
+#define max
+#include <host/ble_store.h>
+#undef max
+#undef min
+
+namespace Pinetime {
+  namespace Controllers {
+    class FS;
+
+    /*
+     * Copy of the bond with the phone in the file system, so that it survives reboots.
+     *
+     * NimBLE keeps the bonds in RAM only: the copy holds the keys of both sides and the CCCDs the phone wrote (its
+     * subscriptions), which are written back to NimBLE at boot, and the handles of the services of the phone the clients
+     * discovered, so that they don't run the discovery again on the next connections. The handles are forgotten when the
+     * phone indicates that its services changed. A single bond is kept: a new bond replaces it.
+     *
+     * The copy is updated by the BLE task whenever NimBLE changes its store, and written to the file system by SystemTask
+     * when the SPI flash is awake: the record is copied in critical sections. A write that fails or races with an update
+     * is done again on the next Save(). The file is checksummed, so that a corrupted bond is ignored at boot.
+     */
+    class BondStore {
+    public:
+      // Handles of the services of the phone, 0 when unknown
+      struct Handles {
+        uint16_t currentTime;
+        uint16_t newAlert;
+        uint16_t newAlertDescriptor;
+        uint16_t serviceChanged;
+        uint16_t serviceChangedDescriptor;
+      };
+
+      explicit BondStore(FS& fs);
+
+      // Loads the saved bond into the store of NimBLE
+      void Restore();
+      // Writes the bond to the file system if it changed since the last call
+      void Save();
+
+      // Copies the bond with this peer from the store of NimBLE, or forgets the bond if NimBLE deleted it
+      void Update(const ble_addr_t& peerAddress);
+      bool IsBondedWith(const ble_addr_t& peerAddress) const;
+
+      Handles GetHandles() const;
+
+      // Ignored if the peer isn't the bonded one
+      void SetHandles(const ble_addr_t& peerAddress, const Handles& handles);
+
+    private:
+      static constexpr uint8_t maxCccds = MYNEWT_VAL(BLE_STORE_MAX_CCCDS);
+      static constexpr uint8_t version = 3;
+
+      // Layout of the file after its header. The structures of NimBLE are written as they are in memory.
+      struct Record {
+        bool bonded;
+        uint8_t nbCccds;
+        Handles handles;
+        ble_store_value_sec ourSec;
+        ble_store_value_sec peerSec;
+        std::array<ble_store_value_cccd, maxCccds> cccds;
+      };
+
+      FS& fs;
+      // Written by the BLE task only, once restored
+      Record record;
+      std::atomic<bool> dirty {false};
+
+      bool Load();
+      bool LoadLegacy();
+      void Changed(const Record& newRecord);
+      static uint32_t Checksum(const Record& record);
+    };
+  }
+}
@@ -0,0 +1,115 @@
+#include "components/ble/ConnectionPolicy.h"
+
+using namespace Pinetime::Controllers;
+
+const ConnectionPolicy::Parameters& ConnectionPolicy::ParametersOf(Profiles profile) {
+  return (profile == Profiles::Transfer) ? transferParameters : idleParameters;
+}
+
+void ConnectionPolicy::OnConnected(TickType_t now, uint16_t interval, uint16_t latency) {
+  connected = true;
+  workloads = 0;
+  workloadsChanged = now;
+  requested = Profiles::None;
+  previous = Profiles::None;
+  pending = false;
+  statistics = {};
+  statistics.interval = interval;
+  statistics.latency = latency;
+  transferTicks = 0;
+}
+
+void ConnectionPolicy::OnDisconnected(TickType_t now) {
+  // Transfers don't outlive the connection, even if their end was not notified
+  UpdateWorkloads(0, now);
+  connected = false;
+  pending = false;
+}
+
+void ConnectionPolicy::OnUpdated(bool success, uint16_t interval, uint16_t latency) {
+  if (success) {
+    statistics.interval = interval;
+    statistics.latency = latency;
+    statistics.renegotiations++;
+  }
+  if (pending) {
+    pending = false;
+    if (!success) {
+      statistics.rejections++;
+    }
+  }
+}
+
+void ConnectionPolicy::StartWorkload(Workloads workload, TickType_t now) {
+  UpdateWorkloads(workloads | Bit(workload), now);
+}
+
+void ConnectionPolicy::StopWorkload(Workloads workload, TickType_t now) {
+  UpdateWorkloads(workloads & ~Bit(workload), now);
+}
+
+void ConnectionPolicy::OnTransferred(uint32_t bytes) {
+  statistics.transferredBytes += bytes;
+}
+
+bool ConnectionPolicy::NextRequest(TickType_t now, Profiles& profile) {
+  if (!connected || pending) {
+    return false;
+  }
+  Profiles desired = Desired(now);
+  if (desired == requested) {
+    return false;
+  }
+  previous = requested;
+  requested = desired;
+  pending = true;
+  statistics.requests++;
+  profile = desired;
+  return true;
+}
+
+void ConnectionPolicy::OnRequestFailed() {
+  // The request was not sent (another procedure is running...), it'll be retried at the next event
+  pending = false;
+  requested = previous;
+  statistics.rejections++;
+}
+
+TickType_t ConnectionPolicy::NextDeadline(TickType_t now) const {
+  if (!connected || workloads != 0 || requested == Profiles::Idle) {
+    return portMAX_DELAY;
+  }
+  TickType_t elapsed = now - workloadsChanged;
+  return (elapsed >= relaxDelay) ? 0 : relaxDelay - elapsed;
+}
+
+ConnectionPolicy::Statistics ConnectionPolicy::GetStatistics(TickType_t now) const {
+  Statistics result = statistics;
+  TickType_t ticks = transferTicks;
+  if (workloads != 0) {
+    ticks += now - workloadsChanged;
+  }
+  result.transferMilliseconds = static_cast<uint64_t>(ticks) * 1000 / configTICK_RATE_HZ;
+  return result;
+}
+
+ConnectionPolicy::Profiles ConnectionPolicy::Desired(TickType_t now) const {
+  if (workloads != 0) {
+    return Profiles::Transfer;
+  }
+  if (now - workloadsChanged >= relaxDelay) {
+    return Profiles::Idle;
+  }
+  return requested;
+}
+
+// Only the transitions between no workload and some workload matter to the policy
+void ConnectionPolicy::UpdateWorkloads(uint8_t newWorkloads, TickType_t now) {
+  if ((workloads == 0) != (newWorkloads == 0)) {
+    if (workloads != 0) {
+      transferTicks += now - workloadsChanged;
+    }
+    workloadsChanged = now;
+  }
+  workloads = newWorkloads;
+}
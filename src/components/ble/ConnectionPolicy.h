@@ -0,0 +1,94 @@
+#pragma once
+
+#include <FreeRTOS.h>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Controllers {
+    /*
+     * Chooses the connection parameters requested from the central, depending on the workload.
+     *
+     * While a bulk transfer runs (firmware update, filesystem access, motion streaming), the connection uses a short
+     * interval without slave latency. Once the last workload has been stopped for relaxDelay, it's relaxed to a long
+     * interval with slave latency, so that the radio skips most connection events while the phone has nothing to send.
+     * Each profile is requested once per workload change: if the central rejects it or later picks other parameters,
+     * they are kept until the next change.
+     *
+     * It isn't thread-safe: NimbleController calls it from the BLE task and from SystemTask, in critical sections.
+     */
+    class ConnectionPolicy {
+    public:
+      enum class Workloads : uint8_t { FirmwareUpdate, FileTransfer, MotionStreaming };
+      enum class Profiles : uint8_t { None, Transfer, Idle };
+
+      // Intervals in units of 1.25ms, supervision timeout in units of 10ms
+      struct Parameters {
+        uint16_t intervalMin;
+        uint16_t intervalMax;
+        uint16_t latency;
+        uint16_t supervisionTimeout;
+      };
+
+      // Reset at each connection
+      struct Statistics {
+        uint16_t interval;
+        uint16_t latency;
+        uint16_t requests;
+        uint16_t rejections;
+        // Parameter updates completed, requested by either side
+        uint16_t renegotiations;
+        uint32_t transferredBytes;
+        // Time during which at least one workload was running
+        uint32_t transferMilliseconds;
+      };
+
+      // 15-30ms, and 100-125ms with 4 skipped events: both fit the constraints that iOS puts on peripherals
+      static constexpr Parameters transferParameters {12, 24, 0, 400};
+      static constexpr Parameters idleParameters {80, 100, 4, 600};
+      static constexpr TickType_t relaxDelay = pdMS_TO_TICKS(5000);
+
+      static const Parameters& ParametersOf(Profiles profile);
+
+      void OnConnected(TickType_t now, uint16_t interval, uint16_t latency);
+      void OnDisconnected(TickType_t now);
+      void OnUpdated(bool success, uint16_t interval, uint16_t latency);
+
+      void StartWorkload(Workloads workload, TickType_t now);
+      void StopWorkload(Workloads workload, TickType_t now);
+      void OnTransferred(uint32_t bytes);
+
+      // Returns true if the parameters of the profile must be requested now. The request is then considered in flight
+      // until OnUpdated() or OnRequestFailed() is called.
+      bool NextRequest(TickType_t now, Profiles& profile);
+      void OnRequestFailed();
+
+      // Delay after which NextRequest() must be called again, or portMAX_DELAY if only a new event can change the profile
+      TickType_t NextDeadline(TickType_t now) const;
+
+      bool IsConnected() const {
+        return connected;
+      }
+
+      Statistics GetStatistics(TickType_t now) const;
+
+    private:
+      static constexpr uint8_t Bit(Workloads workload) {
+        return 1 << static_cast<uint8_t>(workload);
+      }
+
+      Profiles Desired(TickType_t now) const;
+      void UpdateWorkloads(uint8_t newWorkloads, TickType_t now);
+
+      bool connected = false;
+      uint8_t workloads = 0;
+      TickType_t workloadsChanged = 0;
+
+      Profiles requested = Profiles::None;
+      Profiles previous = Profiles::None;
+      bool pending = false;
+
+      Statistics statistics {};
+      TickType_t transferTicks = 0;
+    };
+  }
+}
@@ -1,5 +1,6 @@
 #include "components/ble/CurrentTimeClient.h"
 #include <nrf_log.h>
+#include "components/ble/MbufReader.h"
 #include "components/datetime/DateTimeController.h"
 
 using namespace Pinetime::Controllers;
@@ -59,10 +60,13 @@ bool CurrentTimeClient::OnDiscoveryEvent(uint16_t connectionHandle, const ble_ga
 int CurrentTimeClient::OnCharacteristicDiscoveryEvent(uint16_t conn_handle,
                                                       const ble_gatt_error* error,
                                                       const ble_gatt_chr* characteristic) {
-  if (characteristic == nullptr && error->status == BLE_HS_EDONE) {
+  if (characteristic == nullptr) {
     if (isCharacteristicDiscovered) {
       NRF_LOG_INFO("CTS Characteristic discovery complete, fetching time");
       ble_gattc_read(conn_handle, currentTimeHandle, CurrentTimeReadCallback, this);
+    } else if (isUsingCachedHandle) {
+      NRF_LOG_INFO("CTS cached handle is stale");
+      DiscoverService(conn_handle);
     } else {
       NRF_LOG_INFO("CTS Characteristic discovery unsuccessful");
       onServiceDiscovered(conn_handle);
@@ -71,7 +75,8 @@ int CurrentTimeClient::OnCharacteristicDiscoveryEvent(uint16_t conn_handle,
     return 0;
   }
 
-  if (characteristic != nullptr && ble_uuid_cmp(&currentTimeCharacteristicUuid.u, &characteristic->uuid.u) == 0) {
+  if (ble_uuid_cmp(&currentTimeCharacteristicUuid.u, &characteristic->uuid.u) == 0 &&
+      (characteristic->properties & BLE_GATT_CHR_PROP_READ) != 0 && (!isUsingCachedHandle || characteristic->val_handle == cachedHandle)) {
     NRF_LOG_INFO("CTS Characteristic discovered : 0x%x", characteristic->val_handle);
     isCharacteristicDiscovered = true;
     currentTimeHandle = characteristic->val_handle;
@@ -83,13 +88,25 @@ int CurrentTimeClient::OnCurrentTimeReadResult(uint16_t conn_handle, const ble_g
   if (error->status == 0) {
     // TODO check that attribute->handle equals the handle discovered in OnCharacteristicDiscoveryEvent
     CtsData result;
-    os_mbuf_copydata(attribute->om, 0, sizeof(CtsData), &result);
+    if (!MbufReader {attribute->om}.Read(result) || !IsValid(result)) {
+      NRF_LOG_INFO("Invalid current time received");
+      if (isUsingCachedHandle) {
+        DiscoverService(conn_handle);
+        return 0;
+      }
+      onServiceDiscovered(conn_handle);
+      return 0;
+    }
     uint16_t year = ((uint16_t) result.year_MSO << 8) + result.year_LSO;
 
     NRF_LOG_INFO("Received data: %d-%d-%d %d:%d:%d", year, result.month, result.dayofmonth, result.hour, result.minute, result.second);
     dateTimeController.SetTime(year, result.month, result.dayofmonth, result.hour, result.minute, result.second);
   } else {
     NRF_LOG_INFO("Error retrieving current time: %d", error->status);
+    if (isUsingCachedHandle) {
+      DiscoverService(conn_handle);
+      return 0;
+    }
   }
 
   onServiceDiscovered(conn_handle);
@@ -99,10 +116,44 @@ int CurrentTimeClient::OnCurrentTimeReadResult(uint16_t conn_handle, const ble_g
 void CurrentTimeClient::Reset() {
   isDiscovered = false;
   isCharacteristicDiscovered = false;
+  isUsingCachedHandle = false;
+  cachedHandle = 0;
 }
 
 void CurrentTimeClient::Discover(uint16_t connectionHandle, std::function<void(uint16_t)> onServiceDiscovered) {
-  NRF_LOG_INFO("[CTS] Starting discovery");
   this->onServiceDiscovered = onServiceDiscovered;
+  if (cachedHandle > 1) {
+    NRF_LOG_INFO("[CTS] Checking cached handle 0x%x", cachedHandle);
+    isUsingCachedHandle = true;
+    // Only the declaration of the characteristic, which precedes its value, is read: its UUID and properties are checked
+    // by OnCharacteristicDiscoveryEvent() before the time is read
+    if (ble_gattc_disc_chrs_by_uuid(connectionHandle,
+                                    cachedHandle - 1,
+                                    cachedHandle,
+                                    &currentTimeCharacteristicUuid.u,
+                                    OnCurrentTimeCharacteristicDiscoveredCallback,
+                                    this) == 0) {
+      return;
+    }
+  }
+  DiscoverService(connectionHandle);
+}
+
+void CurrentTimeClient::DiscoverService(uint16_t connectionHandle) {
+  NRF_LOG_INFO("[CTS] Starting discovery");
+  Reset();
   ble_gattc_disc_svc_by_uuid(connectionHandle, &ctsServiceUuid.u, OnDiscoveryEventCallback, this);
 }
+
+// Fields set to 0 are unknown
+bool CurrentTimeClient::IsValid(const CtsData& data) {
+  return data.month <= 12 && data.dayofmonth <= 31 && data.hour < 24 && data.minute < 60 && data.second < 60;
+}
+
+void CurrentTimeClient::UseCachedHandle(uint16_t handle) {
+  cachedHandle = handle;
+}
+
+uint16_t CurrentTimeClient::CurrentTimeHandle() const {
+  return isCharacteristicDiscovered ? currentTimeHandle : 0;
+}
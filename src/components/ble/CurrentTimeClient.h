@@ -30,6 +30,13 @@ namespace Pinetime {
 
       void Discover(uint16_t connectionHandle, std::function<void(uint16_t)> lambda) override;
 
+      // The next Discover() reads the time from this handle, found during a previous connection, instead of
+      // discovering the service. The service is discovered if the handle isn't the one of the characteristic anymore,
+      // or if the read fails.
+      void UseCachedHandle(uint16_t handle);
+      // 0 if the characteristic wasn't found
+      uint16_t CurrentTimeHandle() const;
+
     private:
       typedef struct __attribute__((packed)) {
         uint8_t year_LSO; // explicit byte ordering to be independent of machine order
@@ -57,7 +64,12 @@ namespace Pinetime {
 
       bool isCharacteristicDiscovered = false;
       uint16_t currentTimeHandle;
+      uint16_t cachedHandle = 0;
+      bool isUsingCachedHandle = false;
       std::function<void(uint16_t)> onServiceDiscovered;
+
+      void DiscoverService(uint16_t connectionHandle);
+      static bool IsValid(const CtsData& data);
     };
   }
 }
@@ -1,5 +1,6 @@
 #include "components/ble/CurrentTimeService.h"
 #include <nrf_log.h>
+#include "components/ble/MbufReader.h"
 
 using namespace Pinetime::Controllers;
 
@@ -39,8 +40,7 @@ int CurrentTimeService::OnCurrentTimeAccessed(struct ble_gatt_access_ctxt* ctxt)
 
   if (ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
     CtsCurrentTimeData result;
-    int res = os_mbuf_copydata(ctxt->om, 0, sizeof(CtsCurrentTimeData), &result);
-    if (res < 0) {
+    if (!MbufReader {ctxt->om}.Read(result)) {
       NRF_LOG_ERROR("Error reading BLE Data writing to CTS Current Time (too little data)")
       return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
     }
@@ -74,9 +74,7 @@ int CurrentTimeService::OnLocalTimeAccessed(struct ble_gatt_access_ctxt* ctxt) {
 
   if (ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
     CtsLocalTimeData result;
-    int res = os_mbuf_copydata(ctxt->om, 0, sizeof(CtsLocalTimeData), &result);
-
-    if (res < 0) {
+    if (!MbufReader {ctxt->om}.Read(result)) {
       NRF_LOG_ERROR("Error reading BLE Data writing to CTS Local Time (too little data)")
       return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
     }
@@ -1,6 +1,7 @@
 #include "components/ble/DfuService.h"
 #include <cstring>
 #include "components/ble/BleController.h"
+#include "components/ble/MbufReader.h"
 #include "drivers/SpiNorFlash.h"
 #include "systemtask/SystemTask.h"
 #include <nrf_log.h>
@@ -113,11 +114,15 @@ int DfuService::SendDfuRevision(os_mbuf* om) const {
 }
 
 int DfuService::WritePacketHandler(uint16_t connectionHandle, os_mbuf* om) {
+  MbufReader reader {om};
   switch (state) {
     case States::Start: {
-      softdeviceSize = om->om_data[0] + (om->om_data[1] << 8) + (om->om_data[2] << 16) + (om->om_data[3] << 24);
-      bootloaderSize = om->om_data[4] + (om->om_data[5] << 8) + (om->om_data[6] << 16) + (om->om_data[7] << 24);
-      applicationSize = om->om_data[8] + (om->om_data[9] << 8) + (om->om_data[10] << 16) + (om->om_data[11] << 24);
+      softdeviceSize = reader.ReadUint32();
+      bootloaderSize = reader.ReadUint32();
+      applicationSize = reader.ReadUint32();
+      if (!reader.Ok()) {
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+      }
       bleController.FirmwareUpdateTotalBytes(applicationSize);
       NRF_LOG_INFO("[DFU] -> Start data received : SD size : %d, BT size : %d, app size : %d",
                    softdeviceSize,
@@ -137,15 +142,18 @@ int DfuService::WritePacketHandler(uint16_t connectionHandle, os_mbuf* om) {
     }
       return 0;
     case States::Init: {
-      uint16_t deviceType = om->om_data[0] + (om->om_data[1] << 8);
-      uint16_t deviceRevision = om->om_data[2] + (om->om_data[3] << 8);
-      uint32_t applicationVersion = om->om_data[4] + (om->om_data[5] << 8) + (om->om_data[6] << 16) + (om->om_data[7] << 24);
-      uint16_t softdeviceArrayLength = om->om_data[8] + (om->om_data[9] << 8);
-      uint16_t sd[softdeviceArrayLength];
-      for (int i = 0; i < softdeviceArrayLength; i++) {
-        sd[i] = om->om_data[10 + (i * 2)] + (om->om_data[10 + (i * 2) + 1] << 8);
+      uint16_t deviceType = reader.ReadUint16();
+      uint16_t deviceRevision = reader.ReadUint16();
+      uint32_t applicationVersion = reader.ReadUint32();
+      uint16_t softdeviceArrayLength = reader.ReadUint16();
+      // Only the first softdevice is logged
+      uint16_t firstSoftdevice = reader.ReadUint16();
+      reader.Skip((softdeviceArrayLength > 0) ? (softdeviceArrayLength - 1) * sizeof(uint16_t) : 0);
+      uint16_t crc = reader.ReadUint16();
+      if (!reader.Ok()) {
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
       }
-      expectedCrc = om->om_data[10 + (softdeviceArrayLength * 2)] + (om->om_data[10 + (softdeviceArrayLength * 2) + 1] << 8);
+      expectedCrc = crc;
 
       NRF_LOG_INFO(
         "[DFU] -> Init data received : deviceType = %d, deviceRevision = %d, applicationVersion = %d, nb SD = %d, First SD = %d, CRC = %u",
@@ -153,7 +161,7 @@ int DfuService::WritePacketHandler(uint16_t connectionHandle, os_mbuf* om) {
         deviceRevision,
         applicationVersion,
         softdeviceArrayLength,
-        sd[0],
+        firstSoftdevice,
         expectedCrc);
 
       return 0;
@@ -161,9 +169,14 @@ int DfuService::WritePacketHandler(uint16_t connectionHandle, os_mbuf* om) {
 
     case States::Data: {
       nbPacketReceived++;
-      dfuImage.Append(om->om_data, om->om_len);
-      bytesReceived += om->om_len;
+      size_t packetSize = reader.Remaining();
+      const uint8_t* chunk;
+      while (size_t chunkSize = reader.ReadChunk(chunk, reader.Remaining())) {
+        dfuImage.Append(chunk, chunkSize);
+      }
+      bytesReceived += packetSize;
       bleController.FirmwareUpdateCurrentBytes(bytesReceived);
+      systemTask.nimble().AddTransferredBytes(packetSize);
 
       if ((nbPacketReceived % nbPacketsToNotify) == 0 && bytesReceived != applicationSize) {
         uint8_t data[5] {static_cast<uint8_t>(Opcodes::PacketReceiptNotification),
@@ -192,7 +205,10 @@ int DfuService::WritePacketHandler(uint16_t connectionHandle, os_mbuf* om) {
 }
 
 int DfuService::ControlPointHandler(uint16_t connectionHandle, os_mbuf* om) {
-  auto opcode = static_cast<Opcodes>(om->om_data[0]);
+  MbufReader reader {om};
+  auto opcode = static_cast<Opcodes>(reader.ReadUint8());
+  // Missing parameters are read as 0
+  auto parameter = reader.ReadUint8();
   NRF_LOG_INFO("[DFU] -> ControlPointHandler");
 
   switch (opcode) {
@@ -205,7 +221,7 @@ int DfuService::ControlPointHandler(uint16_t connectionHandle, os_mbuf* om) {
         NRF_LOG_INFO("[DFU] -> Start DFU requested, but we are already in Start state");
         return 0;
       }
-      auto imageType = static_cast<ImageTypes>(om->om_data[1]);
+      auto imageType = static_cast<ImageTypes>(parameter);
       if (imageType == ImageTypes::Application) {
         NRF_LOG_INFO("[DFU] -> Start DFU, mode = Application");
         state = States::Start;
@@ -225,7 +241,7 @@ int DfuService::ControlPointHandler(uint16_t connectionHandle, os_mbuf* om) {
         NRF_LOG_INFO("[DFU] -> Init DFU requested, but we are not in Init state");
         return 0;
       }
-      bool isInitComplete = (om->om_data[1] != 0);
+      bool isInitComplete = (parameter != 0);
       NRF_LOG_INFO("[DFU] -> Init DFU parameters %s", isInitComplete ? " complete" : " not complete");
 
       if (isInitComplete) {
@@ -238,7 +254,7 @@ int DfuService::ControlPointHandler(uint16_t connectionHandle, os_mbuf* om) {
     }
       return 0;
     case Opcodes::PacketReceiptNotificationRequest:
-      nbPacketsToNotify = om->om_data[1];
+      nbPacketsToNotify = parameter;
       NRF_LOG_INFO("[DFU] -> Receive Packet Notification Request, nb packet = %d", nbPacketsToNotify);
       return 0;
     case Opcodes::ReceiveFirmwareImage:
@@ -361,7 +377,7 @@ void DfuService::DfuImage::Init(size_t chunkSize, size_t totalSize, uint16_t exp
   bufferWriteIndex = 0;
 }
 
-void DfuService::DfuImage::Append(uint8_t* data, size_t size) {
+void DfuService::DfuImage::Append(const uint8_t* data, size_t size) {
   if (!ready)
     return;
   ASSERT(size <= 20);
@@ -56,7 +56,7 @@ namespace Pinetime {
 
         void Init(size_t chunkSize, size_t totalSize, uint16_t expectedCrc);
         void Erase();
-        void Append(uint8_t* data, size_t size);
+        void Append(const uint8_t* data, size_t size);
         bool Validate();
         bool IsComplete();
 
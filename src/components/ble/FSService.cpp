@@ -1,10 +1,22 @@
 #include <nrf_log.h>
 #include "FSService.h"
 #include "components/ble/BleController.h"
+#include "components/ble/MbufReader.h"
 #include "systemtask/SystemTask.h"
 
 using namespace Pinetime::Controllers;
 
+namespace {
+  // Reads a path field into a NUL terminated string, if it fits in bufferSize
+  bool ReadPath(MbufReader& reader, uint16_t length, char* path, size_t bufferSize) {
+    if (length >= bufferSize) {
+      return false;
+    }
+    reader.ReadString(path, length, length);
+    return reader.Ok();
+  }
+}
+
 constexpr ble_uuid16_t FSService::fsServiceUuid;
 constexpr ble_uuid128_t FSService::fsVersionUuid;
 constexpr ble_uuid128_t FSService::fsTransferUuid;
@@ -61,7 +73,8 @@ int FSService::OnFSServiceRequested(uint16_t connectionHandle, uint16_t attribut
 }
 
 int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
-  auto command = static_cast<commands>(om->om_data[0]);
+  // Each header starts with the command
+  auto command = static_cast<commands>(MbufReader {om}.ReadUint8());
   NRF_LOG_INFO("[FS_S] -> FSCommandHandler Command %d", command);
   // Just always make sure we are awake...
   systemTask.PushMessage(Pinetime::System::Messages::StartFileTransfer);
@@ -72,21 +85,21 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
   lfs_dir_t dir = {0};
   lfs_info info = {0};
   lfs_file f = {0};
+  MbufReader reader {om};
+  int result = 0;
   switch (command) {
     case commands::READ: {
       NRF_LOG_INFO("[FS_S] -> Read");
-      auto* header = (ReadHeader*) om->om_data;
-      uint16_t plen = header->pathlen;
-      if (plen > maxpathlen) { //> counts for null term
-        return -1;
+      ReadHeader header;
+      if (!reader.Read(header) || !ReadPath(reader, header.pathlen, filepath, sizeof(filepath))) {
+        result = BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        break;
       }
-      memcpy(filepath, header->pathstr, plen);
-      filepath[plen] = 0; // Copy and null terminate string
       ReadResponse resp;
       os_mbuf* om;
       resp.command = commands::READ_DATA;
       resp.status = 0x01;
-      resp.chunkoff = header->chunkoff;
+      resp.chunkoff = header.chunkoff;
       int res = fs.Stat(filepath, &info);
       if (res == LFS_ERR_NOENT && info.type != LFS_TYPE_DIR) {
         resp.status = (int8_t) res;
@@ -94,14 +107,15 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
         resp.totallen = 0;
         om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
       } else {
-        resp.chunklen = std::min(header->chunksize, info.size); // TODO add mtu somehow
+        resp.chunklen = std::min({header.chunksize, info.size, MaxChunkSize(connectionHandle)});
         resp.totallen = info.size;
         fs.FileOpen(&f, filepath, LFS_O_RDONLY);
-        fs.FileSeek(&f, header->chunkoff);
+        fs.FileSeek(&f, header.chunkoff);
         uint8_t fileData[resp.chunklen] = {0};
         resp.chunklen = fs.FileRead(&f, fileData, resp.chunklen);
         om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
         os_mbuf_append(om, fileData, resp.chunklen);
+        systemTask.nimble().AddTransferredBytes(resp.chunklen);
         fs.FileClose(&f);
       }
 
@@ -110,21 +124,25 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
     }
     case commands::READ_PACING: {
       NRF_LOG_INFO("[FS_S] -> Readpacing");
-      auto* header = (ReadHeader*) om->om_data;
+      ReadPacing header;
+      if (!reader.Read(header)) {
+        result = BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        break;
+      }
       ReadResponse resp;
       resp.command = commands::READ_DATA;
       resp.status = 0x01;
-      resp.chunkoff = header->chunkoff;
+      resp.chunkoff = header.chunkoff;
       int res = fs.Stat(filepath, &info);
       if (res == LFS_ERR_NOENT && info.type != LFS_TYPE_DIR) {
         resp.status = (int8_t) res;
         resp.chunklen = 0;
         resp.totallen = 0;
       } else {
-        resp.chunklen = std::min(header->chunksize, info.size); // TODO add mtu somehow
+        resp.chunklen = std::min({header.chunksize, info.size, MaxChunkSize(connectionHandle)});
         resp.totallen = info.size;
         fs.FileOpen(&f, filepath, LFS_O_RDONLY);
-        fs.FileSeek(&f, header->chunkoff);
+        fs.FileSeek(&f, header.chunkoff);
       }
       os_mbuf* om;
       if (resp.chunklen > 0) {
@@ -132,6 +150,7 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
         resp.chunklen = fs.FileRead(&f, fileData, resp.chunklen);
         om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
         os_mbuf_append(om, fileData, resp.chunklen);
+        systemTask.nimble().AddTransferredBytes(resp.chunklen);
       } else {
         resp.chunklen = 0;
         om = ble_hs_mbuf_from_flat(&resp, sizeof(ReadResponse));
@@ -142,17 +161,15 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
     }
     case commands::WRITE: {
       NRF_LOG_INFO("[FS_S] -> Write");
-      auto* header = (WriteHeader*) om->om_data;
-      uint16_t plen = header->pathlen;
-      if (plen > maxpathlen) { //> counts for null term
-        return -1;             // TODO make this actually return a BLE notif
+      WriteHeader header;
+      if (!reader.Read(header) || !ReadPath(reader, header.pathlen, filepath, sizeof(filepath))) {
+        result = BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN; // TODO make this actually return a BLE notif
+        break;
       }
-      memcpy(filepath, header->pathstr, plen);
-      filepath[plen] = 0; // Copy and null terminate string
-      fileSize = header->totalSize;
+      fileSize = header.totalSize;
       WriteResponse resp;
       resp.command = commands::WRITE_PACING;
-      resp.offset = header->offset;
+      resp.offset = header.offset;
       resp.modTime = 0;
 
       int res = fs.FileOpen(&f, filepath, LFS_O_RDWR | LFS_O_CREAT);
@@ -160,40 +177,58 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
         fs.FileClose(&f);
         resp.status = (res == 0) ? 0x01 : (int8_t) res;
       }
-      resp.freespace = std::min(fs.getSize() - (fs.GetFSSize() * fs.getBlockSize()), fileSize - header->offset);
+      resp.freespace = std::min(fs.getSize() - (fs.GetFSSize() * fs.getBlockSize()), fileSize - header.offset);
       auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(WriteResponse));
       ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
       break;
     }
     case commands::WRITE_DATA: {
       NRF_LOG_INFO("[FS_S] -> WriteData");
-      auto* header = (WritePacing*) om->om_data;
+      WritePacing header;
+      if (!reader.Read(header) || header.dataSize > reader.Remaining()) {
+        result = BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        break;
+      }
       WriteResponse resp;
       resp.command = commands::WRITE_PACING;
-      resp.offset = header->offset;
+      resp.offset = header.offset;
       int res = 0;
 
       if (!(res = fs.FileOpen(&f, filepath, LFS_O_RDWR | LFS_O_CREAT))) {
-        if ((res = fs.FileSeek(&f, header->offset)) >= 0) {
-          res = fs.FileWrite(&f, header->data, header->dataSize);
+        if ((res = fs.FileSeek(&f, header.offset)) >= 0) {
+          // Written straight from the mbufs of the request
+          int written = 0;
+          const uint8_t* data;
+          size_t chunkSize;
+          size_t remaining = header.dataSize;
+          while (res >= 0 && remaining > 0 && (chunkSize = reader.ReadChunk(data, remaining)) > 0) {
+            res = fs.FileWrite(&f, data, chunkSize);
+            written += (res > 0) ? res : 0;
+            remaining -= chunkSize;
+          }
+          res = (res < 0) ? res : written;
+        }
+        if (res > 0) {
+          systemTask.nimble().AddTransferredBytes(res);
         }
         fs.FileClose(&f);
       }
       if (res < 0) {
         resp.status = (int8_t) res;
       }
-      resp.freespace = std::min(fs.getSize() - (fs.GetFSSize() * fs.getBlockSize()), fileSize - header->offset);
+      resp.freespace = std::min(fs.getSize() - (fs.GetFSSize() * fs.getBlockSize()), fileSize - header.offset);
       auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(WriteResponse));
       ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
       break;
     }
     case commands::DELETE: {
       NRF_LOG_INFO("[FS_S] -> Delete");
-      auto* header = (DelHeader*) om->om_data;
-      uint16_t plen = header->pathlen;
-      char path[plen + 1] = {0};
-      memcpy(path, header->pathstr, plen);
-      path[plen] = 0; // Copy and null terminate string
+      DelHeader header;
+      char path[maxpathlen];
+      if (!reader.Read(header) || !ReadPath(reader, header.pathlen, path, sizeof(path))) {
+        result = BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        break;
+      }
       DelResponse resp {};
       resp.command = commands::DELETE_STATUS;
       int res = fs.FileDelete(path);
@@ -204,11 +239,12 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
     }
     case commands::MKDIR: {
       NRF_LOG_INFO("[FS_S] -> MKDir");
-      auto* header = (MKDirHeader*) om->om_data;
-      uint16_t plen = header->pathlen;
-      char path[plen + 1] = {0};
-      memcpy(path, header->pathstr, plen);
-      path[plen] = 0; // Copy and null terminate string
+      MKDirHeader header;
+      char path[maxpathlen];
+      if (!reader.Read(header) || !ReadPath(reader, header.pathlen, path, sizeof(path))) {
+        result = BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        break;
+      }
       MKDirResponse resp {};
       resp.command = commands::MKDIR_STATUS;
       resp.modification_time = 0;
@@ -220,11 +256,12 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
     }
     case commands::LISTDIR: {
       NRF_LOG_INFO("[FS_S] -> ListDir");
-      ListDirHeader* header = (ListDirHeader*) om->om_data;
-      uint16_t plen = header->pathlen;
-      char path[plen + 1] = {0};
-      path[plen] = 0; // Copy and null terminate string
-      memcpy(path, header->pathstr, plen);
+      ListDirHeader header;
+      char path[maxpathlen];
+      if (!reader.Read(header) || !ReadPath(reader, header.pathlen, path, sizeof(path))) {
+        result = BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        break;
+      }
 
       ListDirResponse resp {};
 
@@ -284,16 +321,17 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
     }
     case commands::MOVE: {
       NRF_LOG_INFO("[FS_S] -> Move");
-      MoveHeader* header = (MoveHeader*) om->om_data;
-      uint16_t plen = header->OldPathLength;
-      // Null Terminate string
-      header->pathstr[plen] = 0;
-      char path[header->NewPathLength + 1] = {0};
-      memcpy(path, &header->pathstr[plen + 1], header->NewPathLength);
-      path[header->NewPathLength] = 0; // Copy and null terminate string
+      // The old and new paths are separated by a NUL character. The old one is read into filepath to keep the stack small.
+      MoveHeader header;
+      char path[maxpathlen];
+      if (!reader.Read(header) || !ReadPath(reader, header.OldPathLength, filepath, sizeof(filepath)) || !reader.Skip(1) ||
+          !ReadPath(reader, header.NewPathLength, path, sizeof(path))) {
+        result = BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        break;
+      }
       MoveResponse resp {};
       resp.command = commands::MOVE_STATUS;
-      int8_t res = (int8_t) fs.Rename(header->pathstr, path);
+      int8_t res = (int8_t) fs.Rename(filepath, path);
       resp.status = (res == 0) ? 1 : res;
       auto* om = ble_hs_mbuf_from_flat(&resp, sizeof(MoveResponse));
       ble_gattc_notify_custom(connectionHandle, transferCharacteristicHandle, om);
@@ -303,7 +341,13 @@ int FSService::FSCommandHandler(uint16_t connectionHandle, os_mbuf* om) {
   }
   NRF_LOG_INFO("[FS_S] -> done ");
   systemTask.PushMessage(Pinetime::System::Messages::StopFileTransfer);
-  return 0;
+  return result;
+}
+
+// Notifications longer than the ATT MTU would be truncated, the client requests the rest of the file by itself
+uint32_t FSService::MaxChunkSize(uint16_t connectionHandle) {
+  uint16_t mtu = std::max<uint16_t>(ble_att_mtu(connectionHandle), BLE_ATT_MTU_DFLT);
+  return mtu - 3 - sizeof(ReadResponse);
 }
 
 // Loads resp with file data given a valid filepath header and resp
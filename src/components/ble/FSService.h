@@ -192,6 +192,7 @@ namespace Pinetime {
 
       int FSCommandHandler(uint16_t connectionHandle, os_mbuf* om);
       void prepareReadDataResp(ReadHeader* header, ReadResponse* resp);
+      static uint32_t MaxChunkSize(uint16_t connectionHandle);
     };
   }
 }
@@ -1,5 +1,6 @@
 #include "components/ble/HeartRateService.h"
 #include "components/heartrate/HeartRateController.h"
+#include "components/heartrate/HeartRateHistory.h"
 #include "components/ble/NimbleController.h"
 #include <nrf_log.h>
 
@@ -7,6 +8,7 @@ using namespace Pinetime::Controllers;
 
 constexpr ble_uuid16_t HeartRateService::heartRateServiceUuid;
 constexpr ble_uuid16_t HeartRateService::heartRateMeasurementUuid;
+constexpr ble_uuid128_t HeartRateService::heartRateHistoryUuid;
 
 namespace {
   int HeartRateServiceCallback(uint16_t /*conn_handle*/, uint16_t attr_handle, struct ble_gatt_access_ctxt* ctxt, void* arg) {
@@ -16,14 +18,22 @@ namespace {
 }
 
 // TODO Refactoring - remove dependency to SystemTask
-HeartRateService::HeartRateService(NimbleController& nimble, Controllers::HeartRateController& heartRateController)
+HeartRateService::HeartRateService(NimbleController& nimble,
+                                   Controllers::HeartRateController& heartRateController,
+                                   Controllers::HeartRateHistory& heartRateHistory)
   : nimble {nimble},
     heartRateController {heartRateController},
+    heartRateHistory {heartRateHistory},
     characteristicDefinition {{.uuid = &heartRateMeasurementUuid.u,
                                .access_cb = HeartRateServiceCallback,
                                .arg = this,
                                .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
                                .val_handle = &heartRateMeasurementHandle},
+                              {.uuid = &heartRateHistoryUuid.u,
+                               .access_cb = HeartRateServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ,
+                               .val_handle = &heartRateHistoryHandle},
                               {0}},
     serviceDefinition {
       {/* Device Information Service */
@@ -52,6 +62,31 @@ int HeartRateService::OnHeartRateRequested(uint16_t attributeHandle, ble_gatt_ac
 
     int res = os_mbuf_append(context->om, buffer, 2);
     return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+  } else if (attributeHandle == heartRateHistoryHandle) {
+    // Today (day since epoch + one BPM per slot, 0 if unknown) followed by the rollups of the past days, oldest first.
+    // The value is longer than the MTU: NimBLE calls this for each Read Blob request too, with an empty buffer (the
+    // response header is only written when reading from offset 0). The snapshot taken at offset 0 is kept for them so
+    // that the parts read are consistent.
+    if (OS_MBUF_PKTLEN(context->om) > 0 || !historySnapshotValid) {
+      historySnapshot = heartRateHistory.GetSnapshot();
+      historySnapshotValid = true;
+    }
+    const auto& history = historySnapshot;
+    int res = os_mbuf_append(context->om, &history.today, sizeof(history.today));
+    if (res == 0) {
+      res = os_mbuf_append(context->om, history.slots.data(), history.slots.size());
+    }
+    for (size_t i = 0; i < history.nbPastDays && res == 0; i++) {
+      const auto& rollup = history.pastDays[i];
+      uint8_t buffer[6] = {static_cast<uint8_t>(rollup.day & 0xff),
+                           static_cast<uint8_t>(rollup.day >> 8),
+                           rollup.min,
+                           rollup.max,
+                           rollup.average,
+                           rollup.count};
+      res = os_mbuf_append(context->om, buffer, sizeof(buffer));
+    }
+    return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
   }
   return 0;
 }
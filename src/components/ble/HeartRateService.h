@@ -5,6 +5,7 @@
 #undef max
 #undef min
 #include <atomic>
+#include "components/heartrate/HeartRateHistory.h"
 
 namespace Pinetime {
   namespace Controllers {
@@ -13,7 +14,9 @@ namespace Pinetime {
 
     class HeartRateService {
     public:
-      HeartRateService(NimbleController& nimble, Controllers::HeartRateController& heartRateController);
+      HeartRateService(NimbleController& nimble,
+                       Controllers::HeartRateController& heartRateController,
+                       Controllers::HeartRateHistory& heartRateHistory);
       void Init();
       int OnHeartRateRequested(uint16_t attributeHandle, ble_gatt_access_ctxt* context);
       void OnNewHeartRateValue(uint8_t hearRateValue);
@@ -24,6 +27,7 @@ namespace Pinetime {
     private:
       NimbleController& nimble;
       Controllers::HeartRateController& heartRateController;
+      Controllers::HeartRateHistory& heartRateHistory;
       static constexpr uint16_t heartRateServiceId {0x180D};
       static constexpr uint16_t heartRateMeasurementId {0x2A37};
 
@@ -31,11 +35,21 @@ namespace Pinetime {
 
       static constexpr ble_uuid16_t heartRateMeasurementUuid {.u {.type = BLE_UUID_TYPE_16}, .value = heartRateMeasurementId};
 
-      struct ble_gatt_chr_def characteristicDefinition[2];
+      // 00060001-78fc-48fe-8e23-433b3a1942d0
+      static constexpr ble_uuid128_t heartRateHistoryUuid {
+        .u {.type = BLE_UUID_TYPE_128},
+        .value = {0xd0, 0x42, 0x19, 0x3a, 0x3b, 0x43, 0x23, 0x8e, 0xfe, 0x48, 0xfc, 0x78, 0x01, 0x00, 0x06, 0x00}};
+
+      struct ble_gatt_chr_def characteristicDefinition[3];
       struct ble_gatt_svc_def serviceDefinition[2];
 
       uint16_t heartRateMeasurementHandle;
+      uint16_t heartRateHistoryHandle;
       std::atomic_bool heartRateMeasurementNotificationEnable {false};
+
+      // History read from offset 0, for the following Read Blob requests
+      HeartRateHistory::Snapshot historySnapshot;
+      bool historySnapshotValid = false;
     };
   }
 }
@@ -1,5 +1,6 @@
 #include "components/ble/ImmediateAlertService.h"
 #include <cstring>
+#include "components/ble/MbufReader.h"
 #include "components/ble/NotificationManager.h"
 #include "systemtask/SystemTask.h"
 
@@ -59,11 +60,16 @@ void ImmediateAlertService::Init() {
 int ImmediateAlertService::OnAlertLevelChanged(uint16_t attributeHandle, ble_gatt_access_ctxt* context) {
   if (attributeHandle == alertLevelHandle) {
     if (context->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
-      auto alertLevel = static_cast<Levels>(context->om->om_data[0]);
+      MbufReader reader {context->om};
+      auto alertLevel = static_cast<Levels>(reader.ReadUint8());
+      if (!reader.Ok()) {
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+      }
       auto* alertString = ToString(alertLevel);
 
       NotificationManager::Notification notif;
-      std::memcpy(notif.message.data(), alertString, strlen(alertString));
+      std::memcpy(notif.message.data(), alertString, strlen(alertString) + 1);
+      notif.size = strlen(alertString) + 1;
       notif.category = Pinetime::Controllers::NotificationManager::Categories::SimpleAlert;
       notificationManager.Push(std::move(notif));
 
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#define min // workaround: nimble's min/max macros conflict with libstdc++
+#define max
+#include <os/os_mbuf.h>
+#undef max
+#undef min
+
+namespace Pinetime {
+  namespace Controllers {
+    /*
+     * Bounds-checked cursor over the payload of an mbuf chain, as received by the GATT access callbacks.
+     *
+     * Fields are read in place from the mbufs of the chain, little-endian, so a payload split across several mbufs is
+     * parsed the same way as a flat one, without copying it into an intermediate buffer first. Reading past the end of
+     * the payload yields zeros and marks the reader as failed: a handler reads all its fields, then checks Ok() once.
+     */
+    class MbufReader {
+    public:
+      explicit MbufReader(const os_mbuf* om) : current {om}, remaining {(om != nullptr) ? OS_MBUF_PKTLEN(om) : 0u} {
+      }
+
+      size_t Remaining() const {
+        return remaining;
+      }
+
+      bool Ok() const {
+        return !failed;
+      }
+
+      uint8_t ReadUint8() {
+        return static_cast<uint8_t>(ReadLittleEndian(1));
+      }
+
+      uint16_t ReadUint16() {
+        return static_cast<uint16_t>(ReadLittleEndian(2));
+      }
+
+      int16_t ReadInt16() {
+        return static_cast<int16_t>(ReadLittleEndian(2));
+      }
+
+      uint32_t ReadUint32() {
+        return static_cast<uint32_t>(ReadLittleEndian(4));
+      }
+
+      uint64_t ReadUint64() {
+        return ReadLittleEndian(8);
+      }
+
+      // Reads a packed structure laid out in the byte order of the wire
+      template <typename T>
+      bool Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain structures can be read from a payload");
+        return ReadBytes(&value, sizeof(T));
+      }
+
+      bool ReadBytes(void* destination, size_t size) {
+        auto* output = static_cast<uint8_t*>(destination);
+        if (size > remaining) {
+          std::memset(output, 0, size);
+          Fail();
+          return false;
+        }
+        while (size > 0) {
+          const uint8_t* data;
+          size_t chunkSize = ReadChunk(data, size);
+          if (chunkSize == 0) {
+            std::memset(output, 0, size);
+            Fail();
+            return false;
+          }
+          std::memcpy(output, data, chunkSize);
+          output += chunkSize;
+          size -= chunkSize;
+        }
+        return true;
+      }
+
+      // Reads at most maxLength characters (the rest of the field is skipped) and NUL terminates them: buffer must hold
+      // maxLength + 1 characters. Returns the length of the string.
+      size_t ReadString(char* buffer, size_t length, size_t maxLength) {
+        size_t copied = (length < maxLength) ? length : maxLength;
+        ReadBytes(buffer, copied);
+        Skip(length - copied);
+        buffer[copied] = '\0';
+        return Ok() ? copied : 0;
+      }
+
+      bool Skip(size_t size) {
+        while (size > 0) {
+          const uint8_t* data;
+          size_t chunkSize = ReadChunk(data, size);
+          if (chunkSize == 0) {
+            Fail();
+            return false;
+          }
+          size -= chunkSize;
+        }
+        return true;
+      }
+
+      // Points data to the next contiguous bytes of the payload, at most maxSize, and returns their number (0 at the end
+      // of the payload). Used to consume a payload of any size without copying it.
+      size_t ReadChunk(const uint8_t*& data, size_t maxSize) {
+        while (current != nullptr && offset >= current->om_len) {
+          current = SLIST_NEXT(current, om_next);
+          offset = 0;
+        }
+        if (current == nullptr || remaining == 0) {
+          data = nullptr;
+          return 0;
+        }
+        size_t chunkSize = current->om_len - offset;
+        chunkSize = (chunkSize < maxSize) ? chunkSize : maxSize;
+        chunkSize = (chunkSize < remaining) ? chunkSize : remaining;
+        data = current->om_data + offset;
+        offset += chunkSize;
+        remaining -= chunkSize;
+        return chunkSize;
+      }
+
+    private:
+      uint64_t ReadLittleEndian(size_t size) {
+        uint8_t bytes[sizeof(uint64_t)];
+        if (!ReadBytes(bytes, size)) {
+          return 0;
+        }
+        uint64_t value = 0;
+        for (size_t i = size; i > 0; i--) {
+          value = (value << 8) | bytes[i - 1];
+        }
+        return value;
+      }
+
+      void Fail() {
+        failed = true;
+        current = nullptr;
+        remaining = 0;
+      }
+
+      const os_mbuf* current;
+      size_t offset = 0;
+      size_t remaining;
+      bool failed = false;
+    };
+  }
+}
@@ -1,6 +1,9 @@
 #include "components/ble/MotionService.h"
+#include "components/ble/MbufReader.h"
 #include "components/motion/MotionController.h"
+#include "components/motion/StepHistory.h"
 #include "components/ble/NimbleController.h"
+#include <algorithm>
 #include <nrf_log.h>
 
 using namespace Pinetime::Controllers;
@@ -20,6 +23,8 @@ namespace {
   constexpr ble_uuid128_t motionServiceUuid {BaseUuid()};
   constexpr ble_uuid128_t stepCountCharUuid {CharUuid(0x01, 0x00)};
   constexpr ble_uuid128_t motionValuesCharUuid {CharUuid(0x02, 0x00)};
+  constexpr ble_uuid128_t stepHistoryCharUuid {CharUuid(0x03, 0x00)};
+  constexpr ble_uuid128_t motionStreamCharUuid {CharUuid(0x04, 0x00)};
 
   int MotionServiceCallback(uint16_t /*conn_handle*/, uint16_t attr_handle, struct ble_gatt_access_ctxt* ctxt, void* arg) {
     auto* motionService = static_cast<MotionService*>(arg);
@@ -28,9 +33,12 @@ namespace {
 }
 
 // TODO Refactoring - remove dependency to SystemTask
-MotionService::MotionService(NimbleController& nimble, Controllers::MotionController& motionController)
+MotionService::MotionService(NimbleController& nimble,
+                             Controllers::MotionController& motionController,
+                             Controllers::StepHistory& stepHistory)
   : nimble {nimble},
     motionController {motionController},
+    stepHistory {stepHistory},
     characteristicDefinition {{.uuid = &stepCountCharUuid.u,
                                .access_cb = MotionServiceCallback,
                                .arg = this,
@@ -41,6 +49,16 @@ MotionService::MotionService(NimbleController& nimble, Controllers::MotionContro
                                .arg = this,
                                .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
                                .val_handle = &motionValuesHandle},
+                              {.uuid = &stepHistoryCharUuid.u,
+                               .access_cb = MotionServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ,
+                               .val_handle = &stepHistoryHandle},
+                              {.uuid = &motionStreamCharUuid.u,
+                               .access_cb = MotionServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_NOTIFY,
+                               .val_handle = &motionStreamHandle},
                               {0}},
     serviceDefinition {
       {.type = BLE_GATT_SVC_TYPE_PRIMARY, .uuid = &motionServiceUuid.u, .characteristics = characteristicDefinition},
@@ -71,6 +89,39 @@ int MotionService::OnStepCountRequested(uint16_t attributeHandle, ble_gatt_acces
 
     int res = os_mbuf_append(context->om, buffer, 3 * sizeof(int16_t));
     return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+  } else if (attributeHandle == stepHistoryHandle) {
+    // Today (day since epoch, 24 hourly counters) followed by the daily totals of the past days, oldest first
+    uint16_t today = stepHistory.Today();
+    int res = os_mbuf_append(context->om, &today, sizeof(today));
+    for (uint8_t hour = 0; hour < StepHistory::hoursPerDay && res == 0; hour++) {
+      uint16_t hourSteps = stepHistory.StepsInHour(hour);
+      res = os_mbuf_append(context->om, &hourSteps, sizeof(hourSteps));
+    }
+    for (size_t i = 0; i < stepHistory.NbPastDays() && res == 0; i++) {
+      const auto& pastDay = stepHistory.PastDay(i);
+      res = os_mbuf_append(context->om, &pastDay.day, sizeof(pastDay.day));
+      if (res == 0) {
+        res = os_mbuf_append(context->om, &pastDay.steps, sizeof(pastDay.steps));
+      }
+    }
+    return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+  } else if (attributeHandle == motionStreamHandle) {
+    // The rate of the stream, as the downsampling of the 100Hz of the accelerometer: 100Hz / 2^downsampling
+    if (context->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
+      MbufReader reader {context->om};
+      uint8_t downsampling = reader.ReadUint8();
+      if (!reader.Ok() || reader.Remaining() != 0) {
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+      }
+      if (downsampling > maxStreamDownsampling) {
+        return BLE_ATT_ERR_VALUE_NOT_ALLOWED;
+      }
+      motionStreamDownsampling = downsampling;
+      return 0;
+    }
+    uint8_t downsampling = motionStreamDownsampling;
+    int res = os_mbuf_append(context->om, &downsampling, sizeof(downsampling));
+    return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
   }
   return 0;
 }
@@ -92,19 +143,52 @@ void MotionService::OnNewStepCountValue(uint32_t stepCount) {
 }
 
 void MotionService::OnNewMotionValues(int16_t x, int16_t y, int16_t z) {
-  if (!motionValuesNoficationEnabled)
+  uint16_t connectionHandle = nimble.connHandle();
+  if (!motionValuesNoficationEnabled || connectionHandle == 0 || connectionHandle == BLE_HS_CONN_HANDLE_NONE) {
+    // Frames left from a previous subscription are stale
+    motionValuesBatcher.Clear();
     return;
+  }
 
-  int16_t buffer[3] = {x, y, z};
-  auto* om = ble_hs_mbuf_from_flat(buffer, 3 * sizeof(int16_t));
+  int16_t frame[3] = {x, y, z};
+  motionValuesBatcher.Add(connectionHandle, motionValuesHandle, frame);
+}
 
+void MotionService::FlushMotionValues() {
   uint16_t connectionHandle = nimble.connHandle();
+  if (!motionValuesNoficationEnabled || connectionHandle == 0 || connectionHandle == BLE_HS_CONN_HANDLE_NONE) {
+    motionValuesBatcher.Clear();
+    return;
+  }
+  motionValuesBatcher.FlushIfExpired(connectionHandle, motionValuesHandle);
+}
 
-  if (connectionHandle == 0 || connectionHandle == BLE_HS_CONN_HANDLE_NONE) {
+void MotionService::OnNewMotionFrames(const int16_t* xyz, size_t count, uint16_t skippedFrames, uint16_t periodMs) {
+  uint16_t connectionHandle = nimble.connHandle();
+  if (!motionStreamNotificationEnabled || connectionHandle == 0 || connectionHandle == BLE_HS_CONN_HANDLE_NONE) {
+    motionStream.Reset();
     return;
   }
 
-  ble_gattc_notify_custom(connectionHandle, motionValuesHandle, om);
+  auto timeMs = static_cast<uint32_t>(static_cast<uint64_t>(xTaskGetTickCount()) * 1000 / configTICK_RATE_HZ);
+  motionStream.Push(xyz, count, skippedFrames, timeMs, periodMs);
+
+  uint16_t mtu = std::max<uint16_t>(ble_att_mtu(connectionHandle), BLE_ATT_MTU_DFLT);
+  size_t payloadSize = std::min<size_t>(mtu - 3, maxStreamPayloadSize);
+  for (uint8_t i = 0; i < maxStreamNotifications && motionStream.NbPending() > 0; i++) {
+    size_t nbFrames = 0;
+    size_t length = motionStream.Encode(streamPayload, payloadSize, nbFrames);
+    auto* om = ble_hs_mbuf_from_flat(streamPayload, length);
+    // Backpressure: the frames stay in the ring until the stack has buffers to send them
+    if (om == nullptr || ble_gattc_notify_custom(connectionHandle, motionStreamHandle, om) != 0) {
+      break;
+    }
+    motionStream.Consume(nbFrames);
+  }
+}
+
+void MotionService::ResetMotionStream() {
+  motionStream.Reset();
 }
 
 void MotionService::SubscribeNotification(uint16_t attributeHandle) {
@@ -112,6 +196,8 @@ void MotionService::SubscribeNotification(uint16_t attributeHandle) {
     stepCountNoficationEnabled = true;
   else if (attributeHandle == motionValuesHandle)
     motionValuesNoficationEnabled = true;
+  else if (attributeHandle == motionStreamHandle)
+    motionStreamNotificationEnabled = true;
 }
 
 void MotionService::UnsubscribeNotification(uint16_t attributeHandle) {
@@ -119,8 +205,14 @@ void MotionService::UnsubscribeNotification(uint16_t attributeHandle) {
     stepCountNoficationEnabled = false;
   else if (attributeHandle == motionValuesHandle)
     motionValuesNoficationEnabled = false;
+  else if (attributeHandle == motionStreamHandle)
+    motionStreamNotificationEnabled = false;
 }
 
 bool MotionService::IsMotionNotificationSubscribed() const {
   return motionValuesNoficationEnabled;
 }
+
+bool MotionService::IsMotionStreamSubscribed() const {
+  return motionStreamNotificationEnabled;
+}
@@ -5,35 +5,71 @@
 #include <atomic>
 #undef max
 #undef min
+#include "components/ble/MotionStream.h"
+#include "components/ble/NotificationBatcher.h"
 
 namespace Pinetime {
   namespace Controllers {
     class NimbleController;
     class MotionController;
+    class StepHistory;
 
     class MotionService {
     public:
-      MotionService(NimbleController& nimble, Controllers::MotionController& motionController);
+      MotionService(NimbleController& nimble, Controllers::MotionController& motionController, Controllers::StepHistory& stepHistory);
       void Init();
       int OnStepCountRequested(uint16_t attributeHandle, ble_gatt_access_ctxt* context);
       void OnNewStepCountValue(uint32_t stepCount);
       void OnNewMotionValues(int16_t x, int16_t y, int16_t z);
+      void FlushMotionValues();
+      // Frames read from the FIFO of the accelerometer while the motion stream is subscribed
+      void OnNewMotionFrames(const int16_t* xyz, size_t count, uint16_t skippedFrames, uint16_t periodMs);
+      void ResetMotionStream();
 
       void SubscribeNotification(uint16_t attributeHandle);
       void UnsubscribeNotification(uint16_t attributeHandle);
       bool IsMotionNotificationSubscribed() const;
+      bool IsMotionStreamSubscribed() const;
+
+      // The stream runs at 100Hz / 2^downsampling
+      static constexpr uint8_t maxStreamDownsampling = 3;
+
+      uint8_t MotionStreamDownsampling() const {
+        return motionStreamDownsampling;
+      }
+
+      MotionStream::Statistics MotionStreamStatistics() const {
+        return motionStream.GetStatistics();
+      }
 
     private:
       NimbleController& nimble;
       Controllers::MotionController& motionController;
+      Controllers::StepHistory& stepHistory;
 
-      struct ble_gatt_chr_def characteristicDefinition[3];
+      struct ble_gatt_chr_def characteristicDefinition[5];
       struct ble_gatt_svc_def serviceDefinition[2];
 
       uint16_t stepCountHandle;
       uint16_t motionValuesHandle;
+      uint16_t stepHistoryHandle;
+      uint16_t motionStreamHandle;
       std::atomic_bool stepCountNoficationEnabled {false};
       std::atomic_bool motionValuesNoficationEnabled {false};
+      std::atomic_bool motionStreamNotificationEnabled {false};
+      std::atomic<uint8_t> motionStreamDownsampling {0};
+
+      // Frames of 3 int16_t (X, Y, Z)
+      static constexpr size_t motionFrameSize = 3 * sizeof(int16_t);
+      static constexpr size_t motionPayloadSize = 20 * motionFrameSize;
+      static constexpr TickType_t motionMaxLatency = pdMS_TO_TICKS(250);
+      NotificationBatcher<motionFrameSize, motionPayloadSize> motionValuesBatcher {motionMaxLatency};
+
+      // Notifications sent per read of the FIFO, the other frames wait for the next read
+      static constexpr uint8_t maxStreamNotifications = 4;
+      static constexpr size_t maxStreamPayloadSize = 128;
+      MotionStream motionStream;
+      uint8_t streamPayload[maxStreamPayloadSize];
     };
   }
 }
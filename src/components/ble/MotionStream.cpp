@@ -0,0 +1,97 @@
+#include "components/ble/MotionStream.h"
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  size_t PutUint16(uint8_t* buffer, uint16_t value) {
+    buffer[0] = static_cast<uint8_t>(value);
+    buffer[1] = static_cast<uint8_t>(value >> 8);
+    return sizeof(value);
+  }
+
+  size_t PutDelta(uint8_t* buffer, int16_t previous, int16_t value) {
+    auto delta = static_cast<int16_t>(value - previous);
+    auto zigzag = static_cast<uint16_t>((delta << 1) ^ (delta >> 15));
+    size_t length = 0;
+    while (zigzag >= 0x80) {
+      buffer[length++] = static_cast<uint8_t>(zigzag | 0x80);
+      zigzag >>= 7;
+    }
+    buffer[length++] = static_cast<uint8_t>(zigzag);
+    return length;
+  }
+}
+
+void MotionStream::Reset() {
+  first = 0;
+  nbPending = 0;
+  nextSequence = 0;
+  statistics = {};
+}
+
+void MotionStream::Push(const int16_t* xyz, size_t count, uint16_t skippedFrames, uint32_t timeMs, uint16_t periodMs) {
+  nextSequence += skippedFrames;
+  statistics.lost += skippedFrames;
+
+  for (size_t i = 0; i < count; i++) {
+    if (nbPending == maxPendingFrames) {
+      first = (first + 1) % maxPendingFrames;
+      nbPending--;
+      statistics.lost++;
+    }
+    frames[(first + nbPending) % maxPendingFrames] = {nextSequence++, xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2]};
+    nbPending++;
+  }
+  statistics.frames += count;
+
+  if (count > 0) {
+    anchorSequence = nextSequence - 1;
+    anchorTime = static_cast<uint16_t>(timeMs);
+    period = periodMs;
+  }
+}
+
+size_t MotionStream::Encode(uint8_t* payload, size_t payloadSize, size_t& nbFrames) const {
+  nbFrames = 0;
+  if (nbPending == 0 || payloadSize < headerSize + firstFrameSize) {
+    return 0;
+  }
+
+  const Frame& firstFrame = At(0);
+  auto time = static_cast<uint16_t>(anchorTime - static_cast<uint16_t>(anchorSequence - firstFrame.sequence) * period);
+  size_t length = PutUint16(payload, firstFrame.sequence);
+  length += PutUint16(payload + length, time);
+  length += PutUint16(payload + length, firstFrame.x);
+  length += PutUint16(payload + length, firstFrame.y);
+  length += PutUint16(payload + length, firstFrame.z);
+  nbFrames = 1;
+
+  while (nbFrames < nbPending) {
+    const Frame& previous = At(nbFrames - 1);
+    const Frame& frame = At(nbFrames);
+    if (frame.sequence != static_cast<uint16_t>(previous.sequence + 1)) {
+      break;
+    }
+    uint8_t deltas[9];
+    size_t deltasLength = PutDelta(deltas, previous.x, frame.x);
+    deltasLength += PutDelta(deltas + deltasLength, previous.y, frame.y);
+    deltasLength += PutDelta(deltas + deltasLength, previous.z, frame.z);
+    if (length + deltasLength > payloadSize) {
+      break;
+    }
+    for (size_t i = 0; i < deltasLength; i++) {
+      payload[length++] = deltas[i];
+    }
+    nbFrames++;
+  }
+  return length;
+}
+
+void MotionStream::Consume(size_t nbFrames) {
+  if (nbFrames > nbPending) {
+    nbFrames = nbPending;
+  }
+  first = (first + nbFrames) % maxPendingFrames;
+  nbPending -= nbFrames;
+  statistics.notifications++;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Controllers {
+    /*
+     * Raw accelerations streamed by MotionService, packed in notifications.
+     *
+     * Frames read from the FIFO of the accelerometer wait in a ring until they're sent. When a notification can't be
+     * sent (the BLE stack is out of buffers), the frames are kept and retried after the next read, and the oldest ones
+     * are only dropped once the ring is full. Each frame gets a sequence number, so that the client detects the frames
+     * lost either by the accelerometer (full FIFO) or by the watch.
+     *
+     * Notification payload, little-endian:
+     *  - uint16_t : sequence number of the first frame
+     *  - uint16_t : time of the first frame, in ms (16 LSB of the time since boot)
+     *  - 3 x int16_t : X, Y, Z of the first frame
+     *  - then for each next frame, X, Y, Z as the difference to the previous frame (modulo 2^16), encoded as zigzag
+     *    varints. A notification only holds consecutive frames.
+     */
+    class MotionStream {
+    public:
+      static constexpr size_t maxPendingFrames = 48;
+      static constexpr size_t headerSize = 2 * sizeof(uint16_t);
+      static constexpr size_t firstFrameSize = 3 * sizeof(int16_t);
+
+      struct Statistics {
+        uint32_t frames;
+        // Frames lost by the accelerometer, or dropped because the ring was full
+        uint32_t lost;
+        uint32_t notifications;
+      };
+
+      void Reset();
+      // xyz holds count X/Y/Z triplets, the last one sampled at timeMs
+      void Push(const int16_t* xyz, size_t count, uint16_t skippedFrames, uint32_t timeMs, uint16_t periodMs);
+
+      // Encodes the oldest pending frames in payload and returns its size (0 if there's no pending frame)
+      size_t Encode(uint8_t* payload, size_t payloadSize, size_t& nbFrames) const;
+      // Removes the frames that were sent
+      void Consume(size_t nbFrames);
+
+      size_t NbPending() const {
+        return nbPending;
+      }
+
+      Statistics GetStatistics() const {
+        return statistics;
+      }
+
+    private:
+      struct Frame {
+        uint16_t sequence;
+        int16_t x;
+        int16_t y;
+        int16_t z;
+      };
+
+      const Frame& At(size_t index) const {
+        return frames[(first + index) % maxPendingFrames];
+      }
+
+      std::array<Frame, maxPendingFrames> frames;
+      size_t first = 0;
+      size_t nbPending = 0;
+
+      uint16_t nextSequence = 0;
+      // Time of the frame anchorSequence, from which the time of the other frames is computed
+      uint16_t anchorSequence = 0;
+      uint16_t anchorTime = 0;
+      uint16_t period = 0;
+
+      Statistics statistics {};
+    };
+  }
+}
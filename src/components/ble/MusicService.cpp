@@ -16,6 +16,7 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 #include "components/ble/MusicService.h"
+#include "components/ble/MbufReader.h"
 #include "components/ble/NimbleController.h"
 #include <cstring>
 
@@ -46,8 +47,6 @@ namespace {
   constexpr ble_uuid128_t msRepeatCharUuid {CharUuid(0x0b, 0x00)};
   constexpr ble_uuid128_t msShuffleCharUuid {CharUuid(0x0c, 0x00)};
 
-  constexpr uint8_t MaxStringSize {40};
-
   int MusicCallback(uint16_t /*conn_handle*/, uint16_t /*attr_handle*/, struct ble_gatt_access_ctxt* ctxt, void* arg) {
     return static_cast<Pinetime::Controllers::MusicService*>(arg)->OnCommand(ctxt);
   }
@@ -124,29 +123,24 @@ void Pinetime::Controllers::MusicService::Init() {
 
 int Pinetime::Controllers::MusicService::OnCommand(struct ble_gatt_access_ctxt* ctxt) {
   if (ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
-    size_t notifSize = OS_MBUF_PKTLEN(ctxt->om);
-    size_t bufferSize = notifSize;
-    if (notifSize > MaxStringSize) {
-      bufferSize = MaxStringSize;
-    }
-
-    char data[bufferSize + 1];
-    os_mbuf_copydata(ctxt->om, 0, bufferSize, data);
+    MbufReader reader {ctxt->om};
+    size_t notifSize = reader.Remaining();
+    char data[maxStringSize + 1];
+    size_t bufferSize = reader.ReadString(data, notifSize, maxStringSize);
 
     if (notifSize > bufferSize) {
       data[bufferSize - 1] = '.';
       data[bufferSize - 2] = '.';
       data[bufferSize - 3] = '.';
     }
-    data[bufferSize] = '\0';
 
     char* s = &data[0];
     if (ble_uuid_cmp(ctxt->chr->uuid, &msArtistCharUuid.u) == 0) {
-      artistName = s;
+      artistName.Assign(s);
     } else if (ble_uuid_cmp(ctxt->chr->uuid, &msTrackCharUuid.u) == 0) {
-      trackName = s;
+      trackName.Assign(s);
     } else if (ble_uuid_cmp(ctxt->chr->uuid, &msAlbumCharUuid.u) == 0) {
-      albumName = s;
+      albumName.Assign(s);
     } else if (ble_uuid_cmp(ctxt->chr->uuid, &msStatusCharUuid.u) == 0) {
       playing = s[0];
       // These variables need to be updated, because the progress may not be updated immediately,
@@ -177,15 +171,15 @@ int Pinetime::Controllers::MusicService::OnCommand(struct ble_gatt_access_ctxt*
   return 0;
 }
 
-std::string Pinetime::Controllers::MusicService::getAlbum() const {
+const Pinetime::Controllers::MusicService::String& Pinetime::Controllers::MusicService::getAlbum() const {
   return albumName;
 }
 
-std::string Pinetime::Controllers::MusicService::getArtist() const {
+const Pinetime::Controllers::MusicService::String& Pinetime::Controllers::MusicService::getArtist() const {
   return artistName;
 }
 
-std::string Pinetime::Controllers::MusicService::getTrack() const {
+const Pinetime::Controllers::MusicService::String& Pinetime::Controllers::MusicService::getTrack() const {
   return trackName;
 }
 
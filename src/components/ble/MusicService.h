@@ -18,13 +18,13 @@
 #pragma once
 
 #include <cstdint>
-#include <string>
 #define min // workaround: nimble's min/max macros conflict with libstdc++
 #define max
 #include <host/ble_gap.h>
 #include <host/ble_uuid.h>
 #undef max
 #undef min
+#include "utility/InlineString.h"
 
 namespace Pinetime {
   namespace Controllers {
@@ -32,6 +32,9 @@ namespace Pinetime {
 
     class MusicService {
     public:
+      static constexpr size_t maxStringSize = 40;
+      using String = Utility::InlineString<maxStringSize>;
+
       explicit MusicService(NimbleController& nimble);
 
       void Init();
@@ -40,11 +43,11 @@ namespace Pinetime {
 
       void event(char event);
 
-      std::string getArtist() const;
+      const String& getArtist() const;
 
-      std::string getTrack() const;
+      const String& getTrack() const;
 
-      std::string getAlbum() const;
+      const String& getAlbum() const;
 
       int getProgress() const;
 
@@ -70,9 +73,9 @@ namespace Pinetime {
 
       uint16_t eventHandle {};
 
-      std::string artistName {"Waiting for"};
-      std::string albumName {};
-      std::string trackName {"track information.."};
+      String artistName {"Waiting for"};
+      String albumName {};
+      String trackName {"track information.."};
 
       bool playing {false};
 
@@ -17,6 +17,8 @@
 */
 
 #include "components/ble/NavigationService.h"
+#include <algorithm>
+#include "components/ble/MbufReader.h"
 
 namespace {
   // 0001yyxx-78fc-48fe-8e23-433b3a1942d0
@@ -37,6 +39,8 @@ namespace {
   constexpr ble_uuid128_t navManDistCharUuid {CharUuid(0x03, 0x00)};
   constexpr ble_uuid128_t navProgressCharUuid {CharUuid(0x04, 0x00)};
 
+  constexpr size_t maxStringSize = 80;
+
   int NAVCallback(uint16_t /*conn_handle*/, uint16_t /*attr_handle*/, struct ble_gatt_access_ctxt* ctxt, void* arg) {
     auto* navService = static_cast<Pinetime::Controllers::NavigationService*>(arg);
     return navService->OnCommand(ctxt);
@@ -82,33 +86,33 @@ void Pinetime::Controllers::NavigationService::Init() {
 int Pinetime::Controllers::NavigationService::OnCommand(struct ble_gatt_access_ctxt* ctxt) {
 
   if (ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
-    size_t notifSize = OS_MBUF_PKTLEN(ctxt->om);
-    uint8_t data[notifSize + 1];
-    data[notifSize] = '\0';
-    os_mbuf_copydata(ctxt->om, 0, notifSize, data);
-    char* s = (char*) &data[0];
+    // Longer strings are truncated by InlineString::Assign()
+    MbufReader reader {ctxt->om};
+    char data[maxStringSize + 1];
+    reader.ReadString(data, reader.Remaining(), maxStringSize);
+    char* s = &data[0];
     if (ble_uuid_cmp(ctxt->chr->uuid, &navFlagCharUuid.u) == 0) {
-      m_flag = s;
+      m_flag.Assign(s);
     } else if (ble_uuid_cmp(ctxt->chr->uuid, &navNarrativeCharUuid.u) == 0) {
-      m_narrative = s;
+      m_narrative.Assign(s);
     } else if (ble_uuid_cmp(ctxt->chr->uuid, &navManDistCharUuid.u) == 0) {
-      m_manDist = s;
+      m_manDist.Assign(s);
     } else if (ble_uuid_cmp(ctxt->chr->uuid, &navProgressCharUuid.u) == 0) {
-      m_progress = data[0];
+      m_progress = static_cast<uint8_t>(data[0]);
     }
   }
   return 0;
 }
 
-std::string Pinetime::Controllers::NavigationService::getFlag() {
+const Pinetime::Controllers::NavigationService::Flag& Pinetime::Controllers::NavigationService::getFlag() const {
   return m_flag;
 }
 
-std::string Pinetime::Controllers::NavigationService::getNarrative() {
+const Pinetime::Controllers::NavigationService::Narrative& Pinetime::Controllers::NavigationService::getNarrative() const {
   return m_narrative;
 }
 
-std::string Pinetime::Controllers::NavigationService::getManDist() {
+const Pinetime::Controllers::NavigationService::ManDist& Pinetime::Controllers::NavigationService::getManDist() const {
   return m_manDist;
 }
 
@@ -7,6 +7,7 @@
 #include <host/ble_gap.h>
 #include <host/ble_hs.h>
 #include <host/ble_hs_id.h>
+#include <host/ble_store.h>
 #include <host/util/util.h>
 #include <controller/ble_ll.h>
 #include <controller/ble_hw.h>
@@ -22,6 +23,12 @@
 
 using namespace Pinetime::Controllers;
 
+namespace {
+  // Callbacks of the RAM store of NimBLE, wrapped to keep the copy of the bond up to date
+  ble_store_write_fn* nimbleStoreWrite = nullptr;
+  ble_store_delete_fn* nimbleStoreDelete = nullptr;
+}
+
 NimbleController::NimbleController(Pinetime::System::SystemTask& systemTask,
                                    Ble& bleController,
                                    DateTime& dateTimeController,
@@ -29,7 +36,9 @@ NimbleController::NimbleController(Pinetime::System::SystemTask& systemTask,
                                    Battery& batteryController,
                                    Pinetime::Drivers::SpiNorFlash& spiNorFlash,
                                    HeartRateController& heartRateController,
+                                   HeartRateHistory& heartRateHistory,
                                    MotionController& motionController,
+                                   StepHistory& stepHistory,
                                    FS& fs)
   : systemTask {systemTask},
     bleController {bleController},
@@ -46,10 +55,12 @@ NimbleController::NimbleController(Pinetime::System::SystemTask& systemTask,
     weatherService {dateTimeController},
     batteryInformationService {batteryController},
     immediateAlertService {systemTask, notificationManager},
-    heartRateService {*this, heartRateController},
-    motionService {*this, motionController},
+    heartRateService {*this, heartRateController, heartRateHistory},
+    motionService {*this, motionController, stepHistory},
     fsService {systemTask, fs},
-    serviceDiscovery({&currentTimeClient, &alertNotificationClient}) {
+    profilerService {systemTask},
+    serviceDiscovery({&currentTimeClient, &alertNotificationClient, &serviceChangedClient}),
+    bondStore {fs} {
 }
 
 void nimble_on_reset(int reason) {
@@ -78,6 +89,7 @@ void NimbleController::Init() {
   }
 
   nptr = this;
+  connectionPolicyTimer = xTimerCreate("connPolicy", 1, pdFALSE, this, ConnectionPolicyTimerCallback);
   ble_hs_cfg.reset_cb = nimble_on_reset;
   ble_hs_cfg.sync_cb = nimble_on_sync;
   ble_hs_cfg.store_status_cb = ble_store_util_status_rr;
@@ -98,6 +110,7 @@ void NimbleController::Init() {
   heartRateService.Init();
   motionService.Init();
   fsService.Init();
+  profilerService.Init();
 
   int rc;
   rc = ble_hs_util_ensure_addr(0);
@@ -131,7 +144,12 @@ void NimbleController::Init() {
   rc = ble_gatts_start();
   ASSERT(rc == 0);
 
-  RestoreBond();
+  // Hooked after the restoration, during which the bond is incomplete in the store
+  bondStore.Restore();
+  nimbleStoreWrite = ble_hs_cfg.store_write_cb;
+  nimbleStoreDelete = ble_hs_cfg.store_delete_cb;
+  ble_hs_cfg.store_write_cb = StoreWriteCallback;
+  ble_hs_cfg.store_delete_cb = StoreDeleteCallback;
 
   StartAdvertising();
 }
@@ -195,17 +213,25 @@ int NimbleController::OnGAPEvent(ble_gap_event* event) {
 
       if (event->connect.status != 0) {
         /* Connection failed; resume advertising. */
-        currentTimeClient.Reset();
-        alertNotificationClient.Reset();
+        ResetClients();
         connectionHandle = BLE_HS_CONN_HANDLE_NONE;
         bleController.Disconnect();
         fastAdvCount = 0;
         StartAdvertising();
       } else {
         connectionHandle = event->connect.conn_handle;
+        connectedTick = xTaskGetTickCount();
         bleController.Connect();
+
+        struct ble_gap_conn_desc desc;
+        if (ble_gap_conn_find(connectionHandle, &desc) == 0) {
+          taskENTER_CRITICAL();
+          connectionPolicy.OnConnected(xTaskGetTickCount(), desc.conn_itvl, desc.conn_latency);
+          taskEXIT_CRITICAL();
+        }
         systemTask.PushMessage(Pinetime::System::Messages::BleConnected);
-        // Service discovery is deferred via systemtask
+        // Service discovery and connection parameters requests are deferred via systemtask
+        systemTask.PushMessage(Pinetime::System::Messages::UpdateBleConnection);
       }
       break;
 
@@ -214,12 +240,20 @@ int NimbleController::OnGAPEvent(ble_gap_event* event) {
       NRF_LOG_INFO("Disconnect event : BLE_GAP_EVENT_DISCONNECT");
       NRF_LOG_INFO("disconnect reason=%d", event->disconnect.reason);
 
-      if (event->disconnect.conn.sec_state.bonded) {
-        PersistBond(event->disconnect.conn);
+      if (connectionPolicy.IsConnected()) {
+        taskENTER_CRITICAL();
+        auto statistics = connectionPolicy.GetStatistics(xTaskGetTickCount());
+        connectionPolicy.OnDisconnected(xTaskGetTickCount());
+        taskEXIT_CRITICAL();
+        NRF_LOG_INFO("connection stats : requests=%d rejections=%d renegotiations=%d bytes=%d transfer=%dms",
+                     statistics.requests,
+                     statistics.rejections,
+                     statistics.renegotiations,
+                     statistics.transferredBytes,
+                     statistics.transferMilliseconds);
       }
 
-      currentTimeClient.Reset();
-      alertNotificationClient.Reset();
+      ResetClients();
       connectionHandle = BLE_HS_CONN_HANDLE_NONE;
       if (bleController.IsConnected()) {
         bleController.Disconnect();
@@ -232,6 +266,17 @@ int NimbleController::OnGAPEvent(ble_gap_event* event) {
       /* The central has updated the connection parameters. */
       NRF_LOG_INFO("Update event : BLE_GAP_EVENT_CONN_UPDATE");
       NRF_LOG_INFO("update status=%0X ", event->conn_update.status);
+      {
+        struct ble_gap_conn_desc desc;
+        if (ble_gap_conn_find(event->conn_update.conn_handle, &desc) == 0) {
+          NRF_LOG_INFO("new parameters : itvl=%d latency=%d supervision=%d", desc.conn_itvl, desc.conn_latency, desc.supervision_timeout);
+          taskENTER_CRITICAL();
+          connectionPolicy.OnUpdated(event->conn_update.status == 0, desc.conn_itvl, desc.conn_latency);
+          taskEXIT_CRITICAL();
+        }
+      }
+      // The workload may have changed while the update was running
+      systemTask.PushMessage(Pinetime::System::Messages::UpdateBleConnection);
       break;
 
     case BLE_GAP_EVENT_CONN_UPDATE_REQ:
@@ -252,8 +297,10 @@ int NimbleController::OnGAPEvent(ble_gap_event* event) {
       if (event->enc_change.status == 0) {
         struct ble_gap_conn_desc desc;
         ble_gap_conn_find(event->enc_change.conn_handle, &desc);
-        if (desc.sec_state.bonded) {
-          PersistBond(desc);
+        // Recognizes the indications sent by the phone as soon as the link is encrypted, before the discovery
+        if (desc.sec_state.bonded && bondStore.IsBondedWith(desc.peer_id_addr)) {
+          const auto handles = bondStore.GetHandles();
+          serviceChangedClient.UseCachedHandles(handles.serviceChanged, handles.serviceChangedDescriptor);
         }
 
         NRF_LOG_INFO("new state: encrypted=%d authenticated=%d bonded=%d key_size=%d",
@@ -329,6 +376,7 @@ int NimbleController::OnGAPEvent(ble_gap_event* event) {
         heartRateService.UnsubscribeNotification(event->subscribe.attr_handle);
         motionService.UnsubscribeNotification(event->subscribe.attr_handle);
       }
+      UpdateMotionWorkload();
       break;
 
     case BLE_GAP_EVENT_MTU:
@@ -366,7 +414,11 @@ int NimbleController::OnGAPEvent(ble_gap_event* event) {
                    event->notify_rx.attr_handle,
                    notifSize);
 
-      alertNotificationClient.OnNotification(event);
+      if (serviceChangedClient.IsServiceChangedIndication(event)) {
+        OnServiceChanged(event->notify_rx.conn_handle);
+      } else {
+        alertNotificationClient.OnNotification(event);
+      }
     } break;
 
     case BLE_GAP_EVENT_NOTIFY_TX:
@@ -385,9 +437,82 @@ int NimbleController::OnGAPEvent(ble_gap_event* event) {
 }
 
 void NimbleController::StartDiscovery() {
-  if (connectionHandle != BLE_HS_CONN_HANDLE_NONE) {
-    serviceDiscovery.StartDiscovery(connectionHandle);
+  if (connectionHandle == BLE_HS_CONN_HANDLE_NONE) {
+    return;
   }
+
+  // The handles found during a previous connection are valid until the phone indicates that its services changed.
+  // Each client also checks its handles before using them.
+  struct ble_gap_conn_desc desc;
+  if (ble_gap_conn_find(connectionHandle, &desc) == 0 && desc.sec_state.bonded && bondStore.IsBondedWith(desc.peer_id_addr)) {
+    const auto handles = bondStore.GetHandles();
+    currentTimeClient.UseCachedHandle(handles.currentTime);
+    alertNotificationClient.UseCachedHandles(handles.newAlert, handles.newAlertDescriptor);
+    serviceChangedClient.UseCachedHandles(handles.serviceChanged, handles.serviceChangedDescriptor);
+  }
+  discoveryState = DiscoveryStates::Running;
+  serviceDiscovery.StartDiscovery(connectionHandle, [this](uint16_t handle) {
+    OnDiscoveryDone(handle);
+  });
+}
+
+void NimbleController::OnDiscoveryDone(uint16_t connectionHandle) {
+  discoveryState = DiscoveryStates::Done;
+  // The services changed during the discovery: the handles found may be stale
+  if (rediscoveryNeeded.exchange(false)) {
+    ResetClients();
+    StartDiscovery();
+    return;
+  }
+
+  struct ble_gap_conn_desc desc;
+  if (ble_gap_conn_find(connectionHandle, &desc) != 0) {
+    return;
+  }
+  if (desc.sec_state.bonded) {
+    bondStore.SetHandles(desc.peer_id_addr,
+                         {currentTimeClient.CurrentTimeHandle(),
+                          alertNotificationClient.NewAlertHandle(),
+                          alertNotificationClient.NewAlertDescriptorHandle(),
+                          serviceChangedClient.ServiceChangedHandle(),
+                          serviceChangedClient.ServiceChangedDescriptorHandle()});
+  }
+  NRF_LOG_INFO("connection ready in %dms", static_cast<int>((xTaskGetTickCount() - connectedTick) * 1000 / configTICK_RATE_HZ));
+}
+
+void NimbleController::OnServiceChanged(uint16_t connectionHandle) {
+  NRF_LOG_INFO("Services of the peer changed, forgetting the cached handles");
+  struct ble_gap_conn_desc desc;
+  if (ble_gap_conn_find(connectionHandle, &desc) == 0 && bondStore.IsBondedWith(desc.peer_id_addr)) {
+    // The handle of Service Changed itself never changes for bonded peers
+    auto handles = bondStore.GetHandles();
+    bondStore.SetHandles(desc.peer_id_addr, {0, 0, 0, handles.serviceChanged, handles.serviceChangedDescriptor});
+  }
+
+  // A discovery that didn't start yet uses the cleared handles, a running one is restarted once done
+  switch (discoveryState) {
+    case DiscoveryStates::NotStarted:
+      break;
+    case DiscoveryStates::Running:
+      rediscoveryNeeded = true;
+      break;
+    case DiscoveryStates::Done:
+      ResetClients();
+      StartDiscovery();
+      break;
+  }
+}
+
+void NimbleController::ResetClients() {
+  currentTimeClient.Reset();
+  alertNotificationClient.Reset();
+  serviceChangedClient.Reset();
+  discoveryState = DiscoveryStates::NotStarted;
+  rediscoveryNeeded = false;
+}
+
+void NimbleController::SaveBond() {
+  bondStore.Save();
 }
 
 uint16_t NimbleController::connHandle() {
@@ -417,81 +542,97 @@ void NimbleController::DisableRadio() {
   }
 }
 
-void NimbleController::PersistBond(struct ble_gap_conn_desc& desc) {
-  union ble_store_key key;
-  union ble_store_value our_sec, peer_sec, peer_cccd_set[MYNEWT_VAL(BLE_STORE_MAX_CCCDS)] = {0};
-  int rc;
-
-  memset(&key, 0, sizeof key);
-  memset(&our_sec, 0, sizeof our_sec);
-  key.sec.peer_addr = desc.peer_id_addr;
-  rc = ble_store_read_our_sec(&key.sec, &our_sec.sec);
-
-  if (memcmp(&our_sec.sec, &bondId, sizeof bondId) == 0) {
-    return;
-  }
+// The connection policy is updated by the BLE task (GAP events, BLE FS and DFU transfers) and by SystemTask (workloads,
+// requests): all its accesses are done in critical sections
+void NimbleController::StartWorkload(ConnectionPolicy::Workloads workload) {
+  taskENTER_CRITICAL();
+  connectionPolicy.StartWorkload(workload, xTaskGetTickCount());
+  taskEXIT_CRITICAL();
+  systemTask.PushMessage(Pinetime::System::Messages::UpdateBleConnection);
+}
 
-  memcpy(&bondId, &our_sec.sec, sizeof bondId);
+void NimbleController::StopWorkload(ConnectionPolicy::Workloads workload) {
+  taskENTER_CRITICAL();
+  connectionPolicy.StopWorkload(workload, xTaskGetTickCount());
+  taskEXIT_CRITICAL();
+  systemTask.PushMessage(Pinetime::System::Messages::UpdateBleConnection);
+}
 
-  memset(&key, 0, sizeof key);
-  memset(&peer_sec, 0, sizeof peer_sec);
-  key.sec.peer_addr = desc.peer_id_addr;
-  rc += ble_store_read_peer_sec(&key.sec, &peer_sec.sec);
+void NimbleController::AddTransferredBytes(uint32_t bytes) {
+  taskENTER_CRITICAL();
+  connectionPolicy.OnTransferred(bytes);
+  taskEXIT_CRITICAL();
+}
 
-  if (rc == 0) {
-    memset(&key, 0, sizeof key);
-    key.cccd.peer_addr = desc.peer_id_addr;
-    int peer_count = 0;
-    ble_store_util_count(BLE_STORE_OBJ_TYPE_CCCD, &peer_count);
-    for (int i = 0; i < peer_count; i++) {
-      key.cccd.idx = peer_count;
-      ble_store_read_cccd(&key.cccd, &peer_cccd_set[i].cccd);
+void NimbleController::UpdateConnection() {
+  TickType_t now = xTaskGetTickCount();
+  ConnectionPolicy::Profiles profile;
+  taskENTER_CRITICAL();
+  bool request = connectionHandle != BLE_HS_CONN_HANDLE_NONE && connectionPolicy.NextRequest(now, profile);
+  taskEXIT_CRITICAL();
+  if (request) {
+    const auto& parameters = ConnectionPolicy::ParametersOf(profile);
+    struct ble_gap_upd_params params = {};
+    params.itvl_min = parameters.intervalMin;
+    params.itvl_max = parameters.intervalMax;
+    params.latency = parameters.latency;
+    params.supervision_timeout = parameters.supervisionTimeout;
+    int rc = ble_gap_update_params(connectionHandle, &params);
+    NRF_LOG_INFO("connection parameters request : profile=%d rc=%d", static_cast<int>(profile), rc);
+    if (rc != 0) {
+      taskENTER_CRITICAL();
+      connectionPolicy.OnRequestFailed();
+      taskEXIT_CRITICAL();
     }
-
-    /* Wakeup Spi and SpiNorFlash before accessing the file system
-     * This should be fixed in the FS driver
-     */
-    systemTask.PushMessage(Pinetime::System::Messages::GoToRunning);
-    systemTask.PushMessage(Pinetime::System::Messages::DisableSleeping);
-    vTaskDelay(10);
-
-    lfs_file_t file_p;
-
-    rc = fs.FileOpen(&file_p, "/bond.dat", LFS_O_WRONLY | LFS_O_CREAT);
-    if (rc == 0) {
-      fs.FileWrite(&file_p, reinterpret_cast<uint8_t*>(&our_sec.sec), sizeof our_sec);
-      fs.FileWrite(&file_p, reinterpret_cast<uint8_t*>(&peer_sec.sec), sizeof peer_sec);
-      fs.FileWrite(&file_p, reinterpret_cast<const uint8_t*>(&peer_count), 1);
-      for (int i = 0; i < peer_count; i++) {
-        fs.FileWrite(&file_p, reinterpret_cast<uint8_t*>(&peer_cccd_set[i].cccd), sizeof(struct ble_store_value_cccd));
-      }
-      fs.FileClose(&file_p);
+#if MYNEWT_VAL(BLE_LL_CFG_FEAT_LE_2M_PHY)
+    else if (profile == ConnectionPolicy::Profiles::Transfer) {
+      ble_gap_set_prefered_le_phy(connectionHandle, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_CODED_ANY);
     }
-    systemTask.PushMessage(Pinetime::System::Messages::EnableSleeping);
+#endif
+  }
+
+  taskENTER_CRITICAL();
+  TickType_t delay = connectionPolicy.NextDeadline(now);
+  taskEXIT_CRITICAL();
+  if (delay == portMAX_DELAY) {
+    xTimerStop(connectionPolicyTimer, 0);
+  } else {
+    xTimerChangePeriod(connectionPolicyTimer, (delay > 0) ? delay : 1, 0);
   }
 }
 
-void NimbleController::RestoreBond() {
-  lfs_file_t file_p;
-  union ble_store_value sec, cccd;
-  uint8_t peer_count = 0;
+ConnectionPolicy::Statistics NimbleController::ConnectionStatistics() const {
+  taskENTER_CRITICAL();
+  auto statistics = connectionPolicy.GetStatistics(xTaskGetTickCount());
+  taskEXIT_CRITICAL();
+  return statistics;
+}
 
-  if (fs.FileOpen(&file_p, "/bond.dat", LFS_O_RDONLY) == 0) {
-    memset(&sec, 0, sizeof sec);
-    fs.FileRead(&file_p, reinterpret_cast<uint8_t*>(&sec.sec), sizeof sec);
-    ble_store_write_our_sec(&sec.sec);
+void NimbleController::ConnectionPolicyTimerCallback(TimerHandle_t xTimer) {
+  auto* nimbleController = static_cast<NimbleController*>(pvTimerGetTimerID(xTimer));
+  nimbleController->systemTask.PushMessage(Pinetime::System::Messages::UpdateBleConnection);
+}
 
-    memset(&sec, 0, sizeof sec);
-    fs.FileRead(&file_p, reinterpret_cast<uint8_t*>(&sec.sec), sizeof sec);
-    ble_store_write_peer_sec(&sec.sec);
+void NimbleController::UpdateMotionWorkload() {
+  if (motionService.IsMotionNotificationSubscribed() || motionService.IsMotionStreamSubscribed()) {
+    StartWorkload(ConnectionPolicy::Workloads::MotionStreaming);
+  } else {
+    StopWorkload(ConnectionPolicy::Workloads::MotionStreaming);
+  }
+}
 
-    fs.FileRead(&file_p, &peer_count, 1);
-    for (int i = 0; i < peer_count; i++) {
-      fs.FileRead(&file_p, reinterpret_cast<uint8_t*>(&cccd.cccd), sizeof(struct ble_store_value_cccd));
-      ble_store_write_cccd(&cccd.cccd);
-    }
+int NimbleController::StoreWriteCallback(int objectType, const union ble_store_value* value) {
+  int rc = nimbleStoreWrite(objectType, value);
+  if (rc == 0) {
+    nptr->bondStore.Update((objectType == BLE_STORE_OBJ_TYPE_CCCD) ? value->cccd.peer_addr : value->sec.peer_addr);
+  }
+  return rc;
+}
 
-    fs.FileClose(&file_p);
-    fs.FileDelete("/bond.dat");
+int NimbleController::StoreDeleteCallback(int objectType, const union ble_store_key* key) {
+  int rc = nimbleStoreDelete(objectType, key);
+  if (rc == 0) {
+    nptr->bondStore.Update((objectType == BLE_STORE_OBJ_TYPE_CCCD) ? key->cccd.peer_addr : key->sec.peer_addr);
   }
+  return rc;
 }
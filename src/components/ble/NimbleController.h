@@ -1,5 +1,8 @@
 #pragma once
 
+#include <FreeRTOS.h>
+#include <timers.h>
+#include <atomic>
 #include <cstdint>
 
 #define min // workaround: nimble's min/max macros conflict with libstdc++
@@ -10,6 +13,8 @@
 #include "components/ble/AlertNotificationClient.h"
 #include "components/ble/AlertNotificationService.h"
 #include "components/ble/BatteryInformationService.h"
+#include "components/ble/BondStore.h"
+#include "components/ble/ConnectionPolicy.h"
 #include "components/ble/CurrentTimeClient.h"
 #include "components/ble/CurrentTimeService.h"
 #include "components/ble/DeviceInformationService.h"
@@ -19,8 +24,10 @@
 #include "components/ble/ImmediateAlertService.h"
 #include "components/ble/MusicService.h"
 #include "components/ble/NavigationService.h"
+#include "components/ble/ServiceChangedClient.h"
 #include "components/ble/ServiceDiscovery.h"
 #include "components/ble/MotionService.h"
+#include "components/ble/ProfilerService.h"
 #include "components/ble/SimpleWeatherService.h"
 #include "components/fs/FS.h"
 
@@ -48,7 +55,9 @@ namespace Pinetime {
                        Battery& batteryController,
                        Pinetime::Drivers::SpiNorFlash& spiNorFlash,
                        HeartRateController& heartRateController,
+                       HeartRateHistory& heartRateHistory,
                        MotionController& motionController,
+                       StepHistory& stepHistory,
                        FS& fs);
       void Init();
       void StartAdvertising();
@@ -81,9 +90,25 @@ namespace Pinetime {
       void EnableRadio();
       void DisableRadio();
 
+      void StartWorkload(ConnectionPolicy::Workloads workload);
+      void StopWorkload(ConnectionPolicy::Workloads workload);
+      void AddTransferredBytes(uint32_t bytes);
+      // Requests the connection parameters chosen by the policy, called by SystemTask
+      void UpdateConnection();
+      ConnectionPolicy::Statistics ConnectionStatistics() const;
+
+      // Writes the bond to the file system if it changed, called by SystemTask when the SPI flash is awake
+      void SaveBond();
+
     private:
-      void PersistBond(struct ble_gap_conn_desc& desc);
-      void RestoreBond();
+      static void ConnectionPolicyTimerCallback(TimerHandle_t xTimer);
+      void UpdateMotionWorkload();
+      void OnDiscoveryDone(uint16_t connectionHandle);
+      void OnServiceChanged(uint16_t connectionHandle);
+      void ResetClients();
+
+      static int StoreWriteCallback(int objectType, const union ble_store_value* value);
+      static int StoreDeleteCallback(int objectType, const union ble_store_key* key);
 
       static constexpr const char* deviceName = "InfiniTime";
       Pinetime::System::SystemTask& systemTask;
@@ -106,12 +131,24 @@ namespace Pinetime {
       HeartRateService heartRateService;
       MotionService motionService;
       FSService fsService;
+      ProfilerService profilerService;
+      ServiceChangedClient serviceChangedClient;
       ServiceDiscovery serviceDiscovery;
+      BondStore bondStore;
 
       uint8_t addrType;
       uint16_t connectionHandle = BLE_HS_CONN_HANDLE_NONE;
       uint8_t fastAdvCount = 0;
-      uint8_t bondId[16] = {0};
+      TickType_t connectedTick = 0;
+
+      // Discovery of the services of the phone during the current connection. It's started by SystemTask, and run
+      // again by the BLE task when the phone indicates that its services changed.
+      enum class DiscoveryStates : uint8_t { NotStarted, Running, Done };
+      std::atomic<DiscoveryStates> discoveryState {DiscoveryStates::NotStarted};
+      std::atomic<bool> rediscoveryNeeded {false};
+
+      ConnectionPolicy connectionPolicy;
+      TimerHandle_t connectionPolicyTimer;
 
       ble_uuid128_t dfuServiceUuid {
         .u {.type = BLE_UUID_TYPE_128},
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#define min // workaround: nimble's min/max macros conflict with libstdc++
+#define max
+#include <host/ble_gap.h>
+#undef max
+#undef min
+
+namespace Pinetime {
+  namespace Controllers {
+    /*
+     * Packs the fixed-size records notified on a characteristic into payloads as large as the ATT MTU allows.
+     *
+     * Records are accumulated until the next one wouldn't fit in a notification (ATT MTU - 3 bytes, and at most
+     * MaxPayloadSize), or until the oldest one has waited maxLatency. They are then sent in a single notification, so
+     * that a burst of samples costs one radio packet instead of one each. The latency is checked when a record is added:
+     * the owner calls FlushIfExpired() when it has no new record to add, and Clear() when the stream stops.
+     */
+    template <size_t RecordSize, size_t MaxPayloadSize>
+    class NotificationBatcher {
+    public:
+      // Smallest payload of a notification, with the default ATT MTU of 23 bytes
+      static constexpr size_t minPayloadSize = BLE_ATT_MTU_DFLT - 3;
+      static_assert(RecordSize > 0 && RecordSize <= minPayloadSize, "A record must fit in a notification");
+      static_assert(MaxPayloadSize >= minPayloadSize, "The buffer must hold the payload of a notification");
+
+      struct Statistics {
+        uint32_t records;
+        uint32_t notifications;
+        uint32_t dropped;
+      };
+
+      explicit NotificationBatcher(TickType_t maxLatency) : maxLatency {maxLatency} {
+      }
+
+      void Add(uint16_t connectionHandle, uint16_t attributeHandle, const void* record) {
+        size_t capacity = Capacity(ble_att_mtu(connectionHandle));
+        if (used + RecordSize > capacity) {
+          Flush(connectionHandle, attributeHandle);
+        }
+
+        TickType_t now = xTaskGetTickCount();
+        if (used == 0) {
+          oldest = now;
+        }
+        std::memcpy(buffer + used, record, RecordSize);
+        used += RecordSize;
+        statistics.records++;
+
+        if (used + RecordSize > capacity) {
+          Flush(connectionHandle, attributeHandle);
+        } else {
+          FlushIfExpired(connectionHandle, attributeHandle);
+        }
+      }
+
+      void FlushIfExpired(uint16_t connectionHandle, uint16_t attributeHandle) {
+        if (used > 0 && xTaskGetTickCount() - oldest >= maxLatency) {
+          Flush(connectionHandle, attributeHandle);
+        }
+      }
+
+      void Flush(uint16_t connectionHandle, uint16_t attributeHandle) {
+        if (used == 0) {
+          return;
+        }
+        auto* om = ble_hs_mbuf_from_flat(buffer, used);
+        if (om != nullptr && ble_gattc_notify_custom(connectionHandle, attributeHandle, om) == 0) {
+          statistics.notifications++;
+        } else {
+          statistics.dropped += used / RecordSize;
+        }
+        used = 0;
+      }
+
+      void Clear() {
+        used = 0;
+      }
+
+      // Number of bytes of records that fit in a notification for the given ATT MTU
+      static constexpr size_t Capacity(uint16_t mtu) {
+        size_t payloadSize = (mtu > 3) ? mtu - 3 : 0;
+        payloadSize = std::clamp(payloadSize, minPayloadSize, MaxPayloadSize);
+        return payloadSize - (payloadSize % RecordSize);
+      }
+
+      Statistics GetStatistics() const {
+        return statistics;
+      }
+
+    private:
+      const TickType_t maxLatency;
+      uint8_t buffer[MaxPayloadSize];
+      size_t used = 0;
+      TickType_t oldest = 0;
+      Statistics statistics {};
+    };
+  }
+}
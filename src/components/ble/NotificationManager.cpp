@@ -2,22 +2,215 @@
 #include <cstring>
 #include <algorithm>
 #include <cassert>
+#include "components/fs/FS.h"
 
 using namespace Pinetime::Controllers;
 
 constexpr uint8_t NotificationManager::MessageSize;
 
+namespace {
+  constexpr const char* logFileName = "/notifs.dat";
+  constexpr const char* compactedLogFileName = "/notifs.tmp";
+  constexpr uint8_t notificationRecord = 0xA1;
+  constexpr uint8_t dismissalRecord = 0xD1;
+
+  const NotificationManager::Notification emptyNotification {};
+}
+
+NotificationManager::NotificationManager(Controllers::FS& fs) : fs {fs} {
+}
+
+void NotificationManager::Init() {
+  mutex.Init();
+  Utility::Lock lock {mutex};
+
+  lfs_info info;
+  if (fs.Stat(logFileName, &info) != LFS_ERR_OK) {
+    return;
+  }
+  lfs_file_t logFile;
+  if (fs.FileOpen(&logFile, logFileName, LFS_O_RDONLY) != LFS_ERR_OK) {
+    return;
+  }
+
+  RecordHeader header;
+  uint32_t position = 0;
+  while (position + sizeof(header) <= info.size) {
+    if (fs.FileRead(&logFile, reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header)) {
+      break;
+    }
+    if (header.type == notificationRecord && header.size > 0 && header.size <= MessageSize + 1 &&
+        header.category <= static_cast<uint8_t>(Categories::InstantMessage) && position + sizeof(header) + header.size <= info.size) {
+      AddEntry({header.id, static_cast<Categories>(header.category), header.size, true, static_cast<uint32_t>(position + sizeof(header))});
+      position += sizeof(header) + header.size;
+      fs.FileSeek(&logFile, position);
+    } else if (header.type == dismissalRecord) {
+      Notification::Idx idx = IndexOf(header.id);
+      if (idx < size) {
+        DismissIdx(idx);
+      }
+      position += sizeof(header);
+    } else {
+      break;
+    }
+  }
+  fs.FileClose(&logFile);
+
+  // Drop the truncated or corrupted end of the log, if any, at the next save
+  if (position != info.size) {
+    compactionNeeded = true;
+  }
+  logSize = position;
+  if (!IsEmpty()) {
+    nextId = At(0).id + 1;
+  }
+}
+
+void NotificationManager::SaveNotifications() {
+  Utility::Lock lock {mutex};
+  uint32_t pendingSize = nbPendingDismissals * sizeof(RecordHeader);
+  for (Notification::Idx idx = 0; idx < size; idx++) {
+    if (!At(idx).stored) {
+      pendingSize += sizeof(RecordHeader) + At(idx).size;
+    }
+  }
+  if (pendingSize == 0 && !compactionNeeded) {
+    return;
+  }
+  if (compactionNeeded || logSize + pendingSize > maxLogSize) {
+    Compact();
+    return;
+  }
+
+  lfs_file_t logFile;
+  if (fs.FileOpen(&logFile, logFileName, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_APPEND) != LFS_ERR_OK) {
+    return;
+  }
+
+  bool success = true;
+  for (uint8_t i = 0; i < nbPendingDismissals && success; i++) {
+    RecordHeader header {dismissalRecord, pendingDismissals[i], 0, 0};
+    success = fs.FileWrite(&logFile, reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header);
+    logSize += sizeof(header);
+  }
+  nbPendingDismissals = 0;
+
+  // Oldest first, so that the log stays ordered by id
+  for (auto idx = static_cast<Notification::Idx>(size); idx > 0 && success; idx--) {
+    Entry& entry = At(idx - 1);
+    const Notification* notification = Find(entry.id);
+    if (entry.stored || notification == nullptr) {
+      continue;
+    }
+    RecordHeader header {notificationRecord, entry.id, static_cast<uint8_t>(entry.category), entry.size};
+    success = fs.FileWrite(&logFile, reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+              fs.FileWrite(&logFile, reinterpret_cast<const uint8_t*>(notification->message.data()), entry.size) == entry.size;
+    entry.offset = logSize + sizeof(header);
+    entry.stored = success;
+    logSize += sizeof(header) + entry.size;
+    statistics.appends++;
+  }
+  statistics.bytesWritten += pendingSize;
+  fs.FileClose(&logFile);
+
+  // The end of the log may be corrupted: rewrite it entirely
+  if (!success) {
+    compactionNeeded = true;
+  }
+}
+
+void NotificationManager::Compact() {
+  lfs_file_t compactedLogFile;
+  if (fs.FileOpen(&compactedLogFile, compactedLogFileName, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC) != LFS_ERR_OK) {
+    return;
+  }
+  lfs_file_t logFile;
+  bool logOpen = fs.FileOpen(&logFile, logFileName, LFS_O_RDONLY) == LFS_ERR_OK;
+
+  std::array<uint32_t, maxNbNotifications> offsets;
+  uint32_t compactedSize = 0;
+  bool success = true;
+  for (auto idx = static_cast<Notification::Idx>(size); idx > 0 && success; idx--) {
+    const Entry& entry = At(idx - 1);
+    RecordHeader header {notificationRecord, entry.id, static_cast<uint8_t>(entry.category), entry.size};
+    success = fs.FileWrite(&compactedLogFile, reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header);
+
+    const Notification* notification = Find(entry.id);
+    if (notification != nullptr) {
+      success = success &&
+                fs.FileWrite(&compactedLogFile, reinterpret_cast<const uint8_t*>(notification->message.data()), entry.size) == entry.size;
+    } else if (entry.stored && logOpen) {
+      // Copied in chunks to keep the stack small
+      uint8_t buffer[32];
+      success = success && fs.FileSeek(&logFile, entry.offset) >= 0;
+      for (size_t copied = 0; copied < entry.size && success; copied += sizeof(buffer)) {
+        auto chunkSize = static_cast<uint32_t>(std::min<size_t>(sizeof(buffer), entry.size - copied));
+        success = fs.FileRead(&logFile, buffer, chunkSize) == static_cast<int>(chunkSize) &&
+                  fs.FileWrite(&compactedLogFile, buffer, chunkSize) == static_cast<int>(chunkSize);
+      }
+    } else {
+      success = false;
+    }
+    offsets[idx - 1] = compactedSize + sizeof(header);
+    compactedSize += sizeof(header) + entry.size;
+  }
+
+  if (logOpen) {
+    fs.FileClose(&logFile);
+  }
+  fs.FileClose(&compactedLogFile);
+  if (!success || fs.Rename(compactedLogFileName, logFileName) != LFS_ERR_OK) {
+    fs.FileDelete(compactedLogFileName);
+    return;
+  }
+
+  for (Notification::Idx idx = 0; idx < size; idx++) {
+    At(idx).offset = offsets[idx];
+    At(idx).stored = true;
+  }
+  logSize = compactedSize;
+  nbPendingDismissals = 0;
+  compactionNeeded = false;
+  statistics.compactions++;
+  statistics.bytesWritten += compactedSize;
+}
+
 void NotificationManager::Push(NotificationManager::Notification&& notif) {
+  Utility::Lock lock {mutex};
   notif.id = GetNextId();
   notif.valid = true;
+  notif.size = std::clamp<uint8_t>(notif.size, 1, MessageSize + 1);
+  notif.message[notif.size - 1] = '\0';
+
+  // The notification in the slot is lost if it wasn't written to the log yet
+  Notification& slot = cache[nextCached];
+  if (slot.valid) {
+    Notification::Idx idx = IndexOf(slot.id);
+    if (idx < size && !At(idx).stored) {
+      DismissIdx(idx);
+      statistics.dropped++;
+    }
+  }
+  // Ids must stay unique: drop the oldest notification once 255 newer ones were received
+  if (!IsEmpty() && At(size - 1).id == notif.id) {
+    Dismiss(notif.id);
+  }
+  Forget(notif.id);
+
+  AddEntry({notif.id, notif.category, notif.size, false, 0});
+  slot = std::move(notif);
+  nextCached = (nextCached + 1) % cache.size();
   newNotification = true;
+}
+
+void NotificationManager::AddEntry(const Entry& entry) {
   if (beginIdx > 0) {
     --beginIdx;
   } else {
-    beginIdx = notifications.size() - 1;
+    beginIdx = entries.size() - 1;
   }
-  notifications[beginIdx] = std::move(notif);
-  if (size < notifications.size()) {
+  entries[beginIdx] = entry;
+  if (size < entries.size()) {
     size++;
   }
 }
@@ -26,69 +219,150 @@ NotificationManager::Notification::Id NotificationManager::GetNextId() {
   return nextId++;
 }
 
-NotificationManager::Notification NotificationManager::GetLastNotification() const {
+NotificationManager::View NotificationManager::GetLastNotification() const {
+  Utility::Lock lock {mutex};
   if (this->IsEmpty()) {
-    return {};
+    return {mutex, emptyNotification};
   }
-  return this->At(0);
+  return {mutex, Load(0)};
 }
 
-const NotificationManager::Notification& NotificationManager::At(NotificationManager::Notification::Idx idx) const {
-  if (idx >= notifications.size()) {
+const NotificationManager::Entry& NotificationManager::At(NotificationManager::Notification::Idx idx) const {
+  if (idx >= entries.size()) {
     assert(false);
-    return notifications.at(beginIdx); // this should not happen
+    return entries.at(beginIdx); // this should not happen
   }
-  size_t read_idx = (beginIdx + idx) % notifications.size();
-  return notifications.at(read_idx);
+  size_t read_idx = (beginIdx + idx) % entries.size();
+  return entries.at(read_idx);
 }
 
-NotificationManager::Notification& NotificationManager::At(NotificationManager::Notification::Idx idx) {
-  if (idx >= notifications.size()) {
+NotificationManager::Entry& NotificationManager::At(NotificationManager::Notification::Idx idx) {
+  if (idx >= entries.size()) {
     assert(false);
-    return notifications.at(beginIdx); // this should not happen
+    return entries.at(beginIdx); // this should not happen
   }
-  size_t read_idx = (beginIdx + idx) % notifications.size();
-  return notifications.at(read_idx);
+  size_t read_idx = (beginIdx + idx) % entries.size();
+  return entries.at(read_idx);
 }
 
-NotificationManager::Notification::Idx NotificationManager::IndexOf(NotificationManager::Notification::Id id) const {
-  for (NotificationManager::Notification::Idx idx = 0; idx < this->size; idx++) {
-    const NotificationManager::Notification& notification = this->At(idx);
+const NotificationManager::Notification* NotificationManager::Find(NotificationManager::Notification::Id id) const {
+  for (const auto& notification : cache) {
+    if (notification.valid && notification.id == id) {
+      return &notification;
+    }
+  }
+  for (const auto& notification : loaded) {
+    if (notification.valid && notification.id == id) {
+      return &notification;
+    }
+  }
+  return nullptr;
+}
+
+void NotificationManager::Forget(NotificationManager::Notification::Id id) {
+  for (auto& notification : cache) {
+    if (notification.id == id) {
+      notification.valid = false;
+    }
+  }
+  for (auto& notification : loaded) {
     if (notification.id == id) {
-      return idx;
+      notification.valid = false;
+    }
+  }
+}
+
+const NotificationManager::Notification& NotificationManager::Load(NotificationManager::Notification::Idx idx) const {
+  const Entry& entry = At(idx);
+  const Notification* notification = Find(entry.id);
+  if (notification != nullptr) {
+    return *notification;
+  }
+  if (!entry.stored) {
+    return emptyNotification;
+  }
+
+  Notification& slot = loaded[nextLoaded];
+  nextLoaded = (nextLoaded + 1) % loaded.size();
+  slot.valid = false;
+  lfs_file_t logFile;
+  if (fs.FileOpen(&logFile, logFileName, LFS_O_RDONLY) != LFS_ERR_OK) {
+    return emptyNotification;
+  }
+  bool success = fs.FileSeek(&logFile, entry.offset) >= 0 &&
+                 fs.FileRead(&logFile, reinterpret_cast<uint8_t*>(slot.message.data()), entry.size) == entry.size;
+  fs.FileClose(&logFile);
+  statistics.loads++;
+  if (!success) {
+    return emptyNotification;
+  }
+
+  slot.message[entry.size - 1] = '\0';
+  slot.size = entry.size;
+  slot.category = entry.category;
+  slot.id = entry.id;
+  slot.valid = true;
+  return slot;
+}
+
+NotificationManager::Notification::Idx NotificationManager::IndexOf(NotificationManager::Notification::Id id) const {
+  Utility::Lock lock {mutex};
+  if (this->IsEmpty()) {
+    return 0;
+  }
+
+  // Entries are sorted by distance to the newest id
+  const Notification::Id newestId = At(0).id;
+  const auto distance = static_cast<uint8_t>(newestId - id);
+  Notification::Idx first = 0;
+  auto count = static_cast<Notification::Idx>(size);
+  while (count > 0) {
+    Notification::Idx step = count / 2;
+    Notification::Idx middle = first + step;
+    if (static_cast<uint8_t>(newestId - At(middle).id) < distance) {
+      first = middle + 1;
+      count -= step + 1;
+    } else {
+      count = step;
     }
   }
+  if (first < size && At(first).id == id) {
+    return first;
+  }
   return size;
 }
 
-NotificationManager::Notification NotificationManager::Get(NotificationManager::Notification::Id id) const {
+NotificationManager::View NotificationManager::Get(NotificationManager::Notification::Id id) const {
+  Utility::Lock lock {mutex};
   NotificationManager::Notification::Idx idx = this->IndexOf(id);
   if (idx == this->size) {
-    return {};
+    return {mutex, emptyNotification};
   }
-  return this->At(idx);
+  return {mutex, Load(idx)};
 }
 
-NotificationManager::Notification NotificationManager::GetNext(NotificationManager::Notification::Id id) const {
+NotificationManager::View NotificationManager::GetNext(NotificationManager::Notification::Id id) const {
+  Utility::Lock lock {mutex};
   NotificationManager::Notification::Idx idx = this->IndexOf(id);
   if (idx == this->size) {
-    return {};
+    return {mutex, emptyNotification};
   }
-  if (idx == 0 || idx > notifications.size()) {
-    return {};
+  if (idx == 0) {
+    return {mutex, emptyNotification};
   }
-  return this->At(idx - 1);
+  return {mutex, Load(idx - 1)};
 }
 
-NotificationManager::Notification NotificationManager::GetPrevious(NotificationManager::Notification::Id id) const {
+NotificationManager::View NotificationManager::GetPrevious(NotificationManager::Notification::Id id) const {
+  Utility::Lock lock {mutex};
   NotificationManager::Notification::Idx idx = this->IndexOf(id);
   if (idx == this->size) {
-    return {};
+    return {mutex, emptyNotification};
   }
-  if (static_cast<size_t>(idx + 1) >= notifications.size()) {
-    return {};
+  if (static_cast<size_t>(idx + 1) >= this->size) {
+    return {mutex, emptyNotification};
   }
-  return this->At(idx + 1);
+  return {mutex, Load(idx + 1)};
 }
 
 void NotificationManager::DismissIdx(NotificationManager::Notification::Idx idx) {
@@ -100,23 +374,31 @@ void NotificationManager::DismissIdx(NotificationManager::Notification::Idx idx)
     return; // this should not happen
   }
   if (idx == 0) { // just remove the first element, don't need to change the other elements
-    notifications.at(beginIdx).valid = false;
-    beginIdx = (beginIdx + 1) % notifications.size();
+    beginIdx = (beginIdx + 1) % entries.size();
   } else {
-    // overwrite the specified entry by moving all later messages one index to the front
+    // overwrite the specified entry by moving all later entries one index to the front
     for (size_t i = idx; i < size - 1; ++i) {
       this->At(i) = this->At(i + 1);
     }
-    this->At(size - 1).valid = false;
   }
   --size;
 }
 
 void NotificationManager::Dismiss(NotificationManager::Notification::Id id) {
+  Utility::Lock lock {mutex};
   NotificationManager::Notification::Idx idx = this->IndexOf(id);
   if (idx == this->size) {
     return;
   }
+  if (At(idx).stored) {
+    // The index is rewritten entirely by the compaction if there's no room left for the tombstone
+    if (nbPendingDismissals < pendingDismissals.size()) {
+      pendingDismissals[nbPendingDismissals++] = id;
+    } else {
+      compactionNeeded = true;
+    }
+  }
+  Forget(id);
   this->DismissIdx(idx);
 }
 
@@ -129,9 +411,15 @@ bool NotificationManager::ClearNewNotificationFlag() {
 }
 
 size_t NotificationManager::NbNotifications() const {
+  Utility::Lock lock {mutex};
   return size;
 }
 
+NotificationManager::Statistics NotificationManager::GetStatistics() const {
+  Utility::Lock lock {mutex};
+  return statistics;
+}
+
 const char* NotificationManager::Notification::Message() const {
   const char* itField = std::find(message.begin(), message.begin() + size - 1, '\0');
   if (itField != message.begin() + size - 1) {
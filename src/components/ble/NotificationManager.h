@@ -4,9 +4,28 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include "utility/Mutex.h"
 
 namespace Pinetime {
   namespace Controllers {
+    class FS;
+
+    /*
+     * Keeps the last maxNbNotifications notifications, persisted in a log file in the filesystem.
+     *
+     * The log is append-only: each notification is written as a small header followed by its message (only the bytes
+     * used), and dismissals append a tombstone. When the log exceeds maxLogSize, it's compacted by rewriting the live
+     * notifications to a new file that replaces the old one.
+     *
+     * The index of the live notifications (id, category, size and offset in the log) is kept in RAM, newest first. Ids
+     * increase with each notification (modulo 256), so they are looked up with a binary search. The newest
+     * notifications are cached in RAM: they are written to the log by SaveNotifications(), which is called while the
+     * filesystem is available. Older ones are read from the log when they're browsed.
+     *
+     * Notifications are pushed by the BLE task, written to the log by SystemTask and browsed by DisplayApp: every public
+     * method holds a mutex, so that the index doesn't change and the log isn't compacted while another task reads them.
+     * Accessors return views that keep holding it while the notification is read, instead of copying it.
+     */
     class NotificationManager {
     public:
       enum class Categories {
@@ -38,11 +57,49 @@ namespace Pinetime {
         const char* Title() const;
       };
 
+      /*
+       * Borrowed notification: the mutex is held until the view is destroyed, so that the notification isn't replaced
+       * by another task while it's read. Views must stay in a small scope, which doesn't wait for other tasks (pushing
+       * a message, for instance). The task holding a view may get another one, but at most two views of notifications
+       * read from the log are valid at the same time.
+       */
+      class View {
+      public:
+        View(Utility::Mutex& mutex, const Notification& notification) : lock {mutex}, notification {notification} {
+        }
+
+        const Notification& operator*() const {
+          return notification;
+        }
+
+        const Notification* operator->() const {
+          return &notification;
+        }
+
+      private:
+        Utility::Lock lock;
+        const Notification& notification;
+      };
+
+      struct Statistics {
+        uint32_t appends;
+        uint32_t compactions;
+        uint32_t bytesWritten;
+        uint32_t loads;
+        // Notifications dropped before they could be written to the log
+        uint32_t dropped;
+      };
+
+      explicit NotificationManager(Controllers::FS& fs);
+
+      void Init();
+      void SaveNotifications();
+
       void Push(Notification&& notif);
-      Notification GetLastNotification() const;
-      Notification Get(Notification::Id id) const;
-      Notification GetNext(Notification::Id id) const;
-      Notification GetPrevious(Notification::Id id) const;
+      View GetLastNotification() const;
+      View Get(Notification::Id id) const;
+      View GetNext(Notification::Id id) const;
+      View GetPrevious(Notification::Id id) const;
       // Return the index of the notification with the specified id, if not found return NbNotifications()
       Notification::Idx IndexOf(Notification::Id id) const;
       bool ClearNewNotificationFlag();
@@ -59,17 +116,61 @@ namespace Pinetime {
 
       size_t NbNotifications() const;
 
+      Statistics GetStatistics() const;
+
     private:
+      static constexpr uint8_t maxNbNotifications = 32;
+      static constexpr uint8_t nbCachedNotifications = 5;
+      static constexpr uint8_t nbLoadedNotifications = 2;
+      static constexpr uint32_t maxLogSize = 8192;
+
+      struct Entry {
+        Notification::Id id;
+        Categories category;
+        uint8_t size;
+        bool stored;
+        // Offset of the message in the log
+        uint32_t offset;
+      };
+
+      struct RecordHeader {
+        uint8_t type;
+        Notification::Id id;
+        uint8_t category;
+        uint8_t size;
+      };
+
+      Controllers::FS& fs;
+      mutable Utility::Mutex mutex;
+
       Notification::Id nextId {0};
       Notification::Id GetNextId();
-      const Notification& At(Notification::Idx idx) const;
-      Notification& At(Notification::Idx idx);
+      const Entry& At(Notification::Idx idx) const;
+      Entry& At(Notification::Idx idx);
       void DismissIdx(Notification::Idx idx);
+      void AddEntry(const Entry& entry);
+      const Notification& Load(Notification::Idx idx) const;
+      const Notification* Find(Notification::Id id) const;
+      void Forget(Notification::Id id);
+      void Compact();
+
+      std::array<Entry, maxNbNotifications> entries;
+      size_t beginIdx = maxNbNotifications - 1; // index of the newest notification
+      size_t size = 0;                          // number of valid notifications in the index
+
+      // Notifications pushed since boot, until they're written to the log and replaced by newer ones
+      std::array<Notification, nbCachedNotifications> cache;
+      uint8_t nextCached = 0;
+      // Notifications read from the log
+      mutable std::array<Notification, nbLoadedNotifications> loaded;
+      mutable uint8_t nextLoaded = 0;
+
+      uint32_t logSize = 0;
+      std::array<Notification::Id, maxNbNotifications> pendingDismissals;
+      uint8_t nbPendingDismissals = 0;
+      bool compactionNeeded = false;
 
-      static constexpr uint8_t TotalNbNotifications = 5;
-      std::array<Notification, TotalNbNotifications> notifications;
-      size_t beginIdx = TotalNbNotifications - 1; // index of the newest notification
-      size_t size = 0;                            // number of valid notifications in buffer
+      mutable Statistics statistics {};
 
       std::atomic<bool> newNotification {false};
     };
@@ -0,0 +1,171 @@
+#include "components/ble/ProfilerService.h"
+#include "systemtask/SystemTask.h"
+#include "heap_4_infinitime.h"
+#include <algorithm>
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  // 0007yyxx-78fc-48fe-8e23-433b3a1942d0
+  constexpr ble_uuid128_t CharUuid(uint8_t x, uint8_t y) {
+    return ble_uuid128_t {.u = {.type = BLE_UUID_TYPE_128},
+                          .value = {0xd0, 0x42, 0x19, 0x3a, 0x3b, 0x43, 0x23, 0x8e, 0xfe, 0x48, 0xfc, 0x78, x, y, 0x07, 0x00}};
+  }
+
+  // 00070000-78fc-48fe-8e23-433b3a1942d0
+  constexpr ble_uuid128_t BaseUuid() {
+    return CharUuid(0x00, 0x00);
+  }
+
+  constexpr ble_uuid128_t profilerServiceUuid {BaseUuid()};
+  constexpr ble_uuid128_t profileCharUuid {CharUuid(0x01, 0x00)};
+  constexpr ble_uuid128_t heapCharUuid {CharUuid(0x02, 0x00)};
+
+  constexpr uint8_t systemQueue = 0;
+  constexpr uint8_t displayQueue = 1;
+
+  // The profile must fit in the largest attribute value: the message entries that don't fit are left out
+  constexpr size_t profileHeaderSize = 16;
+  constexpr size_t taskEntrySize = configMAX_TASK_NAME_LEN + 12;
+  constexpr size_t messageEntrySize = 10;
+  constexpr size_t maxTasksSize = profileHeaderSize + Pinetime::System::SystemMonitor::maxTasks * taskEntrySize;
+  static_assert(maxTasksSize <= BLE_ATT_ATTR_MAX_LEN, "The tasks must fit in the profile");
+  constexpr uint8_t maxMessageEntries = (BLE_ATT_ATTR_MAX_LEN - maxTasksSize) / messageEntrySize;
+
+  int ProfilerServiceCallback(uint16_t /*conn_handle*/, uint16_t attr_handle, struct ble_gatt_access_ctxt* ctxt, void* arg) {
+    auto* profilerService = static_cast<ProfilerService*>(arg);
+    return profilerService->OnProfileRequested(attr_handle, ctxt);
+  }
+
+  template <class T>
+  int Append(os_mbuf* om, T value) {
+    return os_mbuf_append(om, &value, sizeof(value));
+  }
+
+  template <class Profiler>
+  uint8_t CountMessages(const Profiler& profiler) {
+    uint8_t count = 0;
+    for (size_t i = 0; i < profiler.Size(); i++) {
+      if (profiler.Get(i).count > 0) {
+        count++;
+      }
+    }
+    return count;
+  }
+
+  // Appends at most maxEntries entries, and decrements it by the number of entries appended
+  template <class Profiler>
+  int AppendMessages(os_mbuf* om, uint8_t queue, const Profiler& profiler, uint8_t& maxEntries) {
+    int res = 0;
+    for (size_t i = 0; i < profiler.Size() && res == 0 && maxEntries > 0; i++) {
+      const auto& entry = profiler.Get(i);
+      if (entry.count == 0) {
+        continue;
+      }
+      maxEntries--;
+      res = Append(om, queue);
+      res = res == 0 ? Append(om, static_cast<uint8_t>(i)) : res;
+      res = res == 0 ? Append(om, entry.count) : res;
+      res = res == 0 ? Append(om, entry.maxMicroseconds) : res;
+      res = res == 0 ? Append(om, entry.totalMicroseconds) : res;
+    }
+    return res;
+  }
+}
+
+ProfilerService::ProfilerService(Pinetime::System::SystemTask& systemTask)
+  : systemTask {systemTask},
+    characteristicDefinition {{.uuid = &profileCharUuid.u,
+                               .access_cb = ProfilerServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ,
+                               .val_handle = &profileHandle},
+                              {.uuid = &heapCharUuid.u,
+                               .access_cb = ProfilerServiceCallback,
+                               .arg = this,
+                               .flags = BLE_GATT_CHR_F_READ,
+                               .val_handle = &heapHandle},
+                              {0}},
+    serviceDefinition {
+      {.type = BLE_GATT_SVC_TYPE_PRIMARY, .uuid = &profilerServiceUuid.u, .characteristics = characteristicDefinition},
+      {0},
+    } {
+}
+
+void ProfilerService::Init() {
+  int res = 0;
+  res = ble_gatts_count_cfg(serviceDefinition);
+  ASSERT(res == 0);
+
+  res = ble_gatts_add_svcs(serviceDefinition);
+  ASSERT(res == 0);
+}
+
+// See doc/ProfilerService.md for the formats
+int ProfilerService::OnProfileRequested(uint16_t attributeHandle, ble_gatt_access_ctxt* context) {
+  int res = 0;
+  if (attributeHandle == profileHandle) {
+    res = AppendProfile(context->om);
+  } else if (attributeHandle == heapHandle) {
+    res = AppendHeap(context->om);
+  }
+  return (res == 0) ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+}
+
+int ProfilerService::AppendProfile(os_mbuf* om) const {
+  const auto& monitor = systemTask.Monitor();
+  const auto& profile = monitor.LastProfile();
+  uint8_t nbMessages = CountMessages(monitor.SystemMessages()) + CountMessages(monitor.DisplayMessages());
+  nbMessages = std::min(nbMessages, maxMessageEntries);
+
+  int res = Append(om, profileVersion);
+  res = res == 0 ? Append(om, profile.nbTasks) : res;
+  res = res == 0 ? Append(om, nbMessages) : res;
+  res = res == 0 ? Append(om, static_cast<uint8_t>(0)) : res;
+  res = res == 0 ? Append(om, static_cast<uint32_t>(profile.duration)) : res;
+  res = res == 0 ? Append(om, static_cast<uint32_t>(profile.sleepTicks)) : res;
+  res = res == 0 ? Append(om, profile.freeHeap) : res;
+  for (uint8_t i = 0; i < profile.nbTasks && res == 0; i++) {
+    const auto& task = profile.tasks[i];
+    res = os_mbuf_append(om, task.name, sizeof(task.name));
+    res = res == 0 ? Append(om, task.cycles) : res;
+    res = res == 0 ? Append(om, task.wakeups) : res;
+    res = res == 0 ? Append(om, task.stackHighWaterMark) : res;
+    res = res == 0 ? Append(om, task.number) : res;
+    res = res == 0 ? Append(om, static_cast<uint8_t>(0)) : res;
+  }
+  uint8_t remainingMessages = nbMessages;
+  res = res == 0 ? AppendMessages(om, systemQueue, monitor.SystemMessages(), remainingMessages) : res;
+  res = res == 0 ? AppendMessages(om, displayQueue, monitor.DisplayMessages(), remainingMessages) : res;
+  return res;
+}
+
+int ProfilerService::AppendHeap(os_mbuf* om) const {
+  const auto& monitor = systemTask.Monitor();
+  HeapStatistics_t heap;
+  vPortGetHeapStatistics(&heap);
+
+  int res = Append(om, heapVersion);
+  res = res == 0 ? Append(om, static_cast<uint8_t>(heapHISTOGRAM_BUCKETS)) : res;
+  res = res == 0 ? Append(om, monitor.NbAppHeapPeaks()) : res;
+  res = res == 0 ? Append(om, static_cast<uint8_t>(0)) : res;
+  res = res == 0 ? Append(om, static_cast<uint32_t>(configTOTAL_HEAP_SIZE)) : res;
+  res = res == 0 ? Append(om, static_cast<uint32_t>(heap.xAvailableHeapSpaceInBytes)) : res;
+  res = res == 0 ? Append(om, static_cast<uint32_t>(heap.xMinimumEverFreeBytesRemaining)) : res;
+  res = res == 0 ? Append(om, static_cast<uint32_t>(heap.xSizeOfLargestFreeBlockInBytes)) : res;
+  res = res == 0 ? Append(om, static_cast<uint32_t>(heap.xSizeOfSmallestFreeBlockInBytes)) : res;
+  res = res == 0 ? Append(om, static_cast<uint32_t>(heap.xNumberOfFreeBlocks)) : res;
+  res = res == 0 ? Append(om, static_cast<uint32_t>(heap.xNumberOfSuccessfulAllocations)) : res;
+  res = res == 0 ? Append(om, static_cast<uint32_t>(heap.xNumberOfSuccessfulFrees)) : res;
+  res = res == 0 ? Append(om, static_cast<uint32_t>(heap.xNumberOfFailedAllocations)) : res;
+  for (size_t i = 0; i < heapHISTOGRAM_BUCKETS && res == 0; i++) {
+    res = Append(om, static_cast<uint32_t>(heap.xAllocationSizeHistogram[i]));
+  }
+  for (uint8_t i = 0; i < monitor.NbAppHeapPeaks() && res == 0; i++) {
+    const auto& peak = monitor.GetAppHeapPeak(i);
+    res = Append(om, static_cast<uint8_t>(peak.app));
+    res = res == 0 ? Append(om, static_cast<uint8_t>(0)) : res;
+    res = res == 0 ? Append(om, peak.bytes) : res;
+  }
+  return res;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#define min // workaround: nimble's min/max macros conflict with libstdc++
+#define max
+#include <host/ble_gap.h>
+#undef max
+#undef min
+
+namespace Pinetime {
+  namespace System {
+    class SystemTask;
+  }
+
+  namespace Controllers {
+    class ProfilerService {
+    public:
+      static constexpr uint8_t profileVersion = 1;
+      static constexpr uint8_t heapVersion = 1;
+
+      explicit ProfilerService(Pinetime::System::SystemTask& systemTask);
+      void Init();
+      int OnProfileRequested(uint16_t attributeHandle, ble_gatt_access_ctxt* context);
+
+    private:
+      Pinetime::System::SystemTask& systemTask;
+
+      struct ble_gatt_chr_def characteristicDefinition[3];
+      struct ble_gatt_svc_def serviceDefinition[2];
+
+      uint16_t profileHandle;
+      uint16_t heapHandle;
+
+      int AppendProfile(os_mbuf* om) const;
+      int AppendHeap(os_mbuf* om) const;
+    };
+  }
+}
@@ -0,0 +1,181 @@
+#include "components/ble/ServiceChangedClient.h"
+#include <nrf_log.h>
+
+using namespace Pinetime::Controllers;
+
+constexpr ble_uuid16_t ServiceChangedClient::gattServiceUuid;
+constexpr ble_uuid16_t ServiceChangedClient::serviceChangedUuid;
+constexpr ble_uuid16_t ServiceChangedClient::characteristicDeclarationUuid;
+constexpr ble_uuid16_t ServiceChangedClient::clientConfigurationUuid;
+
+namespace {
+  int OnDiscoveryEventCallback(uint16_t conn_handle, const struct ble_gatt_error* error, const struct ble_gatt_svc* service, void* arg) {
+    auto client = static_cast<ServiceChangedClient*>(arg);
+    return client->OnDiscoveryEvent(conn_handle, error, service);
+  }
+
+  int OnCharacteristicDiscoveryEventCallback(uint16_t conn_handle,
+                                             const struct ble_gatt_error* error,
+                                             const struct ble_gatt_chr* chr,
+                                             void* arg) {
+    auto client = static_cast<ServiceChangedClient*>(arg);
+    return client->OnCharacteristicDiscoveryEvent(conn_handle, error, chr);
+  }
+
+  int OnDescriptorDiscoveryEventCallback(uint16_t conn_handle,
+                                         const struct ble_gatt_error* error,
+                                         uint16_t chr_val_handle,
+                                         const struct ble_gatt_dsc* dsc,
+                                         void* arg) {
+    auto client = static_cast<ServiceChangedClient*>(arg);
+    return client->OnDescriptorDiscoveryEvent(conn_handle, error, chr_val_handle, dsc);
+  }
+
+  int OnSubscribeCallback(uint16_t conn_handle, const struct ble_gatt_error* error, struct ble_gatt_attr* /*attr*/, void* arg) {
+    auto client = static_cast<ServiceChangedClient*>(arg);
+    return client->OnSubscribe(conn_handle, error);
+  }
+}
+
+int ServiceChangedClient::OnDiscoveryEvent(uint16_t connectionHandle, const ble_gatt_error* error, const ble_gatt_svc* service) {
+  if (service == nullptr) {
+    if (isDiscovered && error->status == BLE_HS_EDONE) {
+      NRF_LOG_INFO("[GATT] Service found, starting characteristics discovery");
+      ble_gattc_disc_chrs_by_uuid(connectionHandle,
+                                  startHandle,
+                                  endHandle,
+                                  &serviceChangedUuid.u,
+                                  OnCharacteristicDiscoveryEventCallback,
+                                  this);
+    } else {
+      NRF_LOG_INFO("[GATT] Service not found");
+      onServiceDiscovered(connectionHandle);
+    }
+    return 0;
+  }
+
+  if (ble_uuid_cmp(&gattServiceUuid.u, &service->uuid.u) == 0) {
+    NRF_LOG_INFO("[GATT] Service discovered : 0x%x - 0x%x", service->start_handle, service->end_handle);
+    isDiscovered = true;
+    startHandle = service->start_handle;
+    endHandle = service->end_handle;
+  }
+  return 0;
+}
+
+int ServiceChangedClient::OnCharacteristicDiscoveryEvent(uint16_t connectionHandle,
+                                                         const ble_gatt_error* error,
+                                                         const ble_gatt_chr* characteristic) {
+  if (characteristic == nullptr) {
+    if (serviceChangedHandle != 0 && error->status == BLE_HS_EDONE) {
+      ble_gattc_disc_all_dscs(connectionHandle, serviceChangedHandle, endHandle, OnDescriptorDiscoveryEventCallback, this);
+    } else {
+      NRF_LOG_INFO("[GATT] Service Changed not found");
+      onServiceDiscovered(connectionHandle);
+    }
+    return 0;
+  }
+
+  if (ble_uuid_cmp(&serviceChangedUuid.u, &characteristic->uuid.u) == 0 && (characteristic->properties & BLE_GATT_CHR_PROP_INDICATE) != 0) {
+    NRF_LOG_INFO("[GATT] Service Changed discovered : 0x%x", characteristic->val_handle);
+    serviceChangedHandle = characteristic->val_handle;
+  }
+  return 0;
+}
+
+int ServiceChangedClient::OnDescriptorDiscoveryEvent(uint16_t connectionHandle,
+                                                     const ble_gatt_error* error,
+                                                     uint16_t characteristicValueHandle,
+                                                     const ble_gatt_dsc* descriptor) {
+  if (error->status != 0) {
+    if (descriptorHandle != 0 && error->status == BLE_HS_EDONE) {
+      Subscribe(connectionHandle);
+    } else {
+      NRF_LOG_INFO("[GATT] Service Changed descriptor not found");
+      onServiceDiscovered(connectionHandle);
+    }
+    return 0;
+  }
+
+  // The descriptors of a characteristic stop at the declaration of the next one
+  if (ble_uuid_cmp(&characteristicDeclarationUuid.u, &descriptor->uuid.u) == 0) {
+    isDescriptorSearchDone = true;
+  } else if (!isDescriptorSearchDone && descriptorHandle == 0 && characteristicValueHandle == serviceChangedHandle &&
+             ble_uuid_cmp(&clientConfigurationUuid.u, &descriptor->uuid.u) == 0) {
+    NRF_LOG_INFO("[GATT] Service Changed descriptor discovered : 0x%x", descriptor->handle);
+    descriptorHandle = descriptor->handle;
+  }
+  return 0;
+}
+
+int ServiceChangedClient::OnSubscribe(uint16_t connectionHandle, const ble_gatt_error* error) {
+  if (error->status == 0) {
+    NRF_LOG_INFO("[GATT] Service Changed subscribe OK");
+    isSubscribed = true;
+  } else {
+    NRF_LOG_INFO("[GATT] Service Changed subscribe ERROR");
+    if (isUsingCachedHandles) {
+      DiscoverService(connectionHandle);
+      return 0;
+    }
+  }
+  onServiceDiscovered(connectionHandle);
+  return 0;
+}
+
+bool ServiceChangedClient::IsServiceChangedIndication(const ble_gap_event* event) const {
+  uint16_t handle = (serviceChangedHandle != 0) ? serviceChangedHandle : cachedServiceChangedHandle;
+  return event->notify_rx.indication && handle != 0 && event->notify_rx.attr_handle == handle;
+}
+
+void ServiceChangedClient::Reset() {
+  isDiscovered = false;
+  startHandle = 0;
+  endHandle = 0;
+  serviceChangedHandle = 0;
+  descriptorHandle = 0;
+  isDescriptorSearchDone = false;
+  isSubscribed = false;
+  cachedServiceChangedHandle = 0;
+  cachedDescriptorHandle = 0;
+  isUsingCachedHandles = false;
+}
+
+void ServiceChangedClient::Discover(uint16_t connectionHandle, std::function<void(uint16_t)> onServiceDiscovered) {
+  this->onServiceDiscovered = onServiceDiscovered;
+  if (cachedServiceChangedHandle != 0 && cachedDescriptorHandle != 0) {
+    NRF_LOG_INFO("[GATT] Subscribing with cached handles 0x%x 0x%x", cachedServiceChangedHandle, cachedDescriptorHandle);
+    serviceChangedHandle = cachedServiceChangedHandle;
+    descriptorHandle = cachedDescriptorHandle;
+    isUsingCachedHandles = true;
+    if (Subscribe(connectionHandle) == 0) {
+      return;
+    }
+  }
+  DiscoverService(connectionHandle);
+}
+
+void ServiceChangedClient::DiscoverService(uint16_t connectionHandle) {
+  NRF_LOG_INFO("[GATT] Starting discovery");
+  Reset();
+  ble_gattc_disc_svc_by_uuid(connectionHandle, &gattServiceUuid.u, OnDiscoveryEventCallback, this);
+}
+
+int ServiceChangedClient::Subscribe(uint16_t connectionHandle) {
+  // Indications
+  uint8_t value[2] = {2, 0};
+  return ble_gattc_write_flat(connectionHandle, descriptorHandle, value, sizeof(value), OnSubscribeCallback, this);
+}
+
+void ServiceChangedClient::UseCachedHandles(uint16_t serviceChangedHandle, uint16_t descriptorHandle) {
+  cachedServiceChangedHandle = serviceChangedHandle;
+  cachedDescriptorHandle = descriptorHandle;
+}
+
+uint16_t ServiceChangedClient::ServiceChangedHandle() const {
+  return isSubscribed ? serviceChangedHandle : 0;
+}
+
+uint16_t ServiceChangedClient::ServiceChangedDescriptorHandle() const {
+  return isSubscribed ? descriptorHandle : 0;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#define min // workaround: nimble's min/max macros conflict with libstdc++
+#define max
+#include <host/ble_gap.h>
+#undef max
+#undef min
+#include "components/ble/BleClient.h"
+
+namespace Pinetime {
+  namespace Controllers {
+    /*
+     * Subscribes to the indications of the Service Changed characteristic of the phone, sent when the handles of its
+     * services changed (app reinstalled, Bluetooth stack updated...): the handles cached for the bonded phone are then
+     * discovered again.
+     */
+    class ServiceChangedClient : public BleClient {
+    public:
+      int OnDiscoveryEvent(uint16_t connectionHandle, const ble_gatt_error* error, const ble_gatt_svc* service);
+      int OnCharacteristicDiscoveryEvent(uint16_t connectionHandle, const ble_gatt_error* error, const ble_gatt_chr* characteristic);
+      int OnDescriptorDiscoveryEvent(uint16_t connectionHandle,
+                                     const ble_gatt_error* error,
+                                     uint16_t characteristicValueHandle,
+                                     const ble_gatt_dsc* descriptor);
+      int OnSubscribe(uint16_t connectionHandle, const ble_gatt_error* error);
+      bool IsServiceChangedIndication(const ble_gap_event* event) const;
+      void Reset();
+      void Discover(uint16_t connectionHandle, std::function<void(uint16_t)> lambda) override;
+
+      // The handle of Service Changed doesn't change for bonded peers: the next Discover() subscribes with the handles
+      // found during a previous connection, and discovers them if the subscription fails. The indications are
+      // recognized as soon as the handles are set.
+      void UseCachedHandles(uint16_t serviceChangedHandle, uint16_t descriptorHandle);
+      // 0 until the subscription succeeded
+      uint16_t ServiceChangedHandle() const;
+      uint16_t ServiceChangedDescriptorHandle() const;
+
+    private:
+      static constexpr uint16_t gattServiceId {0x1801};
+      static constexpr uint16_t serviceChangedId {0x2a05};
+      static constexpr uint16_t characteristicDeclarationId {0x2803};
+      static constexpr uint16_t clientConfigurationId {0x2902};
+
+      static constexpr ble_uuid16_t gattServiceUuid {.u {.type = BLE_UUID_TYPE_16}, .value = gattServiceId};
+      static constexpr ble_uuid16_t serviceChangedUuid {.u {.type = BLE_UUID_TYPE_16}, .value = serviceChangedId};
+      static constexpr ble_uuid16_t characteristicDeclarationUuid {.u {.type = BLE_UUID_TYPE_16}, .value = characteristicDeclarationId};
+      static constexpr ble_uuid16_t clientConfigurationUuid {.u {.type = BLE_UUID_TYPE_16}, .value = clientConfigurationId};
+
+      std::function<void(uint16_t)> onServiceDiscovered;
+      bool isDiscovered = false;
+      uint16_t startHandle = 0;
+      uint16_t endHandle = 0;
+      uint16_t serviceChangedHandle = 0;
+      uint16_t descriptorHandle = 0;
+      // Set once the descriptors of the next characteristic are reached
+      bool isDescriptorSearchDone = false;
+      bool isSubscribed = false;
+      uint16_t cachedServiceChangedHandle = 0;
+      uint16_t cachedDescriptorHandle = 0;
+      bool isUsingCachedHandles = false;
+
+      void DiscoverService(uint16_t connectionHandle);
+      int Subscribe(uint16_t connectionHandle);
+    };
+  }
+}
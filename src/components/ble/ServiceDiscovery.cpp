@@ -4,11 +4,12 @@
 
 using namespace Pinetime::Controllers;
 
-ServiceDiscovery::ServiceDiscovery(std::array<BleClient*, 2>&& clients) : clients {clients} {
+ServiceDiscovery::ServiceDiscovery(std::array<BleClient*, 3>&& clients) : clients {clients} {
 }
 
-void ServiceDiscovery::StartDiscovery(uint16_t connectionHandle) {
+void ServiceDiscovery::StartDiscovery(uint16_t connectionHandle, std::function<void(uint16_t)> onDiscoveryDone) {
   NRF_LOG_INFO("[Discovery] Starting discovery");
+  this->onDiscoveryDone = onDiscoveryDone;
   clientIterator = clients.begin();
   DiscoverNextService(connectionHandle);
 }
@@ -19,6 +20,7 @@ void ServiceDiscovery::OnServiceDiscovered(uint16_t connectionHandle) {
     DiscoverNextService(connectionHandle);
   } else {
     NRF_LOG_INFO("End of service discovery");
+    onDiscoveryDone(connectionHandle);
   }
 }
 
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstdint>
+#include <functional>
 
 namespace Pinetime {
   namespace Controllers {
@@ -9,13 +10,15 @@ namespace Pinetime {
 
     class ServiceDiscovery {
     public:
-      ServiceDiscovery(std::array<BleClient*, 2>&& bleClients);
+      ServiceDiscovery(std::array<BleClient*, 3>&& bleClients);
 
-      void StartDiscovery(uint16_t connectionHandle);
+      // onDiscoveryDone is called once all the clients are done
+      void StartDiscovery(uint16_t connectionHandle, std::function<void(uint16_t)> onDiscoveryDone);
 
     private:
       BleClient** clientIterator;
-      std::array<BleClient*, 2> clients;
+      std::array<BleClient*, 3> clients;
+      std::function<void(uint16_t)> onDiscoveryDone;
       void OnServiceDiscovered(uint16_t connectionHandle);
       void DiscoverNextService(uint16_t connectionHandle);
     };
@@ -22,58 +22,85 @@
 #include <array>
 #include <cstring>
 #include <nrf_log.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "components/ble/MbufReader.h"
 
 using namespace Pinetime::Controllers;
 
 namespace {
-  enum class MessageType : uint8_t { CurrentWeather, Forecast, Unknown };
+  enum class MessageType : uint8_t { CurrentWeather, Forecast, HourlyForecast, Unknown };
 
-  uint64_t ToUInt64(const uint8_t* data) {
-    return data[0] + (data[1] << 8) + (data[2] << 16) + (data[3] << 24) + (static_cast<uint64_t>(data[4]) << 32) +
-           (static_cast<uint64_t>(data[5]) << 40) + (static_cast<uint64_t>(data[6]) << 48) + (static_cast<uint64_t>(data[7]) << 56);
-  }
-
-  int16_t ToInt16(const uint8_t* data) {
-    return data[0] + (data[1] << 8);
-  }
+  constexpr int64_t secondsPerHour = 60 * 60;
+  constexpr int64_t expiryDelay = 24 * secondsPerHour;
+  // Temperature, icon and precipitation probability
+  constexpr size_t hourSize = 4;
 
-  SimpleWeatherService::CurrentWeather CreateCurrentWeather(const uint8_t* dataBuffer) {
+  // The fields follow the message type and the version
+  SimpleWeatherService::CurrentWeather CreateCurrentWeather(MbufReader& reader) {
+    auto timestamp = reader.ReadUint64();
+    auto temperature = reader.ReadInt16();
+    auto minTemperature = reader.ReadInt16();
+    auto maxTemperature = reader.ReadInt16();
     SimpleWeatherService::Location cityName;
-    std::memcpy(cityName.data(), &dataBuffer[16], 32);
-    cityName[32] = '\0';
-    return SimpleWeatherService::CurrentWeather(ToUInt64(&dataBuffer[2]),
-                                                ToInt16(&dataBuffer[10]),
-                                                ToInt16(&dataBuffer[12]),
-                                                ToInt16(&dataBuffer[14]),
-                                                SimpleWeatherService::Icons {dataBuffer[16 + 32]},
-                                                std::move(cityName));
+    reader.ReadString(cityName.data(), 32, 32);
+    auto icon = SimpleWeatherService::Icons {reader.ReadUint8()};
+    return SimpleWeatherService::CurrentWeather(timestamp, temperature, minTemperature, maxTemperature, icon, std::move(cityName));
   }
 
-  SimpleWeatherService::Forecast CreateForecast(const uint8_t* dataBuffer) {
-    auto timestamp = static_cast<uint64_t>(ToUInt64(&dataBuffer[2]));
+  SimpleWeatherService::Forecast CreateForecast(MbufReader& reader) {
+    auto timestamp = reader.ReadUint64();
 
     std::array<SimpleWeatherService::Forecast::Day, SimpleWeatherService::MaxNbForecastDays> days;
-    const uint8_t nbDaysInBuffer = dataBuffer[10];
+    const uint8_t nbDaysInBuffer = reader.ReadUint8();
     const uint8_t nbDays = std::min(SimpleWeatherService::MaxNbForecastDays, nbDaysInBuffer);
     for (int i = 0; i < nbDays; i++) {
-      days[i] = SimpleWeatherService::Forecast::Day {ToInt16(&dataBuffer[11 + (i * 5)]),
-                                                     ToInt16(&dataBuffer[13 + (i * 5)]),
-                                                     SimpleWeatherService::Icons {dataBuffer[15 + (i * 5)]}};
+      auto minTemperature = reader.ReadInt16();
+      auto maxTemperature = reader.ReadInt16();
+      auto icon = SimpleWeatherService::Icons {reader.ReadUint8()};
+      days[i] = SimpleWeatherService::Forecast::Day {minTemperature, maxTemperature, icon};
     }
     return SimpleWeatherService::Forecast {timestamp, nbDays, days};
   }
 
-  MessageType GetMessageType(const uint8_t* data) {
-    auto messageType = static_cast<MessageType>(*data);
+  // Checks the runs of hours, so that a malformed message is rejected before any of it is applied
+  bool IsValidHourlyForecast(MbufReader reader) {
+    reader.Skip(sizeof(uint64_t));
+    const uint8_t nbHours = reader.ReadUint8();
+    const uint8_t nbRuns = reader.ReadUint8();
+    for (int i = 0; i < nbRuns && reader.Ok(); i++) {
+      const uint8_t firstHour = reader.ReadUint8();
+      const uint8_t runLength = reader.ReadUint8();
+      if (firstHour + runLength > nbHours) {
+        return false;
+      }
+      reader.Skip(runLength * hourSize);
+    }
+    return reader.Ok();
+  }
+
+  // Removes the first hours and moves the start of the forecast accordingly
+  void DropHours(SimpleWeatherService::HourlyForecast& forecast, uint64_t nbHours) {
+    if (nbHours < forecast.nbHours) {
+      std::copy(forecast.hours.begin() + nbHours, forecast.hours.begin() + forecast.nbHours, forecast.hours.begin());
+      forecast.nbHours -= nbHours;
+    } else {
+      forecast.nbHours = 0;
+    }
+    forecast.timestamp += nbHours * secondsPerHour;
+  }
+
+  bool IsExpired(uint64_t timestamp, int64_t now) {
+    return now - static_cast<int64_t>(timestamp) >= expiryDelay;
+  }
+
+  MessageType GetMessageType(uint8_t type) {
+    auto messageType = static_cast<MessageType>(type);
     if (messageType > MessageType::Unknown) {
       return MessageType::Unknown;
     }
     return messageType;
   }
-
-  uint8_t GetVersion(const uint8_t* dataBuffer) {
-    return dataBuffer[1];
-  }
 }
 
 int WeatherCallback(uint16_t /*connHandle*/, uint16_t /*attrHandle*/, struct ble_gatt_access_ctxt* ctxt, void* arg) {
@@ -89,33 +116,61 @@ void SimpleWeatherService::Init() {
 }
 
 int SimpleWeatherService::OnCommand(struct ble_gatt_access_ctxt* ctxt) {
-  const auto* buffer = ctxt->om;
-  const auto* dataBuffer = buffer->om_data;
+  MbufReader reader {ctxt->om};
+  auto messageType = GetMessageType(reader.ReadUint8());
+  auto version = reader.ReadUint8();
 
-  switch (GetMessageType(dataBuffer)) {
+  switch (messageType) {
     case MessageType::CurrentWeather:
-      if (GetVersion(dataBuffer) == 0) {
-        currentWeather = CreateCurrentWeather(dataBuffer);
+      if (version == 0) {
+        auto weather = CreateCurrentWeather(reader);
+        if (!reader.Ok()) {
+          return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        }
         NRF_LOG_INFO("Current weather :\n\tTimestamp : %d\n\tTemperature:%d\n\tMin:%d\n\tMax:%d\n\tIcon:%d\n\tLocation:%s",
-                     currentWeather->timestamp,
-                     currentWeather->temperature,
-                     currentWeather->minTemperature,
-                     currentWeather->maxTemperature,
-                     currentWeather->iconId,
-                     currentWeather->location.data());
+                     weather.timestamp,
+                     weather.temperature,
+                     weather.minTemperature,
+                     weather.maxTemperature,
+                     weather.iconId,
+                     weather.location.data());
+        taskENTER_CRITICAL();
+        currentWeather = std::move(weather);
+        taskEXIT_CRITICAL();
+        DataChanged();
       }
       break;
     case MessageType::Forecast:
-      if (GetVersion(dataBuffer) == 0) {
-        forecast = CreateForecast(dataBuffer);
-        NRF_LOG_INFO("Forecast : Timestamp : %d", forecast->timestamp);
-        for (int i = 0; i < 5; i++) {
+      if (version == 0) {
+        auto newForecast = CreateForecast(reader);
+        if (!reader.Ok()) {
+          return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        }
+        taskENTER_CRITICAL();
+        forecast = newForecast;
+        taskEXIT_CRITICAL();
+        DataChanged();
+        NRF_LOG_INFO("Forecast : Timestamp : %d", newForecast.timestamp);
+        for (int i = 0; i < newForecast.nbDays; i++) {
           NRF_LOG_INFO("\t[%d] Min: %d - Max : %d - Icon : %d",
                        i,
-                       forecast->days[i].minTemperature,
-                       forecast->days[i].maxTemperature,
-                       forecast->days[i].iconId);
+                       newForecast.days[i].minTemperature,
+                       newForecast.days[i].maxTemperature,
+                       newForecast.days[i].iconId);
+        }
+      }
+      break;
+    case MessageType::HourlyForecast:
+      if (version == 0) {
+        if (!IsValidHourlyForecast(reader)) {
+          return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
         }
+        // The message is applied in place: the hours that were not sent are kept
+        taskENTER_CRITICAL();
+        ApplyHourlyForecast(reader);
+        taskEXIT_CRITICAL();
+        DataChanged();
+        NRF_LOG_INFO("Hourly forecast updated");
       }
       break;
     default:
@@ -125,42 +180,101 @@ int SimpleWeatherService::OnCommand(struct ble_gatt_access_ctxt* ctxt) {
   return 0;
 }
 
-std::optional<SimpleWeatherService::CurrentWeather> SimpleWeatherService::Current() const {
-  if (currentWeather) {
-    auto currentTime = dateTimeController.CurrentDateTime().time_since_epoch();
-    auto weatherTpSecond = std::chrono::seconds {currentWeather->timestamp};
-    auto weatherTp = std::chrono::duration_cast<std::chrono::seconds>(weatherTpSecond);
-    auto delta = currentTime - weatherTp;
+void SimpleWeatherService::ApplyHourlyForecast(MbufReader& reader) {
+  const auto timestamp = reader.ReadUint64();
+  const uint8_t nbHoursInBuffer = reader.ReadUint8();
+  const uint8_t nbHours = std::min(MaxNbForecastHours, nbHoursInBuffer);
 
-    if (delta < std::chrono::hours {24}) {
-      return currentWeather;
+  // The stored hours are kept if the forecast starts at the same time or a whole number of hours later
+  if (hourlyForecast && timestamp >= hourlyForecast->timestamp && (timestamp - hourlyForecast->timestamp) % secondsPerHour == 0) {
+    DropHours(*hourlyForecast, (timestamp - hourlyForecast->timestamp) / secondsPerHour);
+  } else {
+    hourlyForecast = HourlyForecast {timestamp, 0, {}};
+  }
+  for (uint8_t i = hourlyForecast->nbHours; i < nbHours; i++) {
+    hourlyForecast->hours[i] = HourlyForecast::Hour {0, Icons::Unknown, 0};
+  }
+  hourlyForecast->nbHours = nbHours;
+
+  const uint8_t nbRuns = reader.ReadUint8();
+  for (int i = 0; i < nbRuns; i++) {
+    const uint8_t firstHour = reader.ReadUint8();
+    const uint8_t runLength = reader.ReadUint8();
+    for (int j = 0; j < runLength; j++) {
+      auto temperature = reader.ReadInt16();
+      auto icon = Icons {reader.ReadUint8()};
+      auto precipitationProbability = reader.ReadUint8();
+      if (firstHour + j < nbHours) {
+        hourlyForecast->hours[firstHour + j] = HourlyForecast::Hour {temperature, icon, precipitationProbability};
+      }
     }
   }
-  return {};
+}
+
+std::optional<SimpleWeatherService::CurrentWeather> SimpleWeatherService::Current(uint16_t& version) const {
+  taskENTER_CRITICAL();
+  auto copy = currentWeather;
+  // The version is incremented after the data is written: it may be older than the copy, but never newer
+  version = dataVersion.load(std::memory_order_acquire);
+  taskEXIT_CRITICAL();
+  return copy;
 }
 
 std::optional<SimpleWeatherService::Forecast> SimpleWeatherService::GetForecast() const {
-  if (forecast) {
-    auto currentTime = dateTimeController.CurrentDateTime().time_since_epoch();
-    auto weatherTpSecond = std::chrono::seconds {forecast->timestamp};
-    auto weatherTp = std::chrono::duration_cast<std::chrono::seconds>(weatherTpSecond);
-    auto delta = currentTime - weatherTp;
-
-    if (delta < std::chrono::hours {24}) {
-      return this->forecast;
+  taskENTER_CRITICAL();
+  auto copy = forecast;
+  taskEXIT_CRITICAL();
+  return copy;
+}
+
+std::optional<SimpleWeatherService::HourlyForecast> SimpleWeatherService::GetHourlyForecast() const {
+  taskENTER_CRITICAL();
+  auto copy = hourlyForecast;
+  taskEXIT_CRITICAL();
+  return copy;
+}
+
+void SimpleWeatherService::UpdateExpiry() {
+  const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(dateTimeController.CurrentDateTime().time_since_epoch()).count();
+  bool changed = false;
+
+  taskENTER_CRITICAL();
+  if (currentWeather && IsExpired(currentWeather->timestamp, now)) {
+    currentWeather.reset();
+    changed = true;
+  }
+  if (forecast && IsExpired(forecast->timestamp, now)) {
+    forecast.reset();
+    changed = true;
+  }
+  if (hourlyForecast && now - static_cast<int64_t>(hourlyForecast->timestamp) >= secondsPerHour) {
+    DropHours(*hourlyForecast, (now - static_cast<int64_t>(hourlyForecast->timestamp)) / secondsPerHour);
+    if (hourlyForecast->nbHours == 0) {
+      hourlyForecast.reset();
     }
+    changed = true;
   }
-  return {};
+  taskEXIT_CRITICAL();
+
+  if (changed) {
+    dataVersion.fetch_add(1, std::memory_order_release);
+  }
+}
+
+void SimpleWeatherService::DataChanged() {
+  dataVersion.fetch_add(1, std::memory_order_release);
+  // The host may send data that is already (partially) expired
+  UpdateExpiry();
 }
 
 bool SimpleWeatherService::CurrentWeather::operator==(const SimpleWeatherService::CurrentWeather& other) const {
   return this->iconId == other.iconId && this->temperature == other.temperature && this->timestamp == other.timestamp &&
-         this->maxTemperature == other.maxTemperature && this->minTemperature == other.maxTemperature &&
+         this->maxTemperature == other.maxTemperature && this->minTemperature == other.minTemperature &&
          std::strcmp(this->location.data(), other.location.data()) == 0;
 }
 
 bool SimpleWeatherService::Forecast::Day::operator==(const SimpleWeatherService::Forecast::Day& other) const {
-  return this->iconId == other.iconId && this->maxTemperature == other.maxTemperature && this->minTemperature == other.maxTemperature;
+  return this->iconId == other.iconId && this->maxTemperature == other.maxTemperature && this->minTemperature == other.minTemperature;
 }
 
 bool SimpleWeatherService::Forecast::operator==(const SimpleWeatherService::Forecast& other) const {
@@ -17,6 +17,7 @@
 */
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -37,6 +38,7 @@ int WeatherCallback(uint16_t connHandle, uint16_t attrHandle, struct ble_gatt_ac
 
 namespace Pinetime {
   namespace Controllers {
+    class MbufReader;
 
     class SimpleWeatherService {
     public:
@@ -47,6 +49,7 @@ namespace Pinetime {
       int OnCommand(struct ble_gatt_access_ctxt* ctxt);
 
       static constexpr uint8_t MaxNbForecastDays = 5;
+      static constexpr uint8_t MaxNbForecastHours = 48;
 
       enum class Icons : uint8_t {
         Sun = 0,       // ClearSky
@@ -105,8 +108,37 @@ namespace Pinetime {
         bool operator==(const Forecast& other) const;
       };
 
-      std::optional<CurrentWeather> Current() const;
+      struct HourlyForecast {
+        // Start of the first hour
+        uint64_t timestamp;
+        uint8_t nbHours;
+
+        struct Hour {
+          int16_t temperature;
+          Icons iconId; // Unknown for the hours the host didn't send yet
+          uint8_t precipitationProbability;
+        };
+
+        std::array<Hour, MaxNbForecastHours> hours;
+      };
+
+      static_assert(sizeof(HourlyForecast::Hour) == 4, "The hours are stored packed");
+
+      // The accessors return a copy of the data, made in a critical section since the data is written by other tasks.
+      // Version() is incremented whenever this data changes (new data from the host, or expiry): screens compare it
+      // with the last version they read, and only copy the data when it changed. Current() sets the version of its copy,
+      // read in the same critical section, so that a change made right after the copy is seen at the next refresh.
+      std::optional<CurrentWeather> Current(uint16_t& version) const;
       std::optional<Forecast> GetForecast() const;
+      std::optional<HourlyForecast> GetHourlyForecast() const;
+
+      uint16_t Version() const {
+        return dataVersion.load(std::memory_order_acquire);
+      }
+
+      // Drops the data older than 24h and the past hours of the hourly forecast. Called once per minute, and when the
+      // time changes.
+      void UpdateExpiry();
 
       static int16_t CelsiusToFahrenheit(int16_t celsius) {
         return celsius * 9 / 5 + 3200;
@@ -142,8 +174,14 @@ namespace Pinetime {
 
       Pinetime::Controllers::DateTime& dateTimeController;
 
+      // Written by the BLE task (OnCommand) and the system task (UpdateExpiry), in critical sections
       std::optional<CurrentWeather> currentWeather;
       std::optional<Forecast> forecast;
+      std::optional<HourlyForecast> hourlyForecast;
+      std::atomic<uint16_t> dataVersion {0};
+
+      void ApplyHourlyForecast(MbufReader& reader);
+      void DataChanged();
     };
   }
 }
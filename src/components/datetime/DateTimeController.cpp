@@ -2,7 +2,7 @@
 #include <libraries/log/nrf_log.h>
 #include <systemtask/SystemTask.h>
 #include <hal/nrf_rtc.h>
-#include "nrf_assert.h"
+#include <task.h>
 
 using namespace Pinetime::Controllers;
 
@@ -11,19 +11,55 @@ namespace {
   char const* DaysStringShortLow[] = {"--", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
   char const* MonthsString[] = {"--", "JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
   char const* MonthsStringLow[] = {"--", "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+  constexpr int64_t secondsPerDay = 24 * 60 * 60;
+
+  int64_t FloorDiv(int64_t value, int64_t divisor) {
+    return (value >= 0) ? value / divisor : (value - divisor + 1) / divisor;
+  }
+
+  // Calendar fields of a time in seconds since the epoch, without the time zone handling (and the static buffer) of
+  // std::localtime. Based on the days_from_civil/civil_from_days algorithms of Howard Hinnant.
+  std::tm CalendarTime(int64_t seconds) {
+    int64_t days = FloorDiv(seconds, secondsPerDay);
+    int64_t secondOfDay = seconds - days * secondsPerDay;
+
+    std::tm tm {};
+    tm.tm_hour = secondOfDay / 3600;
+    tm.tm_min = (secondOfDay / 60) % 60;
+    tm.tm_sec = secondOfDay % 60;
+    // The epoch is a thursday
+    tm.tm_wday = static_cast<int>(days - FloorDiv(days + 4, 7) * 7 + 4);
+
+    // Years starting on march 1st, so that the leap day is at the end of the year
+    int64_t z = days + 719468;
+    int64_t era = FloorDiv(z, 146097);
+    auto dayOfEra = static_cast<uint32_t>(z - era * 146097);
+    uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    uint32_t monthIndex = (5 * dayOfYear + 2) / 153;
+    int64_t year = static_cast<int64_t>(yearOfEra) + era * 400 + (monthIndex >= 10 ? 1 : 0);
+    bool leapYear = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+
+    tm.tm_mday = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    tm.tm_mon = (monthIndex < 10) ? monthIndex + 2 : monthIndex - 10;
+    tm.tm_year = static_cast<int>(year - 1900);
+    tm.tm_yday = (dayOfYear >= 306) ? dayOfYear - 306 : dayOfYear + 59 + (leapYear ? 1 : 0);
+    return tm;
+  }
+
+  int64_t ToTicks(std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> t) {
+    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+    return FloorDiv(milliseconds * configTICK_RATE_HZ, 1000);
+  }
 }
 
 DateTime::DateTime(Controllers::Settings& settingsController) : settingsController {settingsController} {
-  mutex = xSemaphoreCreateMutex();
-  ASSERT(mutex != nullptr);
-  xSemaphoreGive(mutex);
 }
 
 void DateTime::SetCurrentTime(std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> t) {
-  xSemaphoreTake(mutex, portMAX_DELAY);
-  this->currentDateTime = t;
-  UpdateTime(previousSystickCounter, true); // Update internal state without updating the time
-  xSemaphoreGive(mutex);
+  UpdateBase(true, ToTicks(t));
+  ScheduleMinuteTimer();
 }
 
 void DateTime::SetTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
@@ -41,12 +77,9 @@ void DateTime::SetTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour,
 
   tm.tm_isdst = -1; // Use DST value from local time zone
 
-  xSemaphoreTake(mutex, portMAX_DELAY);
-  currentDateTime = std::chrono::system_clock::from_time_t(std::mktime(&tm));
-  UpdateTime(previousSystickCounter, true);
-  xSemaphoreGive(mutex);
+  SetCurrentTime(std::chrono::system_clock::from_time_t(std::mktime(&tm)));
 
-  systemTask->PushMessage(System::Messages::OnNewTime);
+  systemTask->Events().Publish(System::Topics::TimeChanged);
 }
 
 void DateTime::SetTimeZone(int8_t timezone, int8_t dst) {
@@ -54,71 +87,129 @@ void DateTime::SetTimeZone(int8_t timezone, int8_t dst) {
   dstOffset = dst;
 }
 
-std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> DateTime::CurrentDateTime() {
-  xSemaphoreTake(mutex, portMAX_DELAY);
-  UpdateTime(nrf_rtc_counter_get(portNRF_RTC_REG), false);
-  xSemaphoreGive(mutex);
-  return currentDateTime;
+std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds> DateTime::Now() const {
+  TimeBase timeBase = ReadBase();
+  int64_t ticks = timeBase.localTime + ElapsedTicks(timeBase);
+  return std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds>(
+    std::chrono::milliseconds(FloorDiv(ticks * 1000, configTICK_RATE_HZ)));
 }
 
-void DateTime::UpdateTime(uint32_t systickCounter, bool forceUpdate) {
-  // Handle systick counter overflow
-  uint32_t systickDelta = 0;
-  if (systickCounter < previousSystickCounter) {
-    systickDelta = static_cast<uint32_t>(portNRF_RTC_MAXTICKS) - previousSystickCounter;
-    systickDelta += systickCounter + 1;
-  } else {
-    systickDelta = systickCounter - previousSystickCounter;
+std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> DateTime::CurrentDateTime() const {
+  return std::chrono::floor<std::chrono::seconds>(Now());
+}
+
+std::chrono::seconds DateTime::Uptime() const {
+  TimeBase timeBase = ReadBase();
+  return std::chrono::seconds((timeBase.uptime + ElapsedTicks(timeBase)) / configTICK_RATE_HZ);
+}
+
+// Lock-free read of the time base: retry if a writer updated it in the meantime
+DateTime::TimeBase DateTime::ReadBase() const {
+  TimeBase timeBase;
+  uint32_t sequence;
+  do {
+    sequence = baseSequence.load(std::memory_order_acquire);
+    timeBase = base;
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((sequence & 1) != 0 || baseSequence.load(std::memory_order_relaxed) != sequence);
+  return timeBase;
+}
+
+uint32_t DateTime::ElapsedTicks(const TimeBase& timeBase) {
+  // The RTC counter is 24 bits wide
+  return (nrf_rtc_counter_get(portNRF_RTC_REG) - timeBase.counter) & portNRF_RTC_MAXTICKS;
+}
+
+// Move the time base to the current RTC counter value, and optionally set the local time.
+// Writers are serialized by a critical section, which is short and never blocks.
+void DateTime::UpdateBase(bool setLocalTime, int64_t localTime) {
+  taskENTER_CRITICAL();
+  baseSequence.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  uint32_t elapsed = ElapsedTicks(base);
+  base.counter = (base.counter + elapsed) & portNRF_RTC_MAXTICKS;
+  base.uptime += elapsed;
+  base.localTime = setLocalTime ? localTime : base.localTime + elapsed;
+
+  baseSequence.fetch_add(1, std::memory_order_release);
+  taskEXIT_CRITICAL();
+}
+
+std::tm DateTime::LocalTime() const {
+  int64_t second = std::chrono::duration_cast<std::chrono::seconds>(CurrentDateTime().time_since_epoch()).count();
+
+  // Lock-free read of the cache, like ReadBase()
+  std::tm calendarTime;
+  int64_t cachedSecond;
+  uint32_t sequence;
+  do {
+    sequence = localTimeSequence.load(std::memory_order_acquire);
+    calendarTime = localTime;
+    cachedSecond = localTimeSecond;
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((sequence & 1) != 0 || localTimeSequence.load(std::memory_order_relaxed) != sequence);
+  if (cachedSecond == second) {
+    return calendarTime;
   }
 
-  auto correctedDelta = systickDelta / configTICK_RATE_HZ;
-  // If a second hasn't passed, there is nothing to do
-  // If the time has been changed, set forceUpdate to trigger internal state updates
-  if (correctedDelta == 0 && !forceUpdate) {
+  calendarTime = CalendarTime(second);
+  taskENTER_CRITICAL();
+  localTimeSequence.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  localTime = calendarTime;
+  localTimeSecond = second;
+  localTimeSequence.fetch_add(1, std::memory_order_release);
+  taskEXIT_CRITICAL();
+  return calendarTime;
+}
+
+// Arm the minute timer for the next minute boundary, instead of polling the time to detect new minutes
+void DateTime::ScheduleMinuteTimer() {
+  if (minuteTimer == nullptr) {
     return;
   }
-  auto rest = systickDelta % configTICK_RATE_HZ;
-  if (systickCounter >= rest) {
-    previousSystickCounter = systickCounter - rest;
-  } else {
-    previousSystickCounter = static_cast<uint32_t>(portNRF_RTC_MAXTICKS) - (rest - systickCounter - 1);
-  }
+  auto milliseconds = Now().time_since_epoch().count();
+  auto millisecondsToNextMinute = 60000 - (milliseconds - FloorDiv(milliseconds, 60000) * 60000);
+  // Round up, and add one tick so that the timer never expires just before the boundary
+  auto ticks = static_cast<TickType_t>((millisecondsToNextMinute * configTICK_RATE_HZ + 999) / 1000) + 1;
+  // The timer task empties the command queue, so it can't wait for room in it: if the queue is full, the command is
+  // sent again by Poll()
+  TickType_t timeout = (xTaskGetCurrentTaskHandle() == xTimerGetTimerDaemonTaskHandle()) ? 0 : scheduleTimeout;
+  schedulePending = (xTimerChangePeriod(minuteTimer, ticks, timeout) != pdPASS);
+}
 
-  currentDateTime += std::chrono::seconds(correctedDelta);
-  uptime += std::chrono::seconds(correctedDelta);
+void DateTime::Poll() {
+  if (schedulePending) {
+    ScheduleMinuteTimer();
+  }
+}
 
-  std::time_t currentTime = std::chrono::system_clock::to_time_t(currentDateTime);
-  localTime = *std::localtime(&currentTime);
+void DateTime::MinuteTimerCallback(TimerHandle_t xTimer) {
+  auto* dateTime = static_cast<DateTime*>(pvTimerGetTimerID(xTimer));
+  dateTime->OnNewMinute();
+}
 
-  auto minute = Minutes();
-  auto hour = Hours();
+void DateTime::OnNewMinute() {
+  // Also keeps the RTC counter from overflowing past the base
+  UpdateBase(false);
 
-  if (minute == 0 && !isHourAlreadyNotified) {
-    isHourAlreadyNotified = true;
-    if (systemTask != nullptr) {
+  auto minutes = std::chrono::duration_cast<std::chrono::minutes>(Now().time_since_epoch()).count();
+  auto minuteOfDay = minutes - FloorDiv(minutes, 24 * 60) * 24 * 60;
+  if (systemTask != nullptr) {
+    if (minuteOfDay % 60 == 0) {
       systemTask->PushMessage(System::Messages::OnNewHour);
     }
-  } else if (minute != 0) {
-    isHourAlreadyNotified = false;
-  }
-
-  if ((minute == 0 || minute == 30) && !isHalfHourAlreadyNotified) {
-    isHalfHourAlreadyNotified = true;
-    if (systemTask != nullptr) {
+    if (minuteOfDay % 30 == 0) {
       systemTask->PushMessage(System::Messages::OnNewHalfHour);
     }
-  } else if (minute != 0 && minute != 30) {
-    isHalfHourAlreadyNotified = false;
-  }
-
-  // Notify new day to SystemTask
-  if (hour == 0 and not isMidnightAlreadyNotified) {
-    isMidnightAlreadyNotified = true;
-    if (systemTask != nullptr)
+    // Notify new day to SystemTask
+    if (minuteOfDay == 0) {
       systemTask->PushMessage(System::Messages::OnNewDay);
-  } else if (hour != 0) {
-    isMidnightAlreadyNotified = false;
+    }
   }
+
+  ScheduleMinuteTimer();
 }
 
 const char* DateTime::MonthShortToString() const {
@@ -139,6 +230,8 @@ const char* DateTime::DayOfWeekShortToStringLow(Days day) {
 
 void DateTime::Register(Pinetime::System::SystemTask* systemTask) {
   this->systemTask = systemTask;
+  minuteTimer = xTimerCreate("minuteTimer", 1, pdFALSE, this, MinuteTimerCallback);
+  ScheduleMinuteTimer();
 }
 
 using ClockType = Pinetime::Controllers::Settings::ClockType;
@@ -1,12 +1,13 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <chrono>
 #include <ctime>
 #include <string>
 #include "components/settings/Settings.h"
 #include <FreeRTOS.h>
-#include <semphr.h>
+#include <timers.h>
 
 namespace Pinetime {
   namespace System {
@@ -48,19 +49,19 @@ namespace Pinetime {
       void SetTimeZone(int8_t timezone, int8_t dst);
 
       uint16_t Year() const {
-        return 1900 + localTime.tm_year;
+        return 1900 + LocalTime().tm_year;
       }
 
       Months Month() const {
-        return static_cast<Months>(localTime.tm_mon + 1);
+        return static_cast<Months>(LocalTime().tm_mon + 1);
       }
 
       uint8_t Day() const {
-        return localTime.tm_mday;
+        return LocalTime().tm_mday;
       }
 
       Days DayOfWeek() const {
-        int daysSinceSunday = localTime.tm_wday;
+        int daysSinceSunday = LocalTime().tm_wday;
         if (daysSinceSunday == 0) {
           return Days::Sunday;
         }
@@ -68,19 +69,19 @@ namespace Pinetime {
       }
 
       int DayOfYear() const {
-        return localTime.tm_yday + 1;
+        return LocalTime().tm_yday + 1;
       }
 
       uint8_t Hours() const {
-        return localTime.tm_hour;
+        return LocalTime().tm_hour;
       }
 
       uint8_t Minutes() const {
-        return localTime.tm_min;
+        return LocalTime().tm_min;
       }
 
       uint8_t Seconds() const {
-        return localTime.tm_sec;
+        return LocalTime().tm_sec;
       }
 
       /*
@@ -124,36 +125,65 @@ namespace Pinetime {
       static const char* MonthShortToStringLow(Months month);
       static const char* DayOfWeekShortToStringLow(Days day);
 
-      std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> CurrentDateTime();
+      /*
+       * Current local time with a millisecond resolution.
+       *
+       * This doesn't take any lock: the time is computed from the RTC counter and a time base protected by a sequence
+       * counter (seqlock), so it can be called from any task at any rate.
+       */
+      std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds> Now() const;
 
-      std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> UTCDateTime() {
+      // Current local time, truncated to the second
+      std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> CurrentDateTime() const;
+
+      std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> UTCDateTime() const {
         return CurrentDateTime() - std::chrono::seconds((tzOffset + dstOffset) * 15 * 60);
       }
 
-      std::chrono::seconds Uptime() const {
-        return uptime;
-      }
+      std::chrono::seconds Uptime() const;
 
       void Register(System::SystemTask* systemTask);
       void SetCurrentTime(std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> t);
       std::string FormattedTime();
 
+      // Arms the minute timer again if the last command couldn't be sent to the timer task (its command queue was full).
+      // Called periodically by SystemTask.
+      void Poll();
+
     private:
-      void UpdateTime(uint32_t systickCounter, bool forceUpdate);
+      // Time at a given value of the RTC counter, in RTC ticks (1/configTICK_RATE_HZ s)
+      struct TimeBase {
+        uint32_t counter = 0;
+        int64_t localTime = 0;
+        uint64_t uptime = 0;
+      };
+
+      TimeBase ReadBase() const;
+      static uint32_t ElapsedTicks(const TimeBase& timeBase);
+      void UpdateBase(bool setLocalTime, int64_t localTime = 0);
+      std::tm LocalTime() const;
+      void ScheduleMinuteTimer();
+      static void MinuteTimerCallback(TimerHandle_t xTimer);
+      void OnNewMinute();
 
-      std::tm localTime;
       int8_t tzOffset = 0;
       int8_t dstOffset = 0;
 
-      SemaphoreHandle_t mutex = nullptr;
-
-      uint32_t previousSystickCounter = 0;
-      std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> currentDateTime;
-      std::chrono::seconds uptime {0};
-
-      bool isMidnightAlreadyNotified = false;
-      bool isHourAlreadyNotified = true;
-      bool isHalfHourAlreadyNotified = true;
+      // The base must be moved forward more often than the RTC counter overflows (every 2^24 ticks, ~4.5h), which
+      // the minute timer takes care of
+      TimeBase base;
+      std::atomic<uint32_t> baseSequence {0};
+
+      // Calendar fields, computed on demand and cached for the current second. Protected by a sequence counter like the
+      // time base, since any task may update the cache.
+      mutable std::tm localTime {};
+      mutable int64_t localTimeSecond = -1;
+      mutable std::atomic<uint32_t> localTimeSequence {0};
+
+      // Time given to other tasks to send the commands of the timer when its queue is full
+      static constexpr TickType_t scheduleTimeout = pdMS_TO_TICKS(10);
+      TimerHandle_t minuteTimer = nullptr;
+      std::atomic<bool> schedulePending {false};
       System::SystemTask* systemTask = nullptr;
       Controllers::Settings& settingsController;
     };
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include "drivers/SpiNorFlash.h"
 #include <littlefs/lfs.h>
+#include "utility/Mutex.h"
 
 namespace Pinetime {
   namespace Controllers {
@@ -72,6 +73,8 @@ namespace Pinetime {
       const struct lfs_config lfsConfig;
 
       lfs_t lfs;
+      // littlefs isn't reentrant, and the file system is used by several tasks
+      Utility::Mutex mutex;
 
       static int SectorSync(const struct lfs_config* c);
       static int SectorErase(const struct lfs_config* c, lfs_block_t block);
@@ -0,0 +1,188 @@
+#include "components/heartrate/HeartRateHistory.h"
+#include <algorithm>
+#include "components/datetime/DateTimeController.h"
+#include "components/fs/FS.h"
+#include <FreeRTOS.h>
+#include <task.h>
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  constexpr const char* historyFileName = "/hrlog.dat";
+}
+
+HeartRateHistory::HeartRateHistory(Controllers::FS& fs, Controllers::DateTime& dateTimeController)
+  : fs {fs}, dateTimeController {dateTimeController} {
+}
+
+void HeartRateHistory::Init() {
+  lfs_file_t historyFile;
+  if (fs.FileOpen(&historyFile, historyFileName, LFS_O_RDONLY) != LFS_ERR_OK) {
+    return;
+  }
+
+  DayRecord record;
+  for (uint8_t slot = 0; slot < nbDays; slot++) {
+    if (fs.FileRead(&historyFile, reinterpret_cast<uint8_t*>(&record), sizeof(record)) != sizeof(record)) {
+      break;
+    }
+    if (record.version != fileVersion || record.day == noDay) {
+      continue;
+    }
+    // The most recent record may be today's, which is only known once the time is available
+    taskENTER_CRITICAL();
+    if (record.day > lastRecord.day) {
+      std::swap(record, lastRecord);
+    }
+    if (record.day != noDay) {
+      AddPastDay(MakeRollup(record.day, record.slots));
+    }
+    taskEXIT_CRITICAL();
+  }
+  fs.FileClose(&historyFile);
+}
+
+void HeartRateHistory::AddMeasurement(uint8_t heartRate) {
+  auto now = dateTimeController.CurrentDateTime();
+  uint16_t day = std::chrono::duration_cast<std::chrono::hours>(now.time_since_epoch()).count() / 24;
+  uint8_t slot = (dateTimeController.Hours() * 60 + dateTimeController.Minutes()) / slotDuration;
+
+  taskENTER_CRITICAL();
+  if (day != today && (day < firstValidDay || day < LatestDay())) {
+    // The clock isn't set or went back: the measurement is dropped instead of overwriting the history
+    taskEXIT_CRITICAL();
+    return;
+  }
+
+  if (day != today) {
+    if (today != noDay) {
+      finishedRecord = {today, fileVersion, slots};
+      finishedRecordPending = true;
+      AddPastDay(MakeRollup(today, slots));
+    }
+    today = day;
+    slots.fill(0);
+
+    // The record restored can't be later than today (see LatestDay())
+    if (lastRecord.day == day) {
+      slots = lastRecord.slots;
+    } else if (lastRecord.day != noDay) {
+      AddPastDay(MakeRollup(lastRecord.day, lastRecord.slots));
+    }
+    lastRecord.day = noDay;
+  }
+
+  if (slot < nbSlots) {
+    slots[slot] = heartRate;
+    historyChanged = true;
+  }
+  taskEXIT_CRITICAL();
+}
+
+void HeartRateHistory::SaveHistory() {
+  // The records are copied so that the file system isn't accessed in the critical section
+  DayRecord finished;
+  DayRecord current;
+  bool hasFinished;
+  taskENTER_CRITICAL();
+  if (!historyChanged) {
+    taskEXIT_CRITICAL();
+    return;
+  }
+  hasFinished = finishedRecordPending;
+  finished = finishedRecord;
+  current = {today, fileVersion, slots};
+  finishedRecordPending = false;
+  historyChanged = false;
+  taskEXIT_CRITICAL();
+
+  if (hasFinished) {
+    WriteRecord(finished);
+  }
+  if (current.day != noDay) {
+    WriteRecord(current);
+  }
+}
+
+HeartRateHistory::Snapshot HeartRateHistory::GetSnapshot() const {
+  Snapshot snapshot;
+  taskENTER_CRITICAL();
+  snapshot.today = today;
+  snapshot.slots = slots;
+  snapshot.pastDays = pastDays;
+  snapshot.nbPastDays = nbPastDays;
+  taskEXIT_CRITICAL();
+  return snapshot;
+}
+
+HeartRateHistory::Rollup HeartRateHistory::TodayRollup() const {
+  taskENTER_CRITICAL();
+  uint16_t day = today;
+  auto daySlots = slots;
+  taskEXIT_CRITICAL();
+  return MakeRollup(day, daySlots);
+}
+
+uint16_t HeartRateHistory::LatestDay() const {
+  if (today != noDay) {
+    return today;
+  }
+  uint16_t day = lastRecord.day;
+  if (nbPastDays > 0) {
+    day = std::max(day, pastDays[nbPastDays - 1].day);
+  }
+  return day;
+}
+
+HeartRateHistory::Rollup HeartRateHistory::MakeRollup(uint16_t day, const std::array<uint8_t, nbSlots>& daySlots) {
+  Rollup rollup;
+  rollup.day = day;
+  uint16_t sum = 0;
+  for (auto heartRate : daySlots) {
+    if (heartRate == 0) {
+      continue;
+    }
+    if (rollup.count == 0 || heartRate < rollup.min) {
+      rollup.min = heartRate;
+    }
+    if (heartRate > rollup.max) {
+      rollup.max = heartRate;
+    }
+    sum += heartRate;
+    rollup.count++;
+  }
+  if (rollup.count > 0) {
+    rollup.average = sum / rollup.count;
+  }
+  return rollup;
+}
+
+void HeartRateHistory::AddPastDay(const Rollup& rollup) {
+  auto begin = pastDays.begin();
+  auto end = pastDays.begin() + nbPastDays;
+  auto it = std::lower_bound(begin, end, rollup.day, [](const Rollup& r, uint16_t day) {
+    return r.day < day;
+  });
+
+  if (it != end && it->day == rollup.day) {
+    *it = rollup;
+  } else if (nbPastDays < nbDays) {
+    std::move_backward(it, end, end + 1);
+    *it = rollup;
+    nbPastDays++;
+  } else if (it != begin) {
+    // Full: drop the oldest day
+    std::move(begin + 1, it, begin);
+    *(it - 1) = rollup;
+  }
+}
+
+void HeartRateHistory::WriteRecord(const DayRecord& record) {
+  lfs_file_t historyFile;
+  if (fs.FileOpen(&historyFile, historyFileName, LFS_O_RDWR | LFS_O_CREAT) != LFS_ERR_OK) {
+    return;
+  }
+  fs.FileSeek(&historyFile, (record.day % nbDays) * sizeof(DayRecord));
+  fs.FileWrite(&historyFile, reinterpret_cast<const uint8_t*>(&record), sizeof(record));
+  fs.FileClose(&historyFile);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Controllers {
+    class FS;
+    class DateTime;
+
+    /*
+     * Keeps the heart rate measured in the background.
+     *
+     * The day is split in slots of slotDuration minutes, each holding the last heart rate (BPM) measured during the slot,
+     * or 0 if no measurement succeeded. Each day is stored as a fixed-size record in a ring file in the filesystem, one
+     * slot per day, and summarized as a daily rollup (min/max/average) in RAM.
+     *
+     * AddMeasurement() runs on the heart rate task, while the history is saved and read by other tasks: the state is
+     * only modified and copied in critical sections.
+     */
+    class HeartRateHistory {
+    public:
+      static constexpr uint8_t nbDays = 7;
+      static constexpr uint8_t slotDuration = 10;
+      static constexpr uint8_t nbSlots = 24 * 60 / slotDuration;
+
+      struct Rollup {
+        uint16_t day = 0;
+        uint8_t min = 0;
+        uint8_t max = 0;
+        uint8_t average = 0;
+        uint8_t count = 0;
+      };
+
+      HeartRateHistory(Controllers::FS& fs, Controllers::DateTime& dateTimeController);
+
+      void Init();
+      void AddMeasurement(uint8_t heartRate);
+      void SaveHistory();
+
+      struct Snapshot {
+        uint16_t today;
+        std::array<uint8_t, nbSlots> slots;
+        // Completed days, oldest first
+        std::array<Rollup, nbDays> pastDays;
+        size_t nbPastDays;
+      };
+
+      // Consistent copy of the history
+      Snapshot GetSnapshot() const;
+      Rollup TodayRollup() const;
+
+    private:
+      static constexpr uint16_t fileVersion = 1;
+      static constexpr uint16_t noDay = 0;
+      // 2021-01-01, earlier days come from a clock that wasn't set
+      static constexpr uint16_t firstValidDay = 18628;
+
+      struct DayRecord {
+        uint16_t day;
+        uint16_t version;
+        std::array<uint8_t, nbSlots> slots;
+      };
+
+      Controllers::FS& fs;
+      Controllers::DateTime& dateTimeController;
+
+      uint16_t today = noDay;
+      std::array<uint8_t, nbSlots> slots {};
+
+      std::array<Rollup, nbDays> pastDays {};
+      size_t nbPastDays = 0;
+
+      // Record loaded from the filesystem that may belong to today, restored by the first AddMeasurement()
+      DayRecord lastRecord {};
+      DayRecord finishedRecord {};
+      bool finishedRecordPending = false;
+      bool historyChanged = false;
+
+      uint16_t LatestDay() const;
+      static Rollup MakeRollup(uint16_t day, const std::array<uint8_t, nbSlots>& daySlots);
+      void AddPastDay(const Rollup& rollup);
+      void WriteRecord(const DayRecord& record);
+    };
+  }
+}
@@ -1,62 +1,71 @@
 #include "components/heartrate/Ppg.h"
 #include <nrf_log.h>
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 using namespace Pinetime::Controllers;
 
 namespace {
-  float LinearInterpolation(const float* xValues, const float* yValues, int length, float pointX) {
-    if (pointX > xValues[length - 1]) {
-      return yValues[length - 1];
-    } else if (pointX <= xValues[0]) {
-      return yValues[0];
-    }
-    int index = 0;
-    while (pointX > xValues[index] && index < length - 1) {
-      index++;
-    }
-    float pointX0 = xValues[index - 1];
-    float pointX1 = xValues[index];
-    float pointY0 = yValues[index - 1];
-    float pointY1 = yValues[index];
-    float mu = (pointX - pointX0) / (pointX1 - pointX0);
-
-    return (pointY0 * (1 - mu) + pointY1 * mu);
-  }
-
-  float PeakSearch(float* xVals, float* yVals, float threshold, float& width, float start, float end, int length) {
-    int peaks = 0;
-    bool enabled = false;
-    float minBin = 0.0f;
-    float maxBin = 0.0f;
-    float peakCenter = 0.0f;
-    float prevValue = LinearInterpolation(xVals, yVals, length, start - 0.01f);
-    float currValue = LinearInterpolation(xVals, yVals, length, start);
-    float idx = start;
-    while (idx < end) {
-      float nextValue = LinearInterpolation(xVals, yVals, length, idx + 0.01f);
-      if (currValue < threshold) {
-        enabled = true;
+  // Local maxima of the spectrum in [start, end) above threshold, strongest first, located with a parabolic interpolation.
+  // Returns the number of candidates found.
+  template <size_t N>
+  int FindPeaks(const std::array<float, Ppg::spectrumLength>& spectrum,
+                int start,
+                int end,
+                float threshold,
+                std::array<Ppg::PeakCandidate, N>& candidates) {
+    int count = 0;
+    start = std::max(start, 1);
+    end = std::min(end, static_cast<int>(Ppg::spectrumLength) - 1);
+    for (int idx = start; idx < end; idx++) {
+      float left = spectrum[idx - 1];
+      float value = spectrum[idx];
+      float right = spectrum[idx + 1];
+      if (value < threshold || value < left || value <= right) {
+        continue;
       }
-      if (currValue >= threshold and enabled) {
-        if (prevValue < threshold) {
-          minBin = idx;
-        } else if (nextValue <= threshold) {
-          maxBin = idx;
-          peaks++;
-          width = maxBin - minBin;
-          peakCenter = width / 2.0f + minBin;
-        }
+
+      int position;
+      if (count < static_cast<int>(N)) {
+        position = count++;
+      } else if (value > candidates[N - 1].amplitude) {
+        position = N - 1;
+      } else {
+        continue;
+      }
+      while (position > 0 && candidates[position - 1].amplitude < value) {
+        candidates[position] = candidates[position - 1];
+        position--;
       }
-      prevValue = currValue;
-      currValue = nextValue;
-      idx += 0.01f;
+
+      float denominator = left - 2.0f * value + right;
+      float offset = (denominator != 0.0f) ? 0.5f * (left - right) / denominator : 0.0f;
+      candidates[position] = {static_cast<float>(idx) + offset, value};
+    }
+    return count;
+  }
+
+  // Width (bins) of the peak around bin at the given threshold
+  float PeakWidth(const std::array<float, Ppg::spectrumLength>& spectrum, int bin, float threshold) {
+    int left = bin;
+    while (left > 0 && spectrum[left - 1] >= threshold) {
+      left--;
+    }
+    float leftEdge = static_cast<float>(left);
+    if (left > 0) {
+      leftEdge -= (spectrum[left] - threshold) / (spectrum[left] - spectrum[left - 1]);
+    }
+
+    int right = bin;
+    while (right < static_cast<int>(Ppg::spectrumLength) - 1 && spectrum[right + 1] >= threshold) {
+      right++;
     }
-    if (peaks != 1) {
-      width = 0.0f;
-      peakCenter = 0.0f;
+    float rightEdge = static_cast<float>(right);
+    if (right < static_cast<int>(Ppg::spectrumLength) - 1) {
+      rightEdge += (spectrum[right] - threshold) / (spectrum[right] - spectrum[right + 1]);
     }
-    return peakCenter;
+    return rightEdge - leftEdge;
   }
 
   float SpectrumMean(const std::array<float, Ppg::spectrumLength>& signal, int start, int end) {
@@ -142,8 +151,10 @@ Ppg::Ppg() {
   spectrum.fill(0.0f);
 }
 
-int8_t Ppg::Preprocess(uint32_t hrs, uint32_t als) {
+int8_t Ppg::Preprocess(uint32_t hrs, uint32_t als, uint16_t timestamp, uint16_t acceleration) {
   if (dataIndex < dataLength) {
+    dataTimestamps[dataIndex] = timestamp;
+    dataAccel[dataIndex] = acceleration;
     dataHRS[dataIndex++] = hrs;
   }
   alsValue = als;
@@ -163,6 +174,8 @@ int Ppg::HeartRate() {
   // Make room for overlapWindow number of new samples
   for (int idx = 0; idx < dataLength - overlapWindow; idx++) {
     dataHRS[idx] = dataHRS[idx + overlapWindow];
+    dataTimestamps[idx] = dataTimestamps[idx + overlapWindow];
+    dataAccel[idx] = dataAccel[idx + overlapWindow];
   }
   dataIndex = dataLength - overlapWindow;
   return hr;
@@ -178,61 +191,30 @@ void Ppg::Reset(bool resetDaqBuffer) {
   alsThreshold = UINT16_MAX;
   alsValue = 0;
   resetSpectralAvg = true;
+  confidence = 0;
   spectrum.fill(0.0f);
 }
 
 // Pass init == true to reset spectral averaging.
 // Returns -1 (Reset Acquisition), 0 (Unable to obtain HR) or HR (BPM).
 int Ppg::ProcessHeartRate(bool init) {
-  std::copy(dataHRS.begin(), dataHRS.end(), vReal.begin());
-  Detrend(vReal);
-  Filter30to240(vReal);
-  vImag.fill(0.0f);
-  // Apply Hanning Window
-  int hannIdx = 0;
-  for (int idx = 0; idx < dataLength; idx++) {
-    if (idx >= dataLength >> 1) {
-      hannIdx--;
-    }
-    vReal[idx] *= hanning[hannIdx];
-    if (idx < dataLength >> 1) {
-      hannIdx++;
-    }
-  }
-  // Compute in place power spectrum
-  ArduinoFFT<float> FFT = ArduinoFFT<float>(vReal.data(), vImag.data(), dataLength, sampleFreq);
-  FFT.compute(FFTDirection::Forward);
-  FFT.complexToMagnitude();
-  FFT.~ArduinoFFT();
+  Resample(dataHRS, vReal);
+  ComputeSpectrum();
   SpectrumAverage(vReal.data(), spectrum.data(), spectrum.size(), init);
+  ProcessMotion();
   peakLocation = 0.0f;
-  float threshold = peakDetectionThreshold;
-  float peakWidth = 0.0f;
-  int specLen = spectrum.size();
+  confidence = 0;
   float max = SpectrumMax(spectrum, hrROIbegin, hrROIend);
   float signalToNoiseRatio = SignalToNoise(spectrum, hrROIbegin, hrROIend, max);
   if (signalToNoiseRatio > signalToNoiseThreshold && spectrum.at(0) < dcThreshold) {
-    threshold *= max;
-    // Reuse VImag for interpolation x values passed to PeakSearch
-    for (int idx = 0; idx < dataLength; idx++) {
-      vImag[idx] = idx;
-    }
-    peakLocation = PeakSearch(vImag.data(),
-                              spectrum.data(),
-                              threshold,
-                              peakWidth,
-                              static_cast<float>(hrROIbegin),
-                              static_cast<float>(hrROIend),
-                              specLen);
-    peakLocation *= freqResolution;
-  }
-  // Peak too wide? (broad spectrum noise or large, rapid HR change)
-  if (peakWidth > maxPeakWidth) {
-    peakLocation = 0.0f;
+    std::array<PeakCandidate, maxPeakCandidates> candidates;
+    int nbCandidates = FindPeaks(spectrum, hrROIbegin, hrROIend, peakCandidateThreshold * max, candidates);
+    peakLocation = SelectPeak(candidates, nbCandidates, max);
   }
   // Check HR limits
   if (peakLocation < minHR || peakLocation > maxHR) {
     peakLocation = 0.0f;
+    confidence = 0;
   }
   // Reset spectral averaging if bad reading
   if (peakLocation == 0.0f) {
@@ -245,6 +227,7 @@ int Ppg::ProcessHeartRate(bool init) {
   int rtn = -1;
   if (peakLocation == 0.0f && lastPeakLocation > 0.0f) {
     lastPeakLocation = 0.0f;
+    confidence = 0;
   } else {
     lastPeakLocation = peakLocation;
     rtn = static_cast<int>((peakLocation * 60.0f) + 0.5f);
@@ -252,6 +235,148 @@ int Ppg::ProcessHeartRate(bool init) {
   return rtn;
 }
 
+// Resample the raw data on a regular grid (deltaTms) ending at the last sample, so that
+// acquisition jitter does not shift the frequency bins of the FFT.
+void Ppg::Resample(const std::array<uint16_t, dataLength>& data, std::array<float, dataLength>& signal) const {
+  const uint16_t lastTimestamp = dataTimestamps[dataLength - 1];
+  // Time of a sample relative to the last one (ms, <= 0)
+  auto sampleTime = [this, lastTimestamp](int idx) {
+    return -static_cast<int32_t>(static_cast<uint16_t>(lastTimestamp - dataTimestamps[idx]));
+  };
+
+  int src = 0;
+  for (int idx = 0; idx < dataLength; idx++) {
+    int32_t target = -static_cast<int32_t>(dataLength - 1 - idx) * deltaTms;
+    while (src < dataLength - 1 && sampleTime(src + 1) <= target) {
+      src++;
+    }
+    int32_t time0 = sampleTime(src);
+    if (src == dataLength - 1 || target <= time0) {
+      signal[idx] = data[src];
+      continue;
+    }
+    int32_t time1 = sampleTime(src + 1);
+    float mu = static_cast<float>(target - time0) / static_cast<float>(time1 - time0);
+    signal[idx] = data[src] * (1.0f - mu) + data[src + 1] * mu;
+  }
+}
+
+// Compute in place the magnitude spectrum of the signal in vReal
+void Ppg::ComputeSpectrum() {
+  Detrend(vReal);
+  Filter30to240(vReal);
+  vImag.fill(0.0f);
+  // Apply Hanning Window
+  int hannIdx = 0;
+  for (int idx = 0; idx < dataLength; idx++) {
+    if (idx >= dataLength >> 1) {
+      hannIdx--;
+    }
+    vReal[idx] *= hanning[hannIdx];
+    if (idx < dataLength >> 1) {
+      hannIdx++;
+    }
+  }
+  ArduinoFFT<float> FFT = ArduinoFFT<float>(vReal.data(), vImag.data(), dataLength, sampleFreq);
+  FFT.compute(FFTDirection::Forward);
+  FFT.complexToMagnitude();
+  FFT.~ArduinoFFT();
+}
+
+// Compute the acceleration spectrum of the window with the same processing as the PPG signal, so that the periodic
+// motion (step cadence, arm swing) leaking into the PPG signal can be identified by frequency.
+void Ppg::ProcessMotion() {
+  motionDetected = false;
+  auto range = std::minmax_element(dataAccel.begin(), dataAccel.end());
+  if (*range.second - *range.first < motionRangeThreshold) {
+    // Still wrist: skip the extra FFT
+    return;
+  }
+
+  Resample(dataAccel, vReal);
+  ComputeSpectrum();
+  std::copy(vReal.begin(), vReal.begin() + spectrumLength, motionSpectrum.begin());
+  motionMax = SpectrumMax(motionSpectrum, hrROIbegin, hrROIend);
+  motionDetected = motionMax > motionThreshold;
+}
+
+bool Ppg::IsMotionArtifact(const PeakCandidate& candidate) const {
+  if (!motionDetected) {
+    return false;
+  }
+  auto bin = static_cast<int>(candidate.location);
+  float motion = motionSpectrum[bin];
+  if (bin + 1 < spectrumLength) {
+    motion = std::max(motion, motionSpectrum[bin + 1]);
+  }
+  return motion >= motionBinRatio * motionMax;
+}
+
+// Select the heart rate (Hz) among the spectral peak candidates, 0 if none is valid.
+// Candidates are scored by amplitude, continuity with the tracked heart rate and harmonic relationships, and the
+// confidence reflects the margin between the two best candidates.
+float Ppg::SelectPeak(const std::array<PeakCandidate, maxPeakCandidates>& candidates, int nbCandidates, float max) {
+  int best = -1;
+  float bestScore = 0.0f;
+  float secondScore = 0.0f;
+  for (int idx = 0; idx < nbCandidates; idx++) {
+    float score = ScorePeak(candidates[idx], candidates, nbCandidates, max);
+    if (score > bestScore) {
+      secondScore = bestScore;
+      bestScore = score;
+      best = idx;
+    } else if (score > secondScore) {
+      secondScore = score;
+    }
+  }
+  if (best < 0) {
+    return 0.0f;
+  }
+
+  // Peak too wide? (broad spectrum noise or large, rapid HR change)
+  const PeakCandidate& peak = candidates[best];
+  int bin = static_cast<int>(peak.location + 0.5f);
+  if (PeakWidth(spectrum, bin, peakDetectionThreshold * spectrum[bin]) > maxPeakWidth) {
+    return 0.0f;
+  }
+
+  confidence = static_cast<uint8_t>(100.0f * (1.0f - secondScore / bestScore) + 0.5f);
+  return peak.location * freqResolution;
+}
+
+float Ppg::ScorePeak(const PeakCandidate& candidate,
+                     const std::array<PeakCandidate, maxPeakCandidates>& candidates,
+                     int nbCandidates,
+                     float max) const {
+  if (IsMotionArtifact(candidate)) {
+    return 0.0f;
+  }
+  float score = candidate.amplitude / max;
+
+  // Continuity with the tracked heart rate
+  if (lastPeakLocation > 0.0f) {
+    float deviation = (candidate.location * freqResolution - lastPeakLocation) / peakTrackingSpread;
+    score /= 1.0f + deviation * deviation;
+  }
+
+  for (int idx = 0; idx < nbCandidates; idx++) {
+    const PeakCandidate& other = candidates[idx];
+    if (&other == &candidate) {
+      continue;
+    }
+    // A strong subharmonic means the candidate is likely the second harmonic of the pulse
+    if (std::abs(2.0f * other.location - candidate.location) <= harmonicTolerance &&
+        other.amplitude >= subharmonicRatio * candidate.amplitude) {
+      score *= 0.5f;
+    }
+    // A visible harmonic supports the candidate as the fundamental
+    if (std::abs(2.0f * candidate.location - other.location) <= harmonicTolerance) {
+      score *= 1.25f;
+    }
+  }
+  return score;
+}
+
 void Ppg::SpectrumAverage(const float* data, float* spectrum, int length, bool reset) {
   if (reset) {
     spectralAvgCount = 0;
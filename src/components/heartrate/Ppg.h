@@ -14,14 +14,26 @@ namespace Pinetime {
     class Ppg {
     public:
       Ppg();
-      int8_t Preprocess(uint32_t hrs, uint32_t als);
+      // timestamp: acquisition time of the sample in milliseconds, may wrap around
+      // acceleration: magnitude of the acceleration at the same time (1g = 1024), used to reject motion artifacts
+      int8_t Preprocess(uint32_t hrs, uint32_t als, uint16_t timestamp, uint16_t acceleration);
       int HeartRate();
+      // Confidence (0-100) in the last heart rate returned by HeartRate()
+      uint8_t Confidence() const {
+        return confidence;
+      }
       void Reset(bool resetDaqBuffer);
       static constexpr int deltaTms = 100;
       // Daq dataLength: Must be power of 2
       static constexpr uint16_t dataLength = 64;
       static constexpr uint16_t spectrumLength = dataLength >> 1;
 
+      // Spectral peak, location in bins
+      struct PeakCandidate {
+        float location = 0.0f;
+        float amplitude = 0.0f;
+      };
+
     private:
       // The sampling frequency (Hz) based on sampling time in milliseconds (DeltaTms)
       static constexpr float sampleFreq = 1000.0f / static_cast<float>(deltaTms);
@@ -33,10 +45,20 @@ namespace Pinetime {
       // Maximum number of spectrum running averages
       // Note: actual number of spectra averaged = spectralAvgMax + 1
       static constexpr uint16_t spectralAvgMax = 2;
-      // Multiple Peaks above this threshold (% of max) are rejected
+      // Peaks above this threshold (% of max) are candidates for the heart rate
+      static constexpr float peakCandidateThreshold = 0.3f;
+      // Number of candidates kept in each window
+      static constexpr uint8_t maxPeakCandidates = 3;
+      // Width of a peak is measured at this threshold (% of the peak)
       static constexpr float peakDetectionThreshold = 0.6f;
       // Maximum peak width (bins) at threshold for valid peak.
       static constexpr float maxPeakWidth = 2.5f;
+      // Expected HR change (Hz) between two windows, candidates further from the tracked HR are penalized
+      static constexpr float peakTrackingSpread = 0.25f;
+      // Candidates closer than this (bins) to twice another candidate are considered its harmonic
+      static constexpr float harmonicTolerance = 1.0f;
+      // A candidate with a subharmonic candidate above this ratio (% of the candidate) is likely a harmonic
+      static constexpr float subharmonicRatio = 0.5f;
       // Metric for spectrum noise level.
       static constexpr float signalToNoiseThreshold = 3.0f;
       // Heart rate Region Of Interest begin (bins)
@@ -51,15 +73,27 @@ namespace Pinetime {
       static constexpr float dcThreshold = 0.5f;
       // ALS detection factor
       static constexpr float alsFactor = 2.0f;
+      // Acceleration range (1g = 1024) in a window below which the wrist is considered still
+      static constexpr uint16_t motionRangeThreshold = 40;
+      // Acceleration spectrum level in the HR region of interest above which motion artifacts are rejected
+      static constexpr float motionThreshold = 500.0f;
+      // Candidates on a bin where the acceleration spectrum is above this ratio (% of its max) are motion artifacts
+      static constexpr float motionBinRatio = 0.5f;
 
       // Raw ADC data
       std::array<uint16_t, dataLength> dataHRS;
+      // Acquisition time (ms) of each raw ADC sample
+      std::array<uint16_t, dataLength> dataTimestamps;
+      // Acceleration magnitude at the time of each raw ADC sample
+      std::array<uint16_t, dataLength> dataAccel;
       // Stores Real numbers from FFT
       std::array<float, dataLength> vReal;
       // Stores Imaginary numbers from FFT
       std::array<float, dataLength> vImag;
       // Stores power spectrum calculated from FFT real and imag values
       std::array<float, (spectrumLength)> spectrum;
+      // Acceleration spectrum of the current window, only valid if motionDetected is set
+      std::array<float, (spectrumLength)> motionSpectrum;
       // Stores each new HR value (Hz). Non zero values are averaged for HR output
       std::array<float, 20> dataAverage;
 
@@ -71,8 +105,20 @@ namespace Pinetime {
       uint16_t dataIndex = 0;
       float peakLocation;
       bool resetSpectralAvg = true;
+      uint8_t confidence = 0;
+      bool motionDetected = false;
+      float motionMax = 0.0f;
 
       int ProcessHeartRate(bool init);
+      void Resample(const std::array<uint16_t, dataLength>& data, std::array<float, dataLength>& signal) const;
+      void ComputeSpectrum();
+      void ProcessMotion();
+      bool IsMotionArtifact(const PeakCandidate& candidate) const;
+      float SelectPeak(const std::array<PeakCandidate, maxPeakCandidates>& candidates, int nbCandidates, float max);
+      float ScorePeak(const PeakCandidate& candidate,
+                      const std::array<PeakCandidate, maxPeakCandidates>& candidates,
+                      int nbCandidates,
+                      float max) const;
       float HeartRateAverage(float hr);
       void SpectrumAverage(const float* data, float* spectrum, int length, bool reset);
     };
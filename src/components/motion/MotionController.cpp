@@ -40,8 +40,12 @@ void MotionController::Update(int16_t x, int16_t y, int16_t z, uint32_t nbSteps)
     service->OnNewStepCountValue(nbSteps);
   }
 
-  if (service != nullptr && (xHistory[0] != x || yHistory[0] != y || zHistory[0] != z)) {
-    service->OnNewMotionValues(x, y, z);
+  if (service != nullptr) {
+    if (xHistory[0] != x || yHistory[0] != y || zHistory[0] != z) {
+      service->OnNewMotionValues(x, y, z);
+    } else {
+      service->FlushMotionValues();
+    }
   }
 
   lastTime = time;
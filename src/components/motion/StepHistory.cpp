@@ -0,0 +1,329 @@
+#include "components/motion/StepHistory.h"
+#include <algorithm>
+#include "components/fs/FS.h"
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  constexpr const char* historyFileName = "/steps.dat";
+  constexpr uint8_t minutesPerHour = 60;
+
+  size_t EncodeVarint(uint16_t value, uint8_t* buffer) {
+    size_t length = 0;
+    while (value >= 0x80) {
+      buffer[length++] = static_cast<uint8_t>(value | 0x80);
+      value >>= 7;
+    }
+    buffer[length++] = static_cast<uint8_t>(value);
+    return length;
+  }
+
+  uint16_t DecodeVarint(const uint8_t* buffer, size_t& position, size_t end) {
+    uint16_t value = 0;
+    uint8_t shift = 0;
+    while (position < end) {
+      uint8_t byte = buffer[position++];
+      value |= static_cast<uint16_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        break;
+      }
+      shift += 7;
+    }
+    return value;
+  }
+
+  uint16_t SaturatingAdd(uint16_t value, uint32_t delta) {
+    return static_cast<uint16_t>(std::min<uint32_t>(value + delta, UINT16_MAX));
+  }
+}
+
+StepHistory::StepHistory(Controllers::FS& fs) : fs {fs} {
+}
+
+void StepHistory::Init() {
+  lfs_file_t historyFile;
+  if (fs.FileOpen(&historyFile, historyFileName, LFS_O_RDONLY) != LFS_ERR_OK) {
+    return;
+  }
+
+  DayRecord record;
+  for (uint8_t slot = 0; slot < nbDays; slot++) {
+    if (fs.FileRead(&historyFile, reinterpret_cast<uint8_t*>(&record), sizeof(record)) != sizeof(record)) {
+      break;
+    }
+    if (record.version != fileVersion || record.day == noDay) {
+      continue;
+    }
+    // The most recent record may be today's, which is only known once the time is available
+    if (record.day > lastRecord.day) {
+      std::swap(record, lastRecord);
+    }
+    if (record.day != noDay) {
+      uint32_t steps = 0;
+      for (auto hourSteps : record.hourly) {
+        steps += hourSteps;
+      }
+      AddPastDay(record.day, steps);
+    }
+  }
+  fs.FileClose(&historyFile);
+}
+
+void StepHistory::Update(uint16_t day, uint16_t minuteOfDay, uint32_t stepCounter) {
+  if (minuteOfDay >= minutesPerDay) {
+    return;
+  }
+
+  if (day != today && (day < firstValidDay || day < LatestDay())) {
+    if (today == noDay) {
+      // The step counter keeps the steps until a day can be started
+      return;
+    }
+    // Keep counting in the current day instead of overwriting the history
+    day = today;
+    minuteOfDay = pendingMinute;
+  }
+
+  if (day != today) {
+    if (today != noDay) {
+      // A day that finished before the previous one was saved is written now so that it isn't lost
+      if (finishedRecordPending) {
+        WriteRecord(finishedRecord);
+      }
+      FlushPendingMinute();
+      finishedRecord = CurrentRecord();
+      finishedRecordPending = true;
+      AddPastDay(today, StepsToday());
+    }
+    StartDay(day);
+
+    if (lastRecord.day != noDay) {
+      if (lastRecord.day == day) {
+        hourlySteps = lastRecord.hourly;
+      } else if (lastRecord.day < day) {
+        uint32_t steps = 0;
+        for (auto hourSteps : lastRecord.hourly) {
+          steps += hourSteps;
+        }
+        AddPastDay(lastRecord.day, steps);
+      }
+      lastRecord.day = noDay;
+    }
+  }
+
+  // The step counter of the motion sensor is reset at midnight
+  uint32_t deltaSteps = (stepCounter >= lastStepCounter) ? stepCounter - lastStepCounter : stepCounter;
+  lastStepCounter = stepCounter;
+
+  if (minuteOfDay != pendingMinute) {
+    if (minuteOfDay / minutesPerHour != pendingMinute / minutesPerHour) {
+      historyChanged = true;
+    }
+    FlushPendingMinute();
+    pendingMinute = minuteOfDay;
+  }
+
+  if (deltaSteps > 0) {
+    pendingSteps = SaturatingAdd(pendingSteps, deltaSteps);
+    hourlySteps[minuteOfDay / minutesPerHour] = SaturatingAdd(hourlySteps[minuteOfDay / minutesPerHour], deltaSteps);
+  }
+}
+
+void StepHistory::SaveHistory() {
+  if (!historyChanged) {
+    return;
+  }
+
+  if (finishedRecordPending) {
+    WriteRecord(finishedRecord);
+    finishedRecordPending = false;
+  }
+  if (today != noDay) {
+    WriteRecord(CurrentRecord());
+  }
+  historyChanged = false;
+}
+
+uint32_t StepHistory::StepsToday() const {
+  uint32_t steps = 0;
+  for (auto hourSteps : hourlySteps) {
+    steps += hourSteps;
+  }
+  return steps;
+}
+
+uint32_t StepHistory::StepsInHour(uint8_t hour) const {
+  if (hour >= hoursPerDay) {
+    return 0;
+  }
+  return hourlySteps[hour];
+}
+
+uint32_t StepHistory::StepsBetween(uint16_t firstMinute, uint16_t lastMinute) const {
+  lastMinute = std::min(lastMinute, minutesPerDay);
+  if (firstMinute >= lastMinute) {
+    return 0;
+  }
+
+  uint32_t steps = 0;
+  for (uint8_t hour = firstMinute / minutesPerHour; hour <= (lastMinute - 1) / minutesPerHour; hour++) {
+    uint16_t hourStart = hour * minutesPerHour;
+    if (firstMinute <= hourStart && lastMinute >= hourStart + minutesPerHour) {
+      steps += hourlySteps[hour];
+      continue;
+    }
+
+    // Partial hour: walk the minute stream of this hour
+    if (hour <= streamHour) {
+      size_t position = hourOffsets[hour];
+      size_t end = (hour < streamHour) ? hourOffsets[hour + 1] : minuteDataUsed;
+      uint16_t minute = hourStart;
+      while (position < end) {
+        minute += DecodeVarint(minuteData.data(), position, end);
+        uint16_t minuteSteps = DecodeVarint(minuteData.data(), position, end);
+        if (minute >= firstMinute && minute < lastMinute) {
+          steps += minuteSteps;
+        }
+      }
+    }
+    if (pendingSteps > 0 && pendingMinute / minutesPerHour == hour && pendingMinute >= firstMinute && pendingMinute < lastMinute) {
+      steps += pendingSteps;
+    }
+  }
+  return steps;
+}
+
+uint32_t StepHistory::StepsOverDays(uint16_t firstDay, uint16_t lastDay) const {
+  if (firstDay > lastDay) {
+    return 0;
+  }
+
+  auto begin = pastDays.begin();
+  auto end = pastDays.begin() + nbPastDays;
+  auto first = std::lower_bound(begin, end, firstDay, [](const DayTotal& total, uint16_t day) {
+    return total.day < day;
+  });
+  auto last = std::upper_bound(begin, end, lastDay, [](uint16_t day, const DayTotal& total) {
+    return day < total.day;
+  });
+  uint32_t steps = prefix[last - begin] - prefix[first - begin];
+
+  if (today != noDay && today >= firstDay && today <= lastDay) {
+    steps += StepsToday();
+  }
+  return steps;
+}
+
+uint32_t StepHistory::StepsThisWeek() const {
+  // The epoch (day 0) is a thursday
+  uint8_t daysSinceMonday = (today + 3) % 7;
+  if (today < daysSinceMonday) {
+    return StepsToday();
+  }
+  return StepsOverDays(today - daysSinceMonday, today);
+}
+
+uint16_t StepHistory::LatestDay() const {
+  if (today != noDay) {
+    return today;
+  }
+  uint16_t day = lastRecord.day;
+  if (nbPastDays > 0) {
+    day = std::max(day, pastDays[nbPastDays - 1].day);
+  }
+  return day;
+}
+
+void StepHistory::StartDay(uint16_t day) {
+  today = day;
+  hourlySteps.fill(0);
+  hourOffsets.fill(0);
+  minuteDataUsed = 0;
+  streamHour = 0;
+  lastMinuteInHour = 0;
+  pendingMinute = 0;
+  pendingSteps = 0;
+  historyChanged = true;
+}
+
+void StepHistory::FlushPendingMinute() {
+  if (pendingSteps > 0) {
+    AppendMinute(pendingMinute, pendingSteps);
+    pendingSteps = 0;
+  }
+}
+
+void StepHistory::AppendMinute(uint16_t minuteOfDay, uint16_t steps) {
+  uint8_t hour = minuteOfDay / minutesPerHour;
+  uint8_t minuteInHour = minuteOfDay % minutesPerHour;
+
+  if (hour > streamHour) {
+    for (uint8_t h = streamHour + 1; h <= hour; h++) {
+      hourOffsets[h] = minuteDataUsed;
+    }
+    streamHour = hour;
+    lastMinuteInHour = 0;
+  } else if (hour < streamHour || minuteInHour < lastMinuteInHour) {
+    // The time went backward, only the hourly counters are kept
+    return;
+  }
+
+  // Minutes are encoded relative to the previous entry of the same hour so that each hour can be decoded on its own
+  uint8_t entry[6];
+  size_t length = EncodeVarint(minuteInHour - lastMinuteInHour, entry);
+  length += EncodeVarint(steps, entry + length);
+  if (minuteDataUsed + length > minuteData.size()) {
+    return;
+  }
+  std::copy(entry, entry + length, minuteData.begin() + minuteDataUsed);
+  minuteDataUsed += length;
+  lastMinuteInHour = minuteInHour;
+}
+
+void StepHistory::AddPastDay(uint16_t day, uint32_t steps) {
+  auto begin = pastDays.begin();
+  auto end = pastDays.begin() + nbPastDays;
+  auto it = std::lower_bound(begin, end, day, [](const DayTotal& total, uint16_t d) {
+    return total.day < d;
+  });
+
+  if (it != end && it->day == day) {
+    it->steps = steps;
+  } else if (nbPastDays < nbDays) {
+    std::move_backward(it, end, end + 1);
+    *it = {day, steps};
+    nbPastDays++;
+  } else if (it != begin) {
+    // Full: drop the oldest day
+    std::move(begin + 1, it, begin);
+    *(it - 1) = {day, steps};
+  } else {
+    return;
+  }
+  UpdatePrefix();
+}
+
+void StepHistory::UpdatePrefix() {
+  prefix[0] = 0;
+  for (size_t i = 0; i < nbPastDays; i++) {
+    prefix[i + 1] = prefix[i] + pastDays[i].steps;
+  }
+}
+
+StepHistory::DayRecord StepHistory::CurrentRecord() const {
+  DayRecord record;
+  record.day = today;
+  record.version = fileVersion;
+  record.hourly = hourlySteps;
+  return record;
+}
+
+void StepHistory::WriteRecord(const DayRecord& record) {
+  lfs_file_t historyFile;
+  if (fs.FileOpen(&historyFile, historyFileName, LFS_O_RDWR | LFS_O_CREAT) != LFS_ERR_OK) {
+    return;
+  }
+  fs.FileSeek(&historyFile, (record.day % nbDays) * sizeof(DayRecord));
+  fs.FileWrite(&historyFile, reinterpret_cast<const uint8_t*>(&record), sizeof(record));
+  fs.FileClose(&historyFile);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Controllers {
+    class FS;
+
+    /*
+     * Keeps the step history of the watch.
+     *
+     * Today's steps are kept in RAM with a minute resolution: each minute with at least one step is appended to a
+     * stream of varint-encoded (minute delta, steps) pairs, indexed per hour. Hourly totals are always exact, even if
+     * the minute stream runs out of space.
+     *
+     * Each day is rolled into a fixed-size daily block (24 hourly counters) in a ring file in the filesystem, one slot
+     * per day. The daily totals of the last nbDays days are mirrored in RAM with prefix sums so that range queries only
+     * cost two binary searches.
+     *
+     * Days are counted since the epoch in local time. The day only changes once the time is valid: while the clock isn't
+     * set (it restarts at the epoch after a power loss) or when it goes back before the most recent day of the history,
+     * the steps are still added to the current day, or kept by the step counter until the time is set if no day
+     * started yet.
+     */
+    class StepHistory {
+    public:
+      static constexpr uint8_t nbDays = 30;
+      static constexpr uint8_t hoursPerDay = 24;
+      static constexpr uint16_t minutesPerDay = 24 * 60;
+
+      struct DayTotal {
+        uint16_t day;
+        uint32_t steps;
+      };
+
+      explicit StepHistory(Controllers::FS& fs);
+
+      void Init();
+      void Update(uint16_t day, uint16_t minuteOfDay, uint32_t stepCounter);
+      void SaveHistory();
+
+      uint16_t Today() const {
+        return today;
+      }
+
+      uint32_t StepsToday() const;
+      uint32_t StepsInHour(uint8_t hour) const;
+      // Steps today in the range [firstMinute, lastMinute)
+      uint32_t StepsBetween(uint16_t firstMinute, uint16_t lastMinute) const;
+      // Steps in the range of days [firstDay, lastDay], today included
+      uint32_t StepsOverDays(uint16_t firstDay, uint16_t lastDay) const;
+      // Steps since monday, today included
+      uint32_t StepsThisWeek() const;
+
+      // Completed days, oldest first
+      size_t NbPastDays() const {
+        return nbPastDays;
+      }
+
+      const DayTotal& PastDay(size_t index) const {
+        return pastDays[index];
+      }
+
+    private:
+      static constexpr size_t minuteDataSize = 768;
+      static constexpr uint8_t fileVersion = 1;
+      static constexpr uint16_t noDay = 0;
+      // 2021-01-01, earlier days come from a clock that wasn't set
+      static constexpr uint16_t firstValidDay = 18628;
+
+      struct DayRecord {
+        uint16_t day;
+        uint16_t version;
+        std::array<uint16_t, hoursPerDay> hourly;
+      };
+
+      Controllers::FS& fs;
+
+      uint16_t today = noDay;
+      uint32_t lastStepCounter = 0;
+
+      // Today's hourly counters and minute stream
+      std::array<uint16_t, hoursPerDay> hourlySteps {};
+      std::array<uint16_t, hoursPerDay> hourOffsets {};
+      std::array<uint8_t, minuteDataSize> minuteData {};
+      size_t minuteDataUsed = 0;
+      uint8_t streamHour = 0;
+      uint8_t lastMinuteInHour = 0;
+      uint16_t pendingMinute = 0;
+      uint16_t pendingSteps = 0;
+
+      // Completed days, sorted by day, with prefix sums (prefix[i] = sum of steps of days [0, i))
+      std::array<DayTotal, nbDays> pastDays {};
+      std::array<uint32_t, nbDays + 1> prefix {};
+      size_t nbPastDays = 0;
+
+      // Record loaded from the filesystem that may belong to today, restored by the first Update()
+      DayRecord lastRecord {};
+      // Completed day waiting to be written to the filesystem
+      DayRecord finishedRecord {};
+      bool finishedRecordPending = false;
+      bool historyChanged = false;
+
+      uint16_t LatestDay() const;
+      void StartDay(uint16_t day);
+      void FlushPendingMinute();
+      void AppendMinute(uint16_t minuteOfDay, uint16_t steps);
+      void AddPastDay(uint16_t day, uint32_t steps);
+      void UpdatePrefix();
+      DayRecord CurrentRecord() const;
+      void WriteRecord(const DayRecord& record);
+    };
+  }
+}
@@ -0,0 +1,266 @@
+#include "components/scheduler/Scheduler.h"
+#include <task.h>
+#include <algorithm>
+#include "components/datetime/DateTimeController.h"
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  // Deadlines are compared relative to each other so that the tick counter can wrap around
+  bool TickBefore(TickType_t a, TickType_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+  }
+}
+
+Scheduler::Scheduler(DateTime& dateTimeController) : dateTimeController {dateTimeController} {
+  timer = xTimerCreate("scheduler", 1, pdFALSE, this, TimerCallback);
+}
+
+Scheduler::Id Scheduler::ScheduleIn(TickType_t delay, TickType_t slack, Callback callback, void* context) {
+  Entry entry;
+  entry.callback = callback;
+  entry.context = context;
+  entry.deadline = xTaskGetTickCount() + delay;
+  entry.slack = slack;
+  return Add(entry);
+}
+
+Scheduler::Id Scheduler::SchedulePeriodic(TickType_t period, TickType_t slack, Callback callback, void* context) {
+  Entry entry;
+  entry.callback = callback;
+  entry.context = context;
+  entry.deadline = xTaskGetTickCount() + period;
+  entry.slack = slack;
+  entry.period = period;
+  return Add(entry);
+}
+
+Scheduler::Id Scheduler::ScheduleAt(LocalTime localTime, TickType_t slack, Callback callback, void* context) {
+  Entry entry;
+  entry.callback = callback;
+  entry.context = context;
+  entry.deadline = WallClockDeadline(localTime, xTaskGetTickCount());
+  entry.slack = slack;
+  entry.localTime = localTime;
+  entry.wallClock = true;
+  return Add(entry);
+}
+
+void Scheduler::Cancel(Id id) {
+  taskENTER_CRITICAL();
+  int index = Find(id);
+  if (index >= 0) {
+    Remove(entries[index].heapIndex);
+  }
+  taskEXIT_CRITICAL();
+  Arm();
+}
+
+bool Scheduler::IsScheduled(Id id) const {
+  return Find(id) >= 0;
+}
+
+TickType_t Scheduler::TicksRemaining(Id id) const {
+  taskENTER_CRITICAL();
+  int index = Find(id);
+  TickType_t remaining = 0;
+  if (index >= 0) {
+    auto ticks = static_cast<int32_t>(entries[index].deadline - xTaskGetTickCount());
+    remaining = (ticks > 0) ? ticks : 0;
+  }
+  taskEXIT_CRITICAL();
+  return remaining;
+}
+
+void Scheduler::OnTimeChanged() {
+  TickType_t now = xTaskGetTickCount();
+  taskENTER_CRITICAL();
+  for (uint8_t i = 0; i < heapSize; i++) {
+    Entry& entry = entries[heap[i]];
+    if (entry.wallClock) {
+      entry.deadline = WallClockDeadline(entry.localTime, now);
+    }
+  }
+  for (int i = heapSize / 2 - 1; i >= 0; i--) {
+    SiftDown(i);
+  }
+  taskEXIT_CRITICAL();
+  Arm();
+}
+
+void Scheduler::TimerCallback(TimerHandle_t xTimer) {
+  auto* scheduler = static_cast<Scheduler*>(pvTimerGetTimerID(xTimer));
+  scheduler->Dispatch();
+}
+
+// Run the callbacks of all the entries whose deadline is reached, then arm the timer for the next ones
+void Scheduler::Dispatch() {
+  while (true) {
+    TickType_t now = xTaskGetTickCount();
+    Callback callback = nullptr;
+    void* context = nullptr;
+
+    taskENTER_CRITICAL();
+    if (heapSize > 0 && !TickBefore(now, entries[heap[0]].deadline)) {
+      uint8_t index = heap[0];
+      Entry& entry = entries[index];
+      if (entry.wallClock && dateTimeController.Now() < entry.localTime) {
+        // Not there yet: the deadline was clamped to maxDelay, or the clock drifted from the tick counter
+        entry.deadline = WallClockDeadline(entry.localTime, now);
+        SiftDown(0);
+      } else {
+        callback = entry.callback;
+        context = entry.context;
+        if (entry.period > 0) {
+          entry.deadline += entry.period;
+          if (!TickBefore(now, entry.deadline)) {
+            entry.deadline = now + entry.period;
+          }
+          SiftDown(0);
+        } else {
+          Remove(0);
+        }
+      }
+    }
+    bool pending = heapSize > 0 && !TickBefore(now, entries[heap[0]].deadline);
+    taskEXIT_CRITICAL();
+
+    if (callback != nullptr) {
+      callback(context);
+    } else if (!pending) {
+      break;
+    }
+  }
+  Arm();
+}
+
+Scheduler::Id Scheduler::Add(const Entry& entry) {
+  taskENTER_CRITICAL();
+  uint8_t index = 0;
+  while (index < maxEntries && entries[index].heapIndex != noEntry) {
+    index++;
+  }
+  if (index == maxEntries) {
+    taskEXIT_CRITICAL();
+    return invalidId;
+  }
+
+  uint8_t generation = entries[index].generation + 1;
+  entries[index] = entry;
+  entries[index].generation = generation;
+  entries[index].heapIndex = heapSize;
+  heap[heapSize] = index;
+  SiftUp(heapSize);
+  heapSize++;
+  taskEXIT_CRITICAL();
+
+  Arm();
+  return static_cast<Id>((generation << 8) | (index + 1));
+}
+
+int Scheduler::Find(Id id) const {
+  int index = (id & 0xff) - 1;
+  if (index < 0 || index >= maxEntries) {
+    return -1;
+  }
+  const Entry& entry = entries[index];
+  if (entry.heapIndex == noEntry || entry.generation != (id >> 8)) {
+    return -1;
+  }
+  return index;
+}
+
+TickType_t Scheduler::WallClockDeadline(LocalTime localTime, TickType_t now) const {
+  auto milliseconds = (localTime - dateTimeController.Now()).count();
+  if (milliseconds <= 0) {
+    return now;
+  }
+  // Rounded up, so that the deadline is never before the local time
+  auto ticks = (static_cast<uint64_t>(milliseconds) * configTICK_RATE_HZ + 999) / 1000;
+  return now + static_cast<TickType_t>(std::min<uint64_t>(ticks, maxDelay));
+}
+
+bool Scheduler::Before(uint8_t a, uint8_t b) const {
+  return TickBefore(entries[heap[a]].deadline, entries[heap[b]].deadline);
+}
+
+void Scheduler::Swap(uint8_t a, uint8_t b) {
+  std::swap(heap[a], heap[b]);
+  entries[heap[a]].heapIndex = a;
+  entries[heap[b]].heapIndex = b;
+}
+
+void Scheduler::SiftUp(uint8_t index) {
+  while (index > 0) {
+    uint8_t parent = (index - 1) / 2;
+    if (!Before(index, parent)) {
+      break;
+    }
+    Swap(index, parent);
+    index = parent;
+  }
+}
+
+void Scheduler::SiftDown(uint8_t index) {
+  while (true) {
+    uint8_t smallest = index;
+    uint8_t left = 2 * index + 1;
+    uint8_t right = left + 1;
+    if (left < heapSize && Before(left, smallest)) {
+      smallest = left;
+    }
+    if (right < heapSize && Before(right, smallest)) {
+      smallest = right;
+    }
+    if (smallest == index) {
+      break;
+    }
+    Swap(index, smallest);
+    index = smallest;
+  }
+}
+
+void Scheduler::Remove(uint8_t index) {
+  entries[heap[index]].heapIndex = noEntry;
+  heapSize--;
+  if (index == heapSize) {
+    return;
+  }
+  heap[index] = heap[heapSize];
+  entries[heap[index]].heapIndex = index;
+  SiftDown(index);
+  SiftUp(index);
+}
+
+// Arm the timer for the latest time that satisfies the slack of every entry
+void Scheduler::Arm() {
+  taskENTER_CRITICAL();
+  bool empty = heapSize == 0;
+  TickType_t wakeup = 0;
+  for (uint8_t i = 0; i < heapSize; i++) {
+    const Entry& entry = entries[heap[i]];
+    TickType_t latest = entry.deadline + entry.slack;
+    if (i == 0 || TickBefore(latest, wakeup)) {
+      wakeup = latest;
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  // The timer task empties the command queue, so it can't wait for room in it: if the queue is full, the command is
+  // sent again by Poll()
+  TickType_t timeout = (xTaskGetCurrentTaskHandle() == xTimerGetTimerDaemonTaskHandle()) ? 0 : armTimeout;
+  BaseType_t result;
+  if (empty) {
+    result = xTimerStop(timer, timeout);
+  } else {
+    auto delay = static_cast<int32_t>(wakeup - xTaskGetTickCount());
+    result = xTimerChangePeriod(timer, (delay > 0) ? delay : 1, timeout);
+  }
+  armPending = (result != pdPASS);
+}
+
+void Scheduler::Poll() {
+  if (armPending) {
+    Arm();
+  }
+}
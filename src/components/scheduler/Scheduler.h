@@ -0,0 +1,93 @@
+#pragma once
+
+#include <FreeRTOS.h>
+#include <timers.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Controllers {
+    class DateTime;
+
+    /*
+     * Runs callbacks at deadlines, using a single FreeRTOS timer armed for the earliest one.
+     *
+     * Deadlines are either monotonic (ticks from now, optionally periodic) or wall-clock (local time), the latter being
+     * recomputed when the time is changed. Each deadline has a slack: the callback may run up to slack ticks late, so
+     * that deadlines close to each other are handled in a single wakeup.
+     *
+     * Callbacks run in the context of the FreeRTOS timer task and must not block.
+     */
+    class Scheduler {
+    public:
+      using Callback = void (*)(void* context);
+      using Id = uint16_t;
+      using LocalTime = std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds>;
+
+      static constexpr Id invalidId = 0;
+      static constexpr uint8_t maxEntries = 12;
+
+      explicit Scheduler(DateTime& dateTimeController);
+
+      Id ScheduleIn(TickType_t delay, TickType_t slack, Callback callback, void* context);
+      Id SchedulePeriodic(TickType_t period, TickType_t slack, Callback callback, void* context);
+      Id ScheduleAt(LocalTime localTime, TickType_t slack, Callback callback, void* context);
+      void Cancel(Id id);
+
+      bool IsScheduled(Id id) const;
+      TickType_t TicksRemaining(Id id) const;
+
+      // Must be called when the time is changed, to move the wall-clock deadlines
+      void OnTimeChanged();
+
+      // Arms the timer again if the last command couldn't be sent to the timer task (its command queue was full).
+      // Called periodically by SystemTask.
+      void Poll();
+
+    private:
+      // Wall-clock deadlines further away are checked again when this delay elapses. Computed without pdMS_TO_TICKS(),
+      // whose intermediate value (ms * tick rate) would overflow.
+      static constexpr TickType_t maxDelay = 24 * 60 * 60 * configTICK_RATE_HZ;
+      static_assert(maxDelay / configTICK_RATE_HZ == 24 * 60 * 60 && maxDelay < INT32_MAX,
+                    "Deadlines are compared as signed differences of ticks");
+      // Time given to other tasks to send the commands of the timer when its queue is full
+      static constexpr TickType_t armTimeout = pdMS_TO_TICKS(10);
+      static constexpr uint8_t noEntry = 0xff;
+
+      struct Entry {
+        Callback callback = nullptr;
+        void* context = nullptr;
+        TickType_t deadline = 0;
+        TickType_t slack = 0;
+        TickType_t period = 0;
+        LocalTime localTime {};
+        bool wallClock = false;
+        uint8_t generation = 0;
+        uint8_t heapIndex = noEntry;
+      };
+
+      DateTime& dateTimeController;
+      TimerHandle_t timer;
+
+      std::array<Entry, maxEntries> entries;
+      // Min-heap of the indices of the active entries, ordered by deadline
+      std::array<uint8_t, maxEntries> heap;
+      uint8_t heapSize = 0;
+      std::atomic<bool> armPending {false};
+
+      static void TimerCallback(TimerHandle_t xTimer);
+      void Dispatch();
+      Id Add(const Entry& entry);
+      int Find(Id id) const;
+      TickType_t WallClockDeadline(LocalTime localTime, TickType_t now) const;
+      bool Before(uint8_t a, uint8_t b) const;
+      void Swap(uint8_t a, uint8_t b);
+      void SiftUp(uint8_t index);
+      void SiftDown(uint8_t index);
+      void Remove(uint8_t index);
+      void Arm();
+    };
+  }
+}
@@ -2,27 +2,28 @@
 
 using namespace Pinetime::Controllers;
 
-Timer::Timer(void* const timerData, TimerCallbackFunction_t timerCallbackFunction) {
-  timer = xTimerCreate("Timer", 1, pdFALSE, timerData, timerCallbackFunction);
+Timer::Timer(Scheduler& scheduler, void* const timerData, Scheduler::Callback timerCallbackFunction)
+  : scheduler {scheduler}, timerData {timerData}, timerCallbackFunction {timerCallbackFunction} {
 }
 
 void Timer::StartTimer(std::chrono::milliseconds duration) {
-  xTimerChangePeriod(timer, pdMS_TO_TICKS(duration.count()), 0);
-  xTimerStart(timer, 0);
+  scheduler.Cancel(timer);
+  timer = scheduler.ScheduleIn(pdMS_TO_TICKS(duration.count()), 0, timerCallbackFunction, timerData);
 }
 
 std::chrono::milliseconds Timer::GetTimeRemaining() {
   if (IsRunning()) {
-    TickType_t remainingTime = xTimerGetExpiryTime(timer) - xTaskGetTickCount();
+    TickType_t remainingTime = scheduler.TicksRemaining(timer);
     return std::chrono::milliseconds(remainingTime * 1000 / configTICK_RATE_HZ);
   }
   return std::chrono::milliseconds(0);
 }
 
 void Timer::StopTimer() {
-  xTimerStop(timer, 0);
+  scheduler.Cancel(timer);
+  timer = Scheduler::invalidId;
 }
 
 bool Timer::IsRunning() {
-  return (xTimerIsTimerActive(timer) == pdTRUE);
+  return scheduler.IsScheduled(timer);
 }
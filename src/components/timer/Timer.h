@@ -1,15 +1,16 @@
 #pragma once
 
 #include <FreeRTOS.h>
-#include <timers.h>
 
 #include <chrono>
 
+#include "components/scheduler/Scheduler.h"
+
 namespace Pinetime {
   namespace Controllers {
     class Timer {
     public:
-      Timer(void* timerData, TimerCallbackFunction_t timerCallbackFunction);
+      Timer(Scheduler& scheduler, void* timerData, Scheduler::Callback timerCallbackFunction);
 
       void StartTimer(std::chrono::milliseconds duration);
 
@@ -20,7 +21,10 @@ namespace Pinetime {
       bool IsRunning();
 
     private:
-      TimerHandle_t timer;
+      Scheduler& scheduler;
+      void* timerData;
+      Scheduler::Callback timerCallbackFunction;
+      Scheduler::Id timer = Scheduler::invalidId;
     };
   }
 }
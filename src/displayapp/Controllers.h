@@ -15,9 +15,11 @@ namespace Pinetime {
     class DateTime;
     class NotificationManager;
     class HeartRateController;
+    class HeartRateHistory;
     class Settings;
     class MotorController;
     class MotionController;
+    class StepHistory;
     class AlarmController;
     class BrightnessController;
     class SimpleWeatherService;
@@ -38,9 +40,11 @@ namespace Pinetime {
       Pinetime::Controllers::DateTime& dateTimeController;
       Pinetime::Controllers::NotificationManager& notificationManager;
       Pinetime::Controllers::HeartRateController& heartRateController;
+      Pinetime::Controllers::HeartRateHistory& heartRateHistory;
       Pinetime::Controllers::Settings& settingsController;
       Pinetime::Controllers::MotorController& motorController;
       Pinetime::Controllers::MotionController& motionController;
+      Pinetime::Controllers::StepHistory& stepHistory;
       Pinetime::Controllers::AlarmController& alarmController;
       Pinetime::Controllers::BrightnessController& brightnessController;
       Pinetime::Controllers::SimpleWeatherService* weatherController;
@@ -31,6 +31,9 @@
 #include "displayapp/screens/PassKey.h"
 #include "displayapp/screens/Error.h"
 #include "displayapp/screens/DoubleTimer.h"
+#include "displayapp/screens/Label.h"
+#include "displayapp/screens/List.h"
+#include "displayapp/screens/CheckboxList.h"
 
 #include "drivers/Cst816s.h"
 #include "drivers/St7789.h"
@@ -50,6 +53,8 @@
 #include "displayapp/screens/settings/SettingChimes.h"
 #include "displayapp/screens/settings/SettingShakeThreshold.h"
 #include "displayapp/screens/settings/SettingBluetooth.h"
+#include "displayapp/screens/settings/SettingSetDate.h"
+#include "displayapp/screens/settings/SettingSetTime.h"
 
 #include "libs/lv_conf.h"
 #include "UserApps.h"
@@ -62,10 +67,55 @@ namespace {
     return (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) != 0;
   }
 
-  void TimerCallback(TimerHandle_t xTimer) {
-    auto* dispApp = static_cast<DisplayApp*>(pvTimerGetTimerID(xTimer));
+  void TimerCallback(void* instance) {
+    auto* dispApp = static_cast<DisplayApp*>(instance);
     dispApp->PushMessage(Display::Messages::TimerDone);
   }
+
+  // Screens loaded by DisplayApp itself, besides the apps and the watch faces
+  constexpr size_t systemScreenSize = std::max({sizeof(Screens::ApplicationList),
+                                                sizeof(Screens::Error),
+                                                sizeof(Screens::FirmwareValidation),
+                                                sizeof(Screens::FirmwareUpdate),
+                                                sizeof(Screens::PassKey),
+                                                sizeof(Screens::Notifications),
+                                                sizeof(Screens::QuickSettings),
+                                                sizeof(Screens::Settings),
+                                                sizeof(Screens::SettingWatchFace),
+                                                sizeof(Screens::SettingTimeFormat),
+                                                sizeof(Screens::SettingWeatherFormat),
+                                                sizeof(Screens::SettingWakeUp),
+                                                sizeof(Screens::SettingDisplay),
+                                                sizeof(Screens::SettingSteps),
+                                                sizeof(Screens::SettingSetDateTime),
+                                                sizeof(Screens::SettingChimes),
+                                                sizeof(Screens::SettingShakeThreshold),
+                                                sizeof(Screens::SettingBluetooth),
+                                                sizeof(Screens::BatteryInfo),
+                                                sizeof(Screens::SystemInfo),
+                                                sizeof(Screens::FlashLight)});
+
+  // Pages of a ScreenList, allocated on top of the screen that owns them
+  constexpr size_t nestedScreenSize = std::max({sizeof(Screens::Label),
+                                                sizeof(Screens::List),
+                                                sizeof(Screens::Tile),
+                                                sizeof(Screens::CheckboxList),
+                                                sizeof(Screens::SettingSetDate),
+                                                sizeof(Screens::SettingSetTime)});
+
+  // Apps shown on top of the watch face, which is then kept alive (see DisplayApp::KeepWatchFace())
+  constexpr size_t overlayScreenSize =
+    std::max({sizeof(Screens::ApplicationList), sizeof(Screens::Notifications), sizeof(Screens::QuickSettings)});
+
+  // LVGL memory that must be left for the overlay to keep the watch face
+  constexpr uint32_t minLvglFreeToKeepWatchFace = 6 * 1024;
+
+  constexpr size_t screenArenaSize =
+    std::max(std::max({systemScreenSize, MaxScreenSize(userApps), MaxScreenSize(userWatchFaces)}),
+             MaxScreenSize(userWatchFaces) + overlayScreenSize) +
+    nestedScreenSize + 3 * alignof(std::max_align_t);
+
+  alignas(std::max_align_t) uint8_t screenArenaBuffer[screenArenaSize];
 }
 
 DisplayApp::DisplayApp(Drivers::St7789& lcd,
@@ -76,10 +126,13 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
                        const Drivers::Watchdog& watchdog,
                        Pinetime::Controllers::NotificationManager& notificationManager,
                        Pinetime::Controllers::HeartRateController& heartRateController,
+                       Pinetime::Controllers::HeartRateHistory& heartRateHistory,
                        Controllers::Settings& settingsController,
                        Pinetime::Controllers::MotorController& motorController,
                        Pinetime::Controllers::MotionController& motionController,
+                       Pinetime::Controllers::StepHistory& stepHistory,
                        Pinetime::Controllers::AlarmController& alarmController,
+                       Pinetime::Controllers::Scheduler& scheduler,
                        Pinetime::Controllers::BrightnessController& brightnessController,
                        Pinetime::Controllers::TouchHandler& touchHandler,
                        Pinetime::Controllers::FS& filesystem)
@@ -91,23 +144,27 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
     watchdog {watchdog},
     notificationManager {notificationManager},
     heartRateController {heartRateController},
+    heartRateHistory {heartRateHistory},
     settingsController {settingsController},
     motorController {motorController},
     motionController {motionController},
+    stepHistory {stepHistory},
     alarmController {alarmController},
     brightnessController {brightnessController},
     touchHandler {touchHandler},
     filesystem {filesystem},
     lvgl {lcd, filesystem},
-    timer(this, TimerCallback),
+    timer(scheduler, this, TimerCallback),
     controllers {batteryController,
                  bleController,
                  dateTimeController,
                  notificationManager,
                  heartRateController,
+                 heartRateHistory,
                  settingsController,
                  motorController,
                  motionController,
+                 stepHistory,
                  alarmController,
                  brightnessController,
                  nullptr,
@@ -121,10 +178,13 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
 }
 
 void DisplayApp::Start(System::BootErrors error) {
-  msgQueue = xQueueCreate(queueSize, itemSize);
+  // Messages that only signal a state change, handled by reading the latest state
+  msgQueue.Create({Messages::UpdateDateTime, Messages::UpdateBleConnection, Messages::OnChargingEvent});
+  systemTask->Events().Subscribe({System::Topics::TimeChanged}, this, OnEvent);
 
   bootError = error;
 
+  Screens::Screen::arena.Init(screenArenaBuffer, screenArenaSize);
   lvgl.Init();
   motorController.Init();
 
@@ -149,6 +209,13 @@ void DisplayApp::Process(void* instance) {
   }
 }
 
+void DisplayApp::OnEvent(void* instance, System::Topics topic, uint32_t /*payload*/) {
+  auto* app = static_cast<DisplayApp*>(instance);
+  if (topic == System::Topics::TimeChanged) {
+    app->PushMessage(Messages::UpdateDateTime);
+  }
+}
+
 void DisplayApp::InitHw() {
   brightnessController.Init();
   ApplyBrightness();
@@ -229,8 +296,11 @@ void DisplayApp::Refresh() {
       break;
   }
 
-  Messages msg;
-  if (xQueueReceive(msgQueue, &msg, queueTimeout) == pdTRUE) {
+  Utility::MessageQueue<Display::Messages, 10>::Event event;
+  if (msgQueue.Receive(event, queueTimeout)) {
+    Messages msg = event.message;
+    auto& messageProfiler = systemTask->Monitor().DisplayMessages();
+    messageProfiler.Start();
     switch (msg) {
       case Messages::DimScreen:
         DimScreen();
@@ -383,6 +453,7 @@ void DisplayApp::Refresh() {
         motorController.RunForDuration(15);
         break;
     }
+    messageProfiler.Stop(msg);
   }
 
   if (touchHandler.IsTouching()) {
@@ -416,16 +487,24 @@ void DisplayApp::LoadScreen(Apps app, DisplayApp::FullRefreshDirections directio
   lv_disp_trig_activity(nullptr);
   motorController.StopRinging();
 
-  currentScreen.reset(nullptr);
+  systemTask->Monitor().OnAppExit(currentApp);
+  renderStatistics[renderStatisticsCount % nbRenderStatistics] = {currentApp, lvgl.GetRenderStatistics()};
+  renderStatisticsCount++;
+  lvgl.ResetRenderStatistics();
+  if (currentApp == Apps::Clock && IsOverlay(app) && CanKeepWatchFace()) {
+    KeepWatchFace();
+  } else {
+    currentScreen.reset(nullptr);
+    if (keptWatchFace != nullptr && app != Apps::Clock && !IsOverlay(app)) {
+      DropWatchFace();
+    }
+  }
+  systemTask->Monitor().OnAppExited();
   SetFullRefresh(direction);
 
   switch (app) {
     case Apps::Launcher: {
-      std::array<Screens::Tile::Applications, UserAppTypes::Count> apps;
-      int i = 0;
-      for (const auto& userApp : userApps) {
-        apps[i++] = Screens::Tile::Applications {userApp.icon, userApp.app, true};
-      }
+      auto apps = launcherTiles;
       currentScreen = std::make_unique<Screens::ApplicationList>(this,
                                                                  settingsController,
                                                                  batteryController,
@@ -435,14 +514,14 @@ void DisplayApp::LoadScreen(Apps app, DisplayApp::FullRefreshDirections directio
                                                                  std::move(apps));
     } break;
     case Apps::Clock: {
-      const auto* watchFace =
-        std::find_if(userWatchFaces.begin(), userWatchFaces.end(), [this](const WatchFaceDescription& watchfaceDescription) {
-          return watchfaceDescription.watchFace == settingsController.GetWatchFace();
-        });
-      if (watchFace != userWatchFaces.end())
+      if (keptWatchFace != nullptr) {
+        RestoreWatchFace();
+      } else {
+        const auto* watchFace = FindUserWatchFace(settingsController.GetWatchFace());
+        if (watchFace == nullptr) {
+          watchFace = &userWatchFaces[0];
+        }
         currentScreen.reset(watchFace->create(controllers));
-      else {
-        currentScreen.reset(userWatchFaces[0].create(controllers));
       }
       settingsController.SetAppMenu(0);
     } break;
@@ -536,16 +615,15 @@ void DisplayApp::LoadScreen(Apps app, DisplayApp::FullRefreshDirections directio
                                                             bleController,
                                                             watchdog,
                                                             motionController,
-                                                            touchPanel);
+                                                            touchPanel,
+                                                            *systemTask);
       break;
     case Apps::FlashLight:
       currentScreen = std::make_unique<Screens::FlashLight>(*systemTask, brightnessController);
       break;
     default: {
-      const auto* d = std::find_if(userApps.begin(), userApps.end(), [app](const AppDescription& appDescription) {
-        return appDescription.app == app;
-      });
-      if (d != userApps.end()) {
+      const auto* d = FindUserApp(app);
+      if (d != nullptr) {
         currentScreen.reset(d->create(controllers));
       } else {
         currentScreen.reset(userWatchFaces[0].create(controllers));
@@ -556,11 +634,64 @@ void DisplayApp::LoadScreen(Apps app, DisplayApp::FullRefreshDirections directio
   currentApp = app;
 }
 
+bool DisplayApp::IsOverlay(Apps app) {
+  return app == Apps::Launcher || app == Apps::Notifications || app == Apps::NotificationsPreview || app == Apps::QuickSettings;
+}
+
+bool DisplayApp::CanKeepWatchFace() const {
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+  return mon.free_size >= minLvglFreeToKeepWatchFace;
+}
+
+// The overlay is created on a new LVGL screen, while the objects of the watch face stay on the current one. The watch
+// face keeps refreshing in the background, but LVGL only draws the active screen.
+void DisplayApp::KeepWatchFace() {
+  keptWatchFace = std::move(currentScreen);
+  watchFaceScreen = lv_scr_act();
+  overlayScreen = lv_obj_create(nullptr, nullptr);
+  lv_scr_load(overlayScreen);
+
+  // Watch faces create their tasks with themselves as user data
+  nbPausedTasks = 0;
+  lv_task_t* task = nullptr;
+  while ((task = lv_task_get_next(task)) != nullptr && nbPausedTasks < maxPausedTasks) {
+    if (task->user_data == keptWatchFace.get()) {
+      pausedTasks[nbPausedTasks++] = {task, static_cast<lv_task_prio_t>(task->prio)};
+      lv_task_set_prio(task, LV_TASK_PRIO_OFF);
+    }
+  }
+}
+
+// Called once the overlay is deleted
+void DisplayApp::RestoreWatchFace() {
+  lv_scr_load(watchFaceScreen);
+  lv_obj_del(overlayScreen);
+  overlayScreen = nullptr;
+  currentScreen = std::move(keptWatchFace);
+
+  for (uint8_t i = 0; i < nbPausedTasks; i++) {
+    lv_task_set_prio(pausedTasks[i].task, pausedTasks[i].prio);
+    // Refreshed right away, as a new watch face would be
+    lv_task_ready(pausedTasks[i].task);
+  }
+  nbPausedTasks = 0;
+}
+
+// Called once the overlay is deleted. Screens delete their objects from the active screen, so the screen of the watch
+// face is loaded back before deleting it.
+void DisplayApp::DropWatchFace() {
+  lv_scr_load(watchFaceScreen);
+  lv_obj_del(overlayScreen);
+  overlayScreen = nullptr;
+  // The watch face deletes its tasks
+  nbPausedTasks = 0;
+  keptWatchFace.reset(nullptr);
+}
+
 void DisplayApp::PushMessage(Messages msg) {
   if (in_isr()) {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    xQueueSendFromISR(msgQueue, &msg, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    msgQueue.PushFromISR(msg);
   } else {
     TickType_t timeout = portMAX_DELAY;
     // Make xQueueSend() non-blocking if the message is a Notification message. We do this to avoid
@@ -570,7 +701,7 @@ void DisplayApp::PushMessage(Messages msg) {
       timeout = static_cast<TickType_t>(0);
     }
 
-    xQueueSend(msgQueue, &msg, timeout);
+    msgQueue.Push(msg, timeout);
   }
 }
 
@@ -2,6 +2,8 @@
 #include <FreeRTOS.h>
 #include <queue.h>
 #include <task.h>
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <systemtask/Messages.h>
 #include "displayapp/apps/Apps.h"
@@ -20,6 +22,7 @@
 #include "BootErrors.h"
 
 #include "utility/StaticStack.h"
+#include "utility/MessageQueue.h"
 #include "displayapp/Controllers.h"
 
 namespace Pinetime {
@@ -37,7 +40,9 @@ namespace Pinetime {
     class DateTime;
     class NotificationManager;
     class HeartRateController;
+    class HeartRateHistory;
     class MotionController;
+    class StepHistory;
     class TouchHandler;
     class SimpleWeatherService;
   }
@@ -60,16 +65,39 @@ namespace Pinetime {
                  const Drivers::Watchdog& watchdog,
                  Pinetime::Controllers::NotificationManager& notificationManager,
                  Pinetime::Controllers::HeartRateController& heartRateController,
+                 Pinetime::Controllers::HeartRateHistory& heartRateHistory,
                  Controllers::Settings& settingsController,
                  Pinetime::Controllers::MotorController& motorController,
                  Pinetime::Controllers::MotionController& motionController,
+                 Pinetime::Controllers::StepHistory& stepHistory,
                  Pinetime::Controllers::AlarmController& alarmController,
+                 Pinetime::Controllers::Scheduler& scheduler,
                  Pinetime::Controllers::BrightnessController& brightnessController,
                  Pinetime::Controllers::TouchHandler& touchHandler,
                  Pinetime::Controllers::FS& filesystem);
       void Start(System::BootErrors error);
       void PushMessage(Display::Messages msg);
 
+      Utility::MessageQueue<Display::Messages, 10>::Statistics QueueStatistics() const {
+        return msgQueue.GetStatistics();
+      }
+
+      struct AppRenderStatistics {
+        Apps app;
+        Components::LittleVgl::RenderStatistics render;
+      };
+
+      static constexpr size_t nbRenderStatistics = 4;
+
+      // Rendering cost of the last apps that were closed, the most recent first (index 0)
+      size_t NbRenderStatistics() const {
+        return std::min(renderStatisticsCount, nbRenderStatistics);
+      }
+
+      const AppRenderStatistics& RenderStatistics(size_t index) const {
+        return renderStatistics[(renderStatisticsCount - 1 - index) % nbRenderStatistics];
+      }
+
       void StartApp(Apps app, DisplayApp::FullRefreshDirections direction);
 
       void SetFullRefresh(FullRefreshDirections direction);
@@ -89,9 +117,11 @@ namespace Pinetime {
       Pinetime::System::SystemTask* systemTask = nullptr;
       Pinetime::Controllers::NotificationManager& notificationManager;
       Pinetime::Controllers::HeartRateController& heartRateController;
+      Pinetime::Controllers::HeartRateHistory& heartRateHistory;
       Pinetime::Controllers::Settings& settingsController;
       Pinetime::Controllers::MotorController& motorController;
       Pinetime::Controllers::MotionController& motionController;
+      Pinetime::Controllers::StepHistory& stepHistory;
       Pinetime::Controllers::AlarmController& alarmController;
       Pinetime::Controllers::BrightnessController& brightnessController;
       Pinetime::Controllers::TouchHandler& touchHandler;
@@ -105,13 +135,27 @@ namespace Pinetime {
       TaskHandle_t taskHandle;
 
       States state = States::Running;
-      QueueHandle_t msgQueue;
-
-      static constexpr uint8_t queueSize = 10;
-      static constexpr uint8_t itemSize = 1;
+      Utility::MessageQueue<Display::Messages, 10> msgQueue;
 
       std::unique_ptr<Screens::Screen> currentScreen;
 
+      std::array<AppRenderStatistics, nbRenderStatistics> renderStatistics {};
+      size_t renderStatisticsCount = 0;
+
+      // The watch face is kept alive on its own LVGL screen while an overlay app is shown on top of it, so that going
+      // back to the clock doesn't need to build it again
+      std::unique_ptr<Screens::Screen> keptWatchFace;
+      lv_obj_t* watchFaceScreen = nullptr;
+      lv_obj_t* overlayScreen = nullptr;
+      // LVGL tasks of the kept watch face (its refresh task), which don't run while it's hidden
+      struct PausedTask {
+        lv_task_t* task;
+        lv_task_prio_t prio;
+      };
+      static constexpr uint8_t maxPausedTasks = 2;
+      std::array<PausedTask, maxPausedTasks> pausedTasks;
+      uint8_t nbPausedTasks = 0;
+
       Apps currentApp = Apps::None;
       Apps returnToApp = Apps::None;
       FullRefreshDirections returnDirection = FullRefreshDirections::None;
@@ -119,10 +163,16 @@ namespace Pinetime {
 
       TouchEvents GetGesture();
       static void Process(void* instance);
+      static void OnEvent(void* instance, System::Topics topic, uint32_t payload);
       void InitHw();
       void Refresh();
       void LoadNewScreen(Apps app, DisplayApp::FullRefreshDirections direction);
       void LoadScreen(Apps app, DisplayApp::FullRefreshDirections direction);
+      static bool IsOverlay(Apps app);
+      bool CanKeepWatchFace() const;
+      void KeepWatchFace();
+      void RestoreWatchFace();
+      void DropWatchFace();
       void PushMessageToSystemTask(Pinetime::System::Messages message);
 
       Apps nextApp = Apps::None;
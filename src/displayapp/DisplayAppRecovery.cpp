@@ -18,10 +18,13 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
                        const Drivers::Watchdog& /*watchdog*/,
                        Pinetime::Controllers::NotificationManager& /*notificationManager*/,
                        Pinetime::Controllers::HeartRateController& /*heartRateController*/,
+                       Pinetime::Controllers::HeartRateHistory& /*heartRateHistory*/,
                        Controllers::Settings& /*settingsController*/,
                        Pinetime::Controllers::MotorController& /*motorController*/,
                        Pinetime::Controllers::MotionController& /*motionController*/,
+                       Pinetime::Controllers::StepHistory& /*stepHistory*/,
                        Pinetime::Controllers::AlarmController& /*alarmController*/,
+                       Pinetime::Controllers::Scheduler& /*scheduler*/,
                        Pinetime::Controllers::BrightnessController& /*brightnessController*/,
                        Pinetime::Controllers::TouchHandler& /*touchHandler*/,
                        Pinetime::Controllers::FS& /*filesystem*/)
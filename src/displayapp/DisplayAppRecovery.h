@@ -27,10 +27,13 @@ namespace Pinetime {
     class DateTime;
     class NotificationManager;
     class HeartRateController;
+    class HeartRateHistory;
     class MotionController;
+    class StepHistory;
     class TouchHandler;
     class MotorController;
     class AlarmController;
+    class Scheduler;
     class BrightnessController;
     class FS;
     class SimpleWeatherService;
@@ -53,10 +56,13 @@ namespace Pinetime {
                  const Drivers::Watchdog& watchdog,
                  Pinetime::Controllers::NotificationManager& notificationManager,
                  Pinetime::Controllers::HeartRateController& heartRateController,
+                 Pinetime::Controllers::HeartRateHistory& heartRateHistory,
                  Controllers::Settings& settingsController,
                  Pinetime::Controllers::MotorController& motorController,
                  Pinetime::Controllers::MotionController& motionController,
+                 Pinetime::Controllers::StepHistory& stepHistory,
                  Pinetime::Controllers::AlarmController& alarmController,
+                 Pinetime::Controllers::Scheduler& scheduler,
                  Pinetime::Controllers::BrightnessController& brightnessController,
                  Pinetime::Controllers::TouchHandler& touchHandler,
                  Pinetime::Controllers::FS& filesystem);
@@ -68,6 +68,11 @@ static void rounder(lv_disp_drv_t* disp_drv, lv_area_t* area) {
   }
 }
 
+static void monitor(lv_disp_drv_t* disp_drv, uint32_t time, uint32_t px) {
+  auto* lvgl = static_cast<LittleVgl*>(disp_drv->user_data);
+  lvgl->OnFrameRendered(time, px);
+}
+
 bool touchpad_read(lv_indev_drv_t* indev_drv, lv_indev_data_t* data) {
   auto* lvgl = static_cast<LittleVgl*>(indev_drv->user_data);
   return lvgl->GetTouchPadInfo(data);
@@ -100,11 +105,21 @@ void LittleVgl::InitDisplay() {
   disp_drv.buffer = &disp_buf_2;
   disp_drv.user_data = this;
   disp_drv.rounder_cb = rounder;
+  disp_drv.monitor_cb = monitor;
 
   /*Finally register the driver*/
   lv_disp_drv_register(&disp_drv);
 }
 
+void LittleVgl::OnFrameRendered(uint32_t milliseconds, uint32_t pixels) {
+  renderStatistics.frames++;
+  renderStatistics.pixels += pixels;
+  renderStatistics.milliseconds += milliseconds;
+  if (milliseconds > renderStatistics.maxMilliseconds) {
+    renderStatistics.maxMilliseconds = milliseconds;
+  }
+}
+
 void LittleVgl::InitTouchpad() {
   lv_indev_drv_t indev_drv;
 
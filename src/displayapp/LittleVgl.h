@@ -12,6 +12,15 @@ namespace Pinetime {
     class LittleVgl {
     public:
       enum class FullRefreshDirections { None, Up, Down, Left, Right, LeftAnim, RightAnim };
+
+      // Rendering cost, as reported by LVGL after each refresh of the display
+      struct RenderStatistics {
+        uint32_t frames = 0;
+        uint32_t pixels = 0;
+        uint32_t milliseconds = 0;
+        uint32_t maxMilliseconds = 0;
+      };
+
       LittleVgl(Pinetime::Drivers::St7789& lcd, Pinetime::Controllers::FS& filesystem);
 
       LittleVgl(const LittleVgl&) = delete;
@@ -26,6 +35,15 @@ namespace Pinetime {
       void SetFullRefresh(FullRefreshDirections direction);
       void SetNewTouchPoint(int16_t x, int16_t y, bool contact);
       void CancelTap();
+      void OnFrameRendered(uint32_t milliseconds, uint32_t pixels);
+
+      const RenderStatistics& GetRenderStatistics() const {
+        return renderStatistics;
+      }
+
+      void ResetRenderStatistics() {
+        renderStatistics = {};
+      }
 
       bool GetFullRefresh() {
         bool returnValue = fullRefresh;
@@ -50,6 +68,7 @@ namespace Pinetime {
       lv_disp_drv_t disp_drv;
 
       bool fullRefresh = false;
+      RenderStatistics renderStatistics;
       static constexpr uint8_t nbWriteLines = 4;
       static constexpr uint16_t totalNbLines = 320;
       static constexpr uint16_t visibleNbLines = 240;
@@ -4,6 +4,7 @@
 namespace Pinetime {
   namespace Applications {
     namespace Display {
+      // Coalesced messages must stay in the first 32 (see Utility::MessageQueue)
       enum class Messages : uint8_t {
         GoToSleep,
         GoToRunning,
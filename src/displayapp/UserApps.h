@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include "displayapp/apps/Apps.h"
 #include "Controllers.h"
 
@@ -26,6 +27,7 @@ namespace Pinetime {
       Apps app;
       const char* icon;
       Screens::Screen* (*create)(AppControllers& controllers);
+      size_t screenSize;
     };
 
     struct WatchFaceDescription {
@@ -33,16 +35,21 @@ namespace Pinetime {
       const char* name;
       Screens::Screen* (*create)(AppControllers& controllers);
       bool (*isAvailable)(Controllers::FS& fileSystem);
+      size_t screenSize;
     };
 
     template <Apps t>
     consteval AppDescription CreateAppDescription() {
-      return {AppTraits<t>::app, AppTraits<t>::icon, &AppTraits<t>::Create};
+      return {AppTraits<t>::app, AppTraits<t>::icon, &AppTraits<t>::Create, sizeof(typename AppTraits<t>::ScreenType)};
     }
 
     template <WatchFace t>
     consteval WatchFaceDescription CreateWatchFaceDescription() {
-      return {WatchFaceTraits<t>::watchFace, WatchFaceTraits<t>::name, &WatchFaceTraits<t>::Create, &WatchFaceTraits<t>::IsAvailable};
+      return {WatchFaceTraits<t>::watchFace,
+              WatchFaceTraits<t>::name,
+              &WatchFaceTraits<t>::Create,
+              &WatchFaceTraits<t>::IsAvailable,
+              sizeof(typename WatchFaceTraits<t>::ScreenType)};
     }
 
     template <template <Apps...> typename T, Apps... ts>
@@ -55,7 +62,81 @@ namespace Pinetime {
       return {CreateWatchFaceDescription<ts>()...};
     }
 
+    constexpr size_t Id(const AppDescription& description) {
+      return static_cast<size_t>(description.app);
+    }
+
+    constexpr size_t Id(const WatchFaceDescription& description) {
+      return static_cast<size_t>(description.watchFace);
+    }
+
+    // Not constexpr: calling it from CreateIndex() fails the compilation
+    void DuplicateDescription();
+
+    template <class Description, size_t N>
+    consteval size_t MaxId(const std::array<Description, N>& descriptions) {
+      size_t maxId = 0;
+      for (const auto& description : descriptions) {
+        maxId = std::max(maxId, Id(description));
+      }
+      return maxId;
+    }
+
+    // Position of each description, indexed by the value of its app or watch face
+    template <size_t NbIds, class Description, size_t N>
+    consteval std::array<uint8_t, NbIds> CreateIndex(const std::array<Description, N>& descriptions) {
+      static_assert(N < UINT8_MAX);
+      std::array<uint8_t, NbIds> index {};
+      index.fill(UINT8_MAX);
+      for (size_t i = 0; i < N; i++) {
+        if (index[Id(descriptions[i])] != UINT8_MAX) {
+          DuplicateDescription();
+        }
+        index[Id(descriptions[i])] = i;
+      }
+      return index;
+    }
+
+    template <class Description, size_t N>
+    consteval size_t MaxScreenSize(const std::array<Description, N>& descriptions) {
+      size_t maxSize = 0;
+      for (const auto& description : descriptions) {
+        maxSize = std::max(maxSize, description.screenSize);
+      }
+      return maxSize;
+    }
+
+    template <size_t N>
+    consteval std::array<Screens::Tile::Applications, N> CreateLauncherTiles(const std::array<AppDescription, N>& descriptions) {
+      std::array<Screens::Tile::Applications, N> tiles {};
+      for (size_t i = 0; i < N; i++) {
+        tiles[i] = {descriptions[i].icon, descriptions[i].app, true};
+      }
+      return tiles;
+    }
+
     constexpr auto userApps = CreateAppDescriptions(UserAppTypes {});
     constexpr auto userWatchFaces = CreateWatchFaceDescriptions(UserWatchFaceTypes {});
+    constexpr auto userAppsIndex = CreateIndex<MaxId(userApps) + 1>(userApps);
+    constexpr auto userWatchFacesIndex = CreateIndex<MaxId(userWatchFaces) + 1>(userWatchFaces);
+    constexpr auto launcherTiles = CreateLauncherTiles(userApps);
+
+    // Description of a user app, or nullptr if the app isn't built into the firmware
+    constexpr const AppDescription* FindUserApp(Apps app) {
+      auto id = static_cast<size_t>(app);
+      if (id >= userAppsIndex.size() || userAppsIndex[id] == UINT8_MAX) {
+        return nullptr;
+      }
+      return &userApps[userAppsIndex[id]];
+    }
+
+    // Description of a watch face, or nullptr if the watch face isn't built into the firmware
+    constexpr const WatchFaceDescription* FindUserWatchFace(WatchFace watchFace) {
+      auto id = static_cast<size_t>(watchFace);
+      if (id >= userWatchFacesIndex.size() || userWatchFacesIndex[id] == UINT8_MAX) {
+        return nullptr;
+      }
+      return &userWatchFaces[userWatchFacesIndex[id]];
+    }
   }
 }
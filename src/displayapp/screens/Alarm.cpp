@@ -49,6 +49,10 @@ Alarm::Alarm(Controllers::AlarmController& alarmController,
              System::SystemTask& systemTask,
              Controllers::MotorController& motorController)
   : alarmController {alarmController}, systemTask {systemTask}, motorController {motorController} {
+  // The screen edits the first alarm, unless another one is alerting. Swiping left and right selects the others.
+  if (alarmController.IsAlerting()) {
+    alarmIndex = alarmController.AlertingAlarm();
+  }
 
   hourCounter.Create();
   lv_obj_align(hourCounter.GetObject(), nullptr, LV_ALIGN_IN_TOP_LEFT, 0, 0);
@@ -61,12 +65,12 @@ Alarm::Alarm(Controllers::AlarmController& alarmController,
     lv_label_set_align(lblampm, LV_LABEL_ALIGN_CENTER);
     lv_obj_align(lblampm, lv_scr_act(), LV_ALIGN_CENTER, 0, 30);
   }
-  hourCounter.SetValue(alarmController.Hours());
+  hourCounter.SetValue(alarmController.Hours(alarmIndex));
   hourCounter.SetValueChangedEventCallback(this, ValueChangedHandler);
 
   minuteCounter.Create();
   lv_obj_align(minuteCounter.GetObject(), nullptr, LV_ALIGN_IN_TOP_RIGHT, 0, 0);
-  minuteCounter.SetValue(alarmController.Minutes());
+  minuteCounter.SetValue(alarmController.Minutes(alarmIndex));
   minuteCounter.SetValueChangedEventCallback(this, ValueChangedHandler);
 
   lv_obj_t* colonLabel = lv_label_create(lv_scr_act(), nullptr);
@@ -74,6 +78,12 @@ Alarm::Alarm(Controllers::AlarmController& alarmController,
   lv_label_set_text_static(colonLabel, ":");
   lv_obj_align(colonLabel, lv_scr_act(), LV_ALIGN_CENTER, 0, -29);
 
+  lblIndex = lv_label_create(lv_scr_act(), nullptr);
+  lv_obj_set_style_local_text_color(lblIndex, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, Colors::lightGray);
+  lv_label_set_text_fmt(lblIndex, "%d/%d", alarmIndex + 1, AlarmController::nbAlarms);
+  lv_label_set_align(lblIndex, LV_LABEL_ALIGN_CENTER);
+  lv_obj_align(lblIndex, lv_scr_act(), LV_ALIGN_IN_BOTTOM_MID, 0, -55);
+
   btnStop = lv_btn_create(lv_scr_act(), nullptr);
   btnStop->user_data = this;
   lv_obj_set_event_cb(btnStop, btnEventHandler);
@@ -117,7 +127,7 @@ Alarm::Alarm(Controllers::AlarmController& alarmController,
 
   UpdateAlarmTime();
 
-  if (alarmController.State() == Controllers::AlarmController::AlarmState::Alerting) {
+  if (alarmController.State(alarmIndex) == Controllers::AlarmController::AlarmState::Alerting) {
     SetAlerting();
   } else {
     SetSwitchState(LV_ANIM_OFF);
@@ -125,15 +135,15 @@ Alarm::Alarm(Controllers::AlarmController& alarmController,
 }
 
 Alarm::~Alarm() {
-  if (alarmController.State() == AlarmController::AlarmState::Alerting) {
+  while (alarmController.IsAlerting()) {
     StopAlerting();
   }
   lv_obj_clean(lv_scr_act());
 }
 
 void Alarm::DisableAlarm() {
-  if (alarmController.State() == AlarmController::AlarmState::Set) {
-    alarmController.DisableAlarm();
+  if (alarmController.State(alarmIndex) == AlarmController::AlarmState::Set) {
+    alarmController.DisableAlarm(alarmIndex);
     lv_switch_off(enableSwitch, LV_ANIM_ON);
   }
 }
@@ -154,9 +164,9 @@ void Alarm::OnButtonEvent(lv_obj_t* obj, lv_event_t event) {
     }
     if (obj == enableSwitch) {
       if (lv_switch_get_state(enableSwitch)) {
-        alarmController.ScheduleAlarm();
+        alarmController.ScheduleAlarm(alarmIndex);
       } else {
-        alarmController.DisableAlarm();
+        alarmController.DisableAlarm(alarmIndex);
       }
       return;
     }
@@ -172,7 +182,7 @@ bool Alarm::OnButtonPushed() {
     HideInfo();
     return true;
   }
-  if (alarmController.State() == AlarmController::AlarmState::Alerting) {
+  if (alarmController.State(alarmIndex) == AlarmController::AlarmState::Alerting) {
     StopAlerting();
     return true;
   }
@@ -180,8 +190,20 @@ bool Alarm::OnButtonPushed() {
 }
 
 bool Alarm::OnTouchEvent(Pinetime::Applications::TouchEvents event) {
-  // Don't allow closing the screen by swiping while the alarm is alerting
-  return alarmController.State() == AlarmController::AlarmState::Alerting && event == TouchEvents::SwipeDown;
+  // Don't allow closing the screen or changing alarm by swiping while the alarm is alerting
+  if (alarmController.State(alarmIndex) == AlarmController::AlarmState::Alerting) {
+    return event == TouchEvents::SwipeDown || event == TouchEvents::SwipeLeft || event == TouchEvents::SwipeRight;
+  }
+  switch (event) {
+    case TouchEvents::SwipeLeft:
+      SelectAlarm((alarmIndex + 1) % AlarmController::nbAlarms);
+      return true;
+    case TouchEvents::SwipeRight:
+      SelectAlarm((alarmIndex + AlarmController::nbAlarms - 1) % AlarmController::nbAlarms);
+      return true;
+    default:
+      return false;
+  }
 }
 
 void Alarm::OnValueChanged() {
@@ -190,6 +212,11 @@ void Alarm::OnValueChanged() {
 }
 
 void Alarm::UpdateAlarmTime() {
+  UpdateAmPm();
+  alarmController.SetAlarmTime(alarmIndex, hourCounter.GetValue(), minuteCounter.GetValue());
+}
+
+void Alarm::UpdateAmPm() {
   if (lblampm != nullptr) {
     if (hourCounter.GetValue() >= 12) {
       lv_label_set_text_static(lblampm, "PM");
@@ -197,10 +224,31 @@ void Alarm::UpdateAlarmTime() {
       lv_label_set_text_static(lblampm, "AM");
     }
   }
-  alarmController.SetAlarmTime(hourCounter.GetValue(), minuteCounter.GetValue());
+}
+
+void Alarm::SelectAlarm(uint8_t index) {
+  if (btnMessage != nullptr) {
+    HideInfo();
+  }
+  alarmIndex = index;
+  lv_label_set_text_fmt(lblIndex, "%d/%d", alarmIndex + 1, AlarmController::nbAlarms);
+  lv_obj_align(lblIndex, lv_scr_act(), LV_ALIGN_IN_BOTTOM_MID, 0, -55);
+  hourCounter.SetValue(alarmController.Hours(alarmIndex));
+  minuteCounter.SetValue(alarmController.Minutes(alarmIndex));
+  UpdateAmPm();
+  SetRecurButtonState();
+  SetSwitchState(LV_ANIM_OFF);
 }
 
 void Alarm::SetAlerting() {
+  // Another alarm is already ringing: the new one is shown once that one is stopped
+  if (taskStopAlarm != nullptr) {
+    return;
+  }
+  // The alarm that goes off may not be the one shown
+  if (alarmController.AlertingAlarm() != alarmIndex) {
+    SelectAlarm(alarmController.AlertingAlarm());
+  }
   lv_obj_set_hidden(enableSwitch, true);
   lv_obj_set_hidden(btnStop, false);
   taskStopAlarm = lv_task_create(StopAlarmTaskCallback, pdMS_TO_TICKS(60 * 1000), LV_TASK_PRIO_MID, this);
@@ -210,19 +258,25 @@ void Alarm::SetAlerting() {
 
 void Alarm::StopAlerting() {
   alarmController.StopAlerting();
-  motorController.StopRinging();
-  SetSwitchState(LV_ANIM_OFF);
   if (taskStopAlarm != nullptr) {
     lv_task_del(taskStopAlarm);
     taskStopAlarm = nullptr;
   }
+  // The alarms that went off meanwhile ring next, each one is stopped on its own
+  if (alarmController.IsAlerting()) {
+    SelectAlarm(alarmController.AlertingAlarm());
+    taskStopAlarm = lv_task_create(StopAlarmTaskCallback, pdMS_TO_TICKS(60 * 1000), LV_TASK_PRIO_MID, this);
+    return;
+  }
+  motorController.StopRinging();
+  SetSwitchState(LV_ANIM_OFF);
   systemTask.PushMessage(System::Messages::EnableSleeping);
   lv_obj_set_hidden(enableSwitch, false);
   lv_obj_set_hidden(btnStop, true);
 }
 
 void Alarm::SetSwitchState(lv_anim_enable_t anim) {
-  switch (alarmController.State()) {
+  switch (alarmController.State(alarmIndex)) {
     case AlarmController::AlarmState::Set:
       lv_switch_on(enableSwitch, anim);
       break;
@@ -247,8 +301,8 @@ void Alarm::ShowInfo() {
   txtMessage = lv_label_create(btnMessage, nullptr);
   lv_obj_set_style_local_bg_color(btnMessage, LV_BTN_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_NAVY);
 
-  if (alarmController.State() == AlarmController::AlarmState::Set) {
-    auto timeToAlarm = alarmController.SecondsToAlarm();
+  if (alarmController.State(alarmIndex) == AlarmController::AlarmState::Set) {
+    auto timeToAlarm = alarmController.SecondsToAlarm(alarmIndex);
 
     auto daysToAlarm = timeToAlarm / 86400;
     auto hrsToAlarm = (timeToAlarm % 86400) / 3600;
@@ -274,7 +328,7 @@ void Alarm::HideInfo() {
 
 void Alarm::SetRecurButtonState() {
   using Pinetime::Controllers::AlarmController;
-  switch (alarmController.Recurrence()) {
+  switch (alarmController.Recurrence(alarmIndex)) {
     case AlarmController::RecurType::None:
       lv_label_set_text_static(txtRecur, "ONCE");
       break;
@@ -283,20 +337,26 @@ void Alarm::SetRecurButtonState() {
       break;
     case AlarmController::RecurType::Weekdays:
       lv_label_set_text_static(txtRecur, "MON-FRI");
+      break;
+    case AlarmController::RecurType::Weekends:
+      lv_label_set_text_static(txtRecur, "SAT-SUN");
   }
 }
 
 void Alarm::ToggleRecurrence() {
   using Pinetime::Controllers::AlarmController;
-  switch (alarmController.Recurrence()) {
+  switch (alarmController.Recurrence(alarmIndex)) {
     case AlarmController::RecurType::None:
-      alarmController.SetRecurrence(AlarmController::RecurType::Daily);
+      alarmController.SetRecurrence(alarmIndex, AlarmController::RecurType::Daily);
       break;
     case AlarmController::RecurType::Daily:
-      alarmController.SetRecurrence(AlarmController::RecurType::Weekdays);
+      alarmController.SetRecurrence(alarmIndex, AlarmController::RecurType::Weekdays);
       break;
     case AlarmController::RecurType::Weekdays:
-      alarmController.SetRecurrence(AlarmController::RecurType::None);
+      alarmController.SetRecurrence(alarmIndex, AlarmController::RecurType::Weekends);
+      break;
+    case AlarmController::RecurType::Weekends:
+      alarmController.SetRecurrence(alarmIndex, AlarmController::RecurType::None);
   }
   SetRecurButtonState();
 }
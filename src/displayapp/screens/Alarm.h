@@ -45,9 +45,11 @@ namespace Pinetime {
         Controllers::AlarmController& alarmController;
         System::SystemTask& systemTask;
         Controllers::MotorController& motorController;
+        uint8_t alarmIndex = 0;
 
         lv_obj_t *btnStop, *txtStop, *btnRecur, *txtRecur, *btnInfo, *enableSwitch;
         lv_obj_t* lblampm = nullptr;
+        lv_obj_t* lblIndex;
         lv_obj_t* txtMessage = nullptr;
         lv_obj_t* btnMessage = nullptr;
         lv_task_t* taskStopAlarm = nullptr;
@@ -56,6 +58,8 @@ namespace Pinetime {
         void DisableAlarm();
         void SetRecurButtonState();
         void SetSwitchState(lv_anim_enable_t anim);
+        void SelectAlarm(uint8_t index);
+        void UpdateAmPm();
         void SetAlarm();
         void ShowInfo();
         void HideInfo();
@@ -69,6 +73,7 @@ namespace Pinetime {
     template <>
     struct AppTraits<Apps::Alarm> {
       static constexpr Apps app = Apps::Alarm;
+      using ScreenType = Screens::Alarm;
       static constexpr const char* icon = Screens::Symbols::bell;
 
       static Screens::Screen* Create(AppControllers& controllers) {
@@ -51,6 +51,7 @@ namespace Pinetime {
     template <>
     struct AppTraits<Apps::Dice> {
       static constexpr Apps app = Apps::Dice;
+      using ScreenType = Screens::Dice;
       static constexpr const char* icon = Screens::Symbols::dice;
 
       static Screens::Screen* Create(AppControllers& controllers) {
@@ -72,6 +72,7 @@ namespace Pinetime {
     template <>
     struct AppTraits<Apps::DoubleTimer> {
       static constexpr Apps app = Apps::DoubleTimer;
+      using ScreenType = Screens::DoubleTimer;
       static constexpr const char* icon = Screens::Symbols::stopWatch;
 
       static Screens::Screen* Create(AppControllers& controllers) {
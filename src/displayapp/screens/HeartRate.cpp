@@ -1,6 +1,7 @@
 #include "displayapp/screens/HeartRate.h"
 #include <lvgl/lvgl.h>
 #include <components/heartrate/HeartRateController.h>
+#include <components/heartrate/HeartRateHistory.h>
 
 #include "displayapp/DisplayApp.h"
 #include "displayapp/InfiniTimeTheme.h"
@@ -28,8 +29,10 @@ namespace {
   }
 }
 
-HeartRate::HeartRate(Controllers::HeartRateController& heartRateController, System::SystemTask& systemTask)
-  : heartRateController {heartRateController}, systemTask {systemTask} {
+HeartRate::HeartRate(Controllers::HeartRateController& heartRateController,
+                     const Controllers::HeartRateHistory& heartRateHistory,
+                     System::SystemTask& systemTask)
+  : heartRateController {heartRateController}, heartRateHistory {heartRateHistory}, systemTask {systemTask} {
   bool isHrRunning = heartRateController.State() != Controllers::HeartRateController::States::Stopped;
   label_hr = lv_label_create(lv_scr_act(), nullptr);
 
@@ -92,7 +95,14 @@ void HeartRate::Refresh() {
       }
   }
 
-  lv_label_set_text_static(label_status, ToString(state));
+  auto rollup = heartRateHistory.TodayRollup();
+  if (state == Controllers::HeartRateController::States::Stopped && rollup.count > 0) {
+    // Show the background measurements of the day while the sensor is not used by the app
+    lv_label_set_text_fmt(label_status, "Today %d-%d\navg %d", rollup.min, rollup.max, rollup.average);
+  } else {
+    lv_label_set_text_static(label_status, ToString(state));
+  }
+  lv_label_set_align(label_status, LV_LABEL_ALIGN_CENTER);
   lv_obj_align(label_status, label_hr, LV_ALIGN_OUT_BOTTOM_MID, 0, 10);
 }
 
@@ -11,6 +11,7 @@
 namespace Pinetime {
   namespace Controllers {
     class HeartRateController;
+    class HeartRateHistory;
   }
 
   namespace Applications {
@@ -18,7 +19,9 @@ namespace Pinetime {
 
       class HeartRate : public Screen {
       public:
-        HeartRate(Controllers::HeartRateController& HeartRateController, System::SystemTask& systemTask);
+        HeartRate(Controllers::HeartRateController& HeartRateController,
+                  const Controllers::HeartRateHistory& heartRateHistory,
+                  System::SystemTask& systemTask);
         ~HeartRate() override;
 
         void Refresh() override;
@@ -27,6 +30,7 @@ namespace Pinetime {
 
       private:
         Controllers::HeartRateController& heartRateController;
+        const Controllers::HeartRateHistory& heartRateHistory;
         Pinetime::System::SystemTask& systemTask;
         void UpdateStartStopButton(bool isRunning);
         lv_obj_t* label_hr;
@@ -42,10 +46,11 @@ namespace Pinetime {
     template <>
     struct AppTraits<Apps::HeartRate> {
       static constexpr Apps app = Apps::HeartRate;
+      using ScreenType = Screens::HeartRate;
       static constexpr const char* icon = Screens::Symbols::heartBeat;
 
       static Screens::Screen* Create(AppControllers& controllers) {
-        return new Screens::HeartRate(controllers.heartRateController, *controllers.systemTask);
+        return new Screens::HeartRate(controllers.heartRateController, controllers.heartRateHistory, *controllers.systemTask);
       };
     };
   }
@@ -42,6 +42,7 @@ namespace Pinetime {
     template <>
     struct AppTraits<Apps::Paint> {
       static constexpr Apps app = Apps::Paint;
+      using ScreenType = Screens::InfiniPaint;
       static constexpr const char* icon = Screens::Symbols::paintbrush;
 
       static Screens::Screen* Create(AppControllers& controllers) {
@@ -150,18 +150,16 @@ Music::~Music() {
 }
 
 void Music::Refresh() {
-  if (artist != musicService.getArtist()) {
-    artist = musicService.getArtist();
-    lv_label_set_text(txtArtist, artist.data());
+  const auto& artist = musicService.getArtist();
+  if (artistVersion != artist.Version()) {
+    artistVersion = artist.Version();
+    lv_label_set_text(txtArtist, artist.CStr());
   }
 
-  if (track != musicService.getTrack()) {
-    track = musicService.getTrack();
-    lv_label_set_text(txtTrack, track.data());
-  }
-
-  if (album != musicService.getAlbum()) {
-    album = musicService.getAlbum();
+  const auto& track = musicService.getTrack();
+  if (trackVersion != track.Version()) {
+    trackVersion = track.Version();
+    lv_label_set_text(txtTrack, track.CStr());
   }
 
   if (playing != musicService.isPlaying()) {
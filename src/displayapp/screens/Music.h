@@ -19,7 +19,7 @@
 
 #include <FreeRTOS.h>
 #include <lvgl/src/lv_core/lv_obj.h>
-#include <string>
+#include <cstdint>
 #include "displayapp/screens/Screen.h"
 #include "displayapp/apps/Apps.h"
 #include "displayapp/Controllers.h"
@@ -67,9 +67,9 @@ namespace Pinetime {
 
         Pinetime::Controllers::MusicService& musicService;
 
-        std::string artist;
-        std::string album;
-        std::string track;
+        // Versions of the strings of the service last shown
+        uint16_t artistVersion = 0;
+        uint16_t trackVersion = 0;
 
         /** Total length in seconds */
         int totalLength = 0;
@@ -89,6 +89,7 @@ namespace Pinetime {
     template <>
     struct AppTraits<Apps::Music> {
       static constexpr Apps app = Apps::Music;
+      using ScreenType = Screens::Music;
       static constexpr const char* icon = Screens::Symbols::music;
 
       static Screens::Screen* Create(AppControllers& controllers) {
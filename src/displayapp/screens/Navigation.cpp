@@ -16,7 +16,9 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 #include "displayapp/screens/Navigation.h"
+#include <algorithm>
 #include <cstdint>
+#include <string_view>
 #include "displayapp/DisplayApp.h"
 #include "components/ble/NavigationService.h"
 #include "displayapp/InfiniTimeTheme.h"
@@ -176,11 +178,81 @@ namespace {
     return {iconsFile1, static_cast<int16_t>(iconHeight * (index - maxIconsPerFile))};
   }
 
-  Icon GetIcon(const std::string& icon) {
-    for (const auto& iter : iconMap) {
-      if (iter.first == icon) {
-        return GetIcon(iter.second);
+  /* The names of the icons are looked up with a perfect hash generated at compile time (hash and displace):
+   * the names are split in buckets by a first hash, then each bucket gets the seed of a second hash that places all
+   * its names in free slots of the table. A lookup costs 2 hashes and a single string comparison. */
+  constexpr uint8_t nbBuckets = 32;
+  constexpr uint8_t tableSize = 128;
+  constexpr uint8_t noEntry = UINT8_MAX;
+  static_assert(iconMap.size() < noEntry, "Entries of iconMap must fit in the table");
+
+  constexpr uint32_t Hash(std::string_view name, uint32_t seed) {
+    // FNV-1a
+    uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (char c : name) {
+      hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+  }
+
+  struct IconHash {
+    std::array<uint8_t, nbBuckets> seeds {};
+    std::array<uint8_t, tableSize> entries {};
+    bool valid = false;
+  };
+
+  constexpr IconHash CreateIconHash() {
+    IconHash result;
+    result.entries.fill(noEntry);
+
+    std::array<uint8_t, nbBuckets> sizes {};
+    for (const auto& icon : iconMap) {
+      sizes[Hash(icon.first, 0) % nbBuckets]++;
+    }
+    // Largest buckets first, they are the hardest to place
+    std::array<uint8_t, nbBuckets> order {};
+    for (uint8_t i = 0; i < nbBuckets; i++) {
+      order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&sizes](uint8_t a, uint8_t b) {
+      return sizes[a] > sizes[b];
+    });
+
+    for (uint8_t bucket : order) {
+      bool placed = false;
+      // Seed 0 is used by the first hash, whose values are the same for all the names of the bucket
+      for (uint32_t seed = 1; seed < UINT8_MAX && !placed; seed++) {
+        auto entries = result.entries;
+        placed = true;
+        for (uint8_t i = 0; i < iconMap.size() && placed; i++) {
+          if (Hash(iconMap[i].first, 0) % nbBuckets != bucket) {
+            continue;
+          }
+          auto& entry = entries[Hash(iconMap[i].first, seed) % tableSize];
+          placed = entry == noEntry;
+          entry = i;
+        }
+        if (placed) {
+          result.entries = entries;
+          result.seeds[bucket] = seed;
+        }
       }
+      if (!placed) {
+        return result;
+      }
+    }
+    result.valid = true;
+    return result;
+  }
+
+  constexpr IconHash iconHash = CreateIconHash();
+  static_assert(iconHash.valid, "No perfect hash found for iconMap, increase tableSize");
+
+  Icon GetIcon(std::string_view icon) {
+    uint8_t seed = iconHash.seeds[Hash(icon, 0) % nbBuckets];
+    uint8_t entry = iconHash.entries[Hash(icon, seed) % tableSize];
+    if (entry != noEntry && iconMap[entry].first == icon) {
+      return GetIcon(iconMap[entry].second);
     }
     return GetIcon(flagIndex);
   }
@@ -196,6 +268,7 @@ Navigation::Navigation(Pinetime::Controllers::NavigationService& nav) : navServi
   lv_img_set_auto_size(imgFlag, false);
   lv_obj_set_size(imgFlag, 80, 80);
   lv_img_set_src(imgFlag, image.fileName);
+  iconFile = image.fileName;
   lv_img_set_offset_x(imgFlag, 0);
   lv_img_set_offset_y(imgFlag, image.offset);
   lv_obj_set_style_local_image_recolor_opa(imgFlag, LV_IMG_PART_MAIN, LV_STATE_DEFAULT, LV_OPA_COVER);
@@ -238,23 +311,29 @@ Navigation::~Navigation() {
 }
 
 void Navigation::Refresh() {
-  if (flag != navService.getFlag()) {
-    flag = navService.getFlag();
-    const auto& image = GetIcon(flag);
-    lv_img_set_src(imgFlag, image.fileName);
-    lv_obj_set_style_local_image_recolor_opa(imgFlag, LV_IMG_PART_MAIN, LV_STATE_DEFAULT, LV_OPA_COVER);
-    lv_obj_set_style_local_image_recolor(imgFlag, LV_IMG_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_CYAN);
+  const auto& flag = navService.getFlag();
+  if (flagVersion != flag.Version()) {
+    flagVersion = flag.Version();
+    const auto& image = GetIcon(flag.View());
+    // Both files are atlases of icons: changing the source opens the file to read its header and copies its name,
+    // while moving the offset only redraws the rows of the selected icon
+    if (iconFile != image.fileName) {
+      lv_img_set_src(imgFlag, image.fileName);
+      iconFile = image.fileName;
+    }
     lv_img_set_offset_y(imgFlag, image.offset);
   }
 
-  if (narrative != navService.getNarrative()) {
-    narrative = navService.getNarrative();
-    lv_label_set_text(txtNarrative, narrative.data());
+  const auto& narrative = navService.getNarrative();
+  if (narrativeVersion != narrative.Version()) {
+    narrativeVersion = narrative.Version();
+    lv_label_set_text(txtNarrative, narrative.CStr());
   }
 
-  if (manDist != navService.getManDist()) {
-    manDist = navService.getManDist();
-    lv_label_set_text(txtManDist, manDist.data());
+  const auto& manDist = navService.getManDist();
+  if (manDistVersion != manDist.Version()) {
+    manDistVersion = manDist.Version();
+    lv_label_set_text(txtManDist, manDist.CStr());
   }
 
   if (progress != navService.getProgress()) {
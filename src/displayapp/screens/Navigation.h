@@ -19,7 +19,7 @@
 
 #include <FreeRTOS.h>
 #include <lvgl/src/lv_core/lv_obj.h>
-#include <string>
+#include <cstdint>
 #include "displayapp/screens/Screen.h"
 #include <array>
 #include "displayapp/apps/Apps.h"
@@ -50,9 +50,13 @@ namespace Pinetime {
 
         Pinetime::Controllers::NavigationService& navService;
 
-        std::string flag;
-        std::string narrative;
-        std::string manDist;
+        // File of the icon atlas shown by imgFlag
+        const char* iconFile = nullptr;
+
+        // Versions of the strings of the service last shown
+        uint16_t flagVersion = 0;
+        uint16_t narrativeVersion = 0;
+        uint16_t manDistVersion = 0;
         int progress = 0;
 
         lv_task_t* taskRefresh;
@@ -62,6 +66,7 @@ namespace Pinetime {
     template <>
     struct AppTraits<Apps::Navigation> {
       static constexpr Apps app = Apps::Navigation;
+      using ScreenType = Screens::Navigation;
       static constexpr const char* icon = Screens::Symbols::map;
 
       static Screens::Screen* Create(AppControllers& controllers) {
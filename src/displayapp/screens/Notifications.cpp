@@ -24,24 +24,29 @@ Notifications::Notifications(DisplayApp* app,
     mode {mode} {
 
   notificationManager.ClearNewNotificationFlag();
-  auto notification = notificationManager.GetLastNotification();
-  if (notification.valid) {
-    currentId = notification.id;
-    currentItem = std::make_unique<NotificationItem>(notification.Title(),
-                                                     notification.Message(),
-                                                     1,
-                                                     notification.category,
-                                                     notificationManager.NbNotifications(),
-                                                     alertNotificationService,
-                                                     motorController);
-    validDisplay = true;
-  } else {
-    currentItem = std::make_unique<NotificationItem>(alertNotificationService, motorController);
-    validDisplay = false;
+  Controllers::NotificationManager::Categories category;
+  {
+    // The notification is released before messages are pushed to SystemTask
+    const auto notification = notificationManager.GetLastNotification();
+    category = notification->category;
+    if (notification->valid) {
+      currentId = notification->id;
+      currentItem = std::make_unique<NotificationItem>(notification->Title(),
+                                                       notification->Message(),
+                                                       1,
+                                                       notification->category,
+                                                       notificationManager.NbNotifications(),
+                                                       alertNotificationService,
+                                                       motorController);
+      validDisplay = true;
+    } else {
+      currentItem = std::make_unique<NotificationItem>(alertNotificationService, motorController);
+      validDisplay = false;
+    }
   }
   if (mode == Modes::Preview) {
     systemTask.PushMessage(System::Messages::DisableSleeping);
-    if (notification.category == Controllers::NotificationManager::Categories::IncomingCall) {
+    if (category == Controllers::NotificationManager::Categories::IncomingCall) {
       motorController.StartRinging();
     } else {
       motorController.RunForDuration(35);
@@ -86,13 +91,11 @@ void Notifications::Refresh() {
 
   } else if (dismissingNotification) {
     dismissingNotification = false;
-    auto notification = notificationManager.Get(currentId);
-    if (!notification.valid) {
-      notification = notificationManager.GetLastNotification();
-    }
-    currentId = notification.id;
+    const auto notification =
+      notificationManager.Get(currentId)->valid ? notificationManager.Get(currentId) : notificationManager.GetLastNotification();
+    currentId = notification->id;
 
-    if (!notification.valid) {
+    if (!notification->valid) {
       validDisplay = false;
     }
 
@@ -105,10 +108,10 @@ void Notifications::Refresh() {
 
     if (validDisplay) {
       Controllers::NotificationManager::Notification::Idx currentIdx = notificationManager.IndexOf(currentId);
-      currentItem = std::make_unique<NotificationItem>(notification.Title(),
-                                                       notification.Message(),
+      currentItem = std::make_unique<NotificationItem>(notification->Title(),
+                                                       notification->Message(),
                                                        currentIdx + 1,
-                                                       notification.category,
+                                                       notification->category,
                                                        notificationManager.NbNotifications(),
                                                        alertNotificationService,
                                                        motorController);
@@ -164,14 +167,24 @@ bool Notifications::OnTouchEvent(Pinetime::Applications::TouchEvents event) {
   switch (event) {
     case Pinetime::Applications::TouchEvents::SwipeRight:
       if (validDisplay) {
-        auto previousMessage = notificationManager.GetPrevious(currentId);
-        auto nextMessage = notificationManager.GetNext(currentId);
-        afterDismissNextMessageFromAbove = previousMessage.valid;
+        bool previousValid;
+        Controllers::NotificationManager::Notification::Id previousId;
+        bool nextValid;
+        Controllers::NotificationManager::Notification::Id nextId;
+        {
+          const auto previousMessage = notificationManager.GetPrevious(currentId);
+          previousValid = previousMessage->valid;
+          previousId = previousMessage->id;
+          const auto nextMessage = notificationManager.GetNext(currentId);
+          nextValid = nextMessage->valid;
+          nextId = nextMessage->id;
+        }
+        afterDismissNextMessageFromAbove = previousValid;
         notificationManager.Dismiss(currentId);
-        if (previousMessage.valid) {
-          currentId = previousMessage.id;
-        } else if (nextMessage.valid) {
-          currentId = nextMessage.id;
+        if (previousValid) {
+          currentId = previousId;
+        } else if (nextValid) {
+          currentId = nextId;
         } else {
           // don't update id, won't be found be refresh and try to load latest message or no message box
         }
@@ -180,53 +193,45 @@ bool Notifications::OnTouchEvent(Pinetime::Applications::TouchEvents event) {
       }
       return false;
     case Pinetime::Applications::TouchEvents::SwipeDown: {
-      Controllers::NotificationManager::Notification previousNotification;
-      if (validDisplay) {
-        previousNotification = notificationManager.GetPrevious(currentId);
-      } else {
-        previousNotification = notificationManager.GetLastNotification();
-      }
+      const auto previousNotification =
+        validDisplay ? notificationManager.GetPrevious(currentId) : notificationManager.GetLastNotification();
 
-      if (!previousNotification.valid) {
+      if (!previousNotification->valid) {
         return true;
       }
 
-      currentId = previousNotification.id;
+      currentId = previousNotification->id;
       Controllers::NotificationManager::Notification::Idx currentIdx = notificationManager.IndexOf(currentId);
       validDisplay = true;
       currentItem.reset(nullptr);
       app->SetFullRefresh(DisplayApp::FullRefreshDirections::Down);
-      currentItem = std::make_unique<NotificationItem>(previousNotification.Title(),
-                                                       previousNotification.Message(),
+      currentItem = std::make_unique<NotificationItem>(previousNotification->Title(),
+                                                       previousNotification->Message(),
                                                        currentIdx + 1,
-                                                       previousNotification.category,
+                                                       previousNotification->category,
                                                        notificationManager.NbNotifications(),
                                                        alertNotificationService,
                                                        motorController);
     }
       return true;
     case Pinetime::Applications::TouchEvents::SwipeUp: {
-      Controllers::NotificationManager::Notification nextNotification;
-      if (validDisplay) {
-        nextNotification = notificationManager.GetNext(currentId);
-      } else {
-        nextNotification = notificationManager.GetLastNotification();
-      }
+      const auto nextNotification =
+        validDisplay ? notificationManager.GetNext(currentId) : notificationManager.GetLastNotification();
 
-      if (!nextNotification.valid) {
+      if (!nextNotification->valid) {
         running = false;
         return false;
       }
 
-      currentId = nextNotification.id;
+      currentId = nextNotification->id;
       Controllers::NotificationManager::Notification::Idx currentIdx = notificationManager.IndexOf(currentId);
       validDisplay = true;
       currentItem.reset(nullptr);
       app->SetFullRefresh(DisplayApp::FullRefreshDirections::Up);
-      currentItem = std::make_unique<NotificationItem>(nextNotification.Title(),
-                                                       nextNotification.Message(),
+      currentItem = std::make_unique<NotificationItem>(nextNotification->Title(),
+                                                       nextNotification->Message(),
                                                        currentIdx + 1,
-                                                       nextNotification.category,
+                                                       nextNotification->category,
                                                        notificationManager.NbNotifications(),
                                                        alertNotificationService,
                                                        motorController);
@@ -52,6 +52,7 @@ namespace Pinetime {
     template <>
     struct AppTraits<Apps::Paddle> {
       static constexpr Apps app = Apps::Paddle;
+      using ScreenType = Screens::Paddle;
       static constexpr const char* icon = Screens::Symbols::paddle;
 
       static Screens::Screen* Create(AppControllers& controllers) {
@@ -1,6 +1,20 @@
 #include "displayapp/screens/Screen.h"
+#include <new>
 using namespace Pinetime::Applications::Screens;
 
+ScreenArena Screen::arena;
+
+void* Screen::operator new(size_t size) {
+  void* ptr = arena.Allocate(size);
+  return (ptr != nullptr) ? ptr : ::operator new(size);
+}
+
+void Screen::operator delete(void* ptr) {
+  if (!arena.Free(ptr)) {
+    ::operator delete(ptr);
+  }
+}
+
 void Screen::RefreshTaskCallback(lv_task_t* task) {
   static_cast<Screen*>(task->user_data)->Refresh();
 }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include "displayapp/TouchEvents.h"
+#include "displayapp/screens/ScreenArena.h"
 #include <lvgl/lvgl.h>
 
 namespace Pinetime {
@@ -19,6 +21,11 @@ namespace Pinetime {
 
         virtual ~Screen() = default;
 
+        // Screens are allocated in the arena, initialized by DisplayApp
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr);
+        static ScreenArena arena;
+
         static void RefreshTaskCallback(lv_task_t* task);
 
         bool IsRunning() const {
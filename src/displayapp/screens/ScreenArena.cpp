@@ -0,0 +1,45 @@
+#include "displayapp/screens/ScreenArena.h"
+
+using namespace Pinetime::Applications::Screens;
+
+void ScreenArena::Init(uint8_t* buffer, size_t size) {
+  this->buffer = buffer;
+  this->size = size;
+}
+
+void* ScreenArena::Allocate(size_t size) {
+  size_t alignedSize = (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+  if (nbAllocations == maxAllocations || alignedSize > this->size - used) {
+    fallbacks++;
+    return nullptr;
+  }
+
+  allocations[nbAllocations++] = {used, true};
+  void* ptr = buffer + used;
+  used += alignedSize;
+  if (used > peak) {
+    peak = used;
+  }
+  return ptr;
+}
+
+bool ScreenArena::Free(void* ptr) {
+  auto* bytes = static_cast<uint8_t*>(ptr);
+  if (bytes < buffer || bytes >= buffer + size) {
+    return false;
+  }
+
+  size_t offset = bytes - buffer;
+  for (size_t i = 0; i < nbAllocations; i++) {
+    if (allocations[i].offset == offset) {
+      allocations[i].live = false;
+      break;
+    }
+  }
+  // Memory freed out of order is only reclaimed with the allocations above it
+  while (nbAllocations > 0 && !allocations[nbAllocations - 1].live) {
+    nbAllocations--;
+    used = allocations[nbAllocations].offset;
+  }
+  return true;
+}
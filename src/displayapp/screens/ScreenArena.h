@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Applications {
+    namespace Screens {
+      /*
+       * Memory region in which the screens are allocated, instead of the general heap.
+       *
+       * Allocations are stacked: the screen of the current app first, then the screens nested in it (pages of a
+       * ScreenList,...). The top of the stack is released as soon as it's freed, and the whole region once all the
+       * screens are destroyed, which happens on each app switch. Allocations that don't fit in the region fall back to
+       * the heap and are counted.
+       */
+      class ScreenArena {
+      public:
+        static constexpr size_t maxAllocations = 4;
+
+        struct Statistics {
+          size_t size;
+          size_t used;
+          size_t peak;
+          uint32_t fallbacks;
+        };
+
+        void Init(uint8_t* buffer, size_t size);
+
+        // nullptr if the allocation doesn't fit
+        void* Allocate(size_t size);
+        // false if the pointer wasn't allocated in the region
+        bool Free(void* ptr);
+
+        Statistics GetStatistics() const {
+          return {size, used, peak, fallbacks};
+        }
+
+      private:
+        struct Allocation {
+          size_t offset;
+          bool live;
+        };
+
+        uint8_t* buffer = nullptr;
+        size_t size = 0;
+        size_t used = 0;
+        size_t peak = 0;
+        uint32_t fallbacks = 0;
+        std::array<Allocation, maxAllocations> allocations;
+        size_t nbAllocations = 0;
+      };
+    }
+  }
+}
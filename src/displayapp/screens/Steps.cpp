@@ -10,8 +10,10 @@ static void lap_event_handler(lv_obj_t* obj, lv_event_t event) {
   steps->lapBtnEventHandler(event);
 }
 
-Steps::Steps(Controllers::MotionController& motionController, Controllers::Settings& settingsController)
-  : motionController {motionController}, settingsController {settingsController} {
+Steps::Steps(Controllers::MotionController& motionController,
+             Controllers::StepHistory& stepHistory,
+             Controllers::Settings& settingsController)
+  : motionController {motionController}, stepHistory {stepHistory}, settingsController {settingsController} {
 
   stepsArc = lv_arc_create(lv_scr_act(), nullptr);
 
@@ -64,6 +66,11 @@ Steps::Steps(Controllers::MotionController& motionController, Controllers::Setti
   lv_label_set_text_fmt(tripLabel, "Trip: %5li", currentTripSteps);
   lv_obj_align(tripLabel, lstepsGoal, LV_ALIGN_IN_LEFT_MID, 0, 20);
 
+  weekLabel = lv_label_create(lv_scr_act(), nullptr);
+  lv_obj_set_style_local_text_color(weekLabel, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, Colors::lightGray);
+  lv_label_set_text_fmt(weekLabel, "Week: %lu", stepHistory.StepsThisWeek());
+  lv_obj_align(weekLabel, nullptr, LV_ALIGN_IN_TOP_MID, 0, 30);
+
   taskRefresh = lv_task_create(RefreshTaskCallback, 100, LV_TASK_PRIO_MID, this);
 }
 
@@ -85,6 +92,9 @@ void Steps::Refresh() {
     lv_label_set_text_fmt(tripLabel, "Trip: 99999+");
   }
   lv_arc_set_value(stepsArc, int16_t(500 * stepsCount / settingsController.GetStepsGoal()));
+
+  lv_label_set_text_fmt(weekLabel, "Week: %lu", stepHistory.StepsThisWeek());
+  lv_obj_align(weekLabel, nullptr, LV_ALIGN_IN_TOP_MID, 0, 30);
 }
 
 void Steps::lapBtnEventHandler(lv_event_t event) {
@@ -4,6 +4,7 @@
 #include <lvgl/lvgl.h>
 #include "displayapp/screens/Screen.h"
 #include <components/motion/MotionController.h>
+#include <components/motion/StepHistory.h>
 #include "displayapp/apps/Apps.h"
 #include "displayapp/Controllers.h"
 #include "Symbols.h"
@@ -19,7 +20,9 @@ namespace Pinetime {
 
       class Steps : public Screen {
       public:
-        Steps(Controllers::MotionController& motionController, Controllers::Settings& settingsController);
+        Steps(Controllers::MotionController& motionController,
+              Controllers::StepHistory& stepHistory,
+              Controllers::Settings& settingsController);
         ~Steps() override;
 
         void Refresh() override;
@@ -27,6 +30,7 @@ namespace Pinetime {
 
       private:
         Controllers::MotionController& motionController;
+        Controllers::StepHistory& stepHistory;
         Controllers::Settings& settingsController;
 
         uint32_t currentTripSteps = 0;
@@ -36,6 +40,7 @@ namespace Pinetime {
         lv_obj_t* resetBtn;
         lv_obj_t* resetButtonLabel;
         lv_obj_t* tripLabel;
+        lv_obj_t* weekLabel;
 
         uint32_t stepsCount;
 
@@ -46,10 +51,11 @@ namespace Pinetime {
     template <>
     struct AppTraits<Apps::Steps> {
       static constexpr Apps app = Apps::Steps;
+      using ScreenType = Screens::Steps;
       static constexpr const char* icon = Screens::Symbols::shoe;
 
       static Screens::Screen* Create(AppControllers& controllers) {
-        return new Screens::Steps(controllers.motionController, controllers.settingsController);
+        return new Screens::Steps(controllers.motionController, controllers.stepHistory, controllers.settingsController);
       };
     };
   }
@@ -63,6 +63,7 @@ namespace Pinetime {
     template <>
     struct AppTraits<Apps::StopWatch> {
       static constexpr Apps app = Apps::StopWatch;
+      using ScreenType = Screens::StopWatch;
       static constexpr const char* icon = Screens::Symbols::stopWatch;
 
       static Screens::Screen* Create(AppControllers& controllers) {
@@ -1,5 +1,6 @@
 #include <FreeRTOS.h>
 #include <algorithm>
+#include <array>
 #include <task.h>
 #include "displayapp/screens/SystemInfo.h"
 #include <lvgl/lvgl.h>
@@ -13,7 +14,9 @@
 #include "components/datetime/DateTimeController.h"
 #include "components/motion/MotionController.h"
 #include "drivers/Watchdog.h"
+#include "systemtask/SystemTask.h"
 #include "displayapp/InfiniTimeTheme.h"
+#include "heap_4_infinitime.h"
 
 using namespace Pinetime::Applications::Screens;
 
@@ -29,6 +32,101 @@ namespace {
     }
     return "???";
   }
+
+  const char* ToString(Pinetime::Applications::Apps app) {
+    switch (app) {
+      case Pinetime::Applications::Apps::None:
+        return "None";
+      case Pinetime::Applications::Apps::Launcher:
+        return "Launcher";
+      case Pinetime::Applications::Apps::Clock:
+        return "Clock";
+      case Pinetime::Applications::Apps::SysInfo:
+        return "SysInfo";
+      case Pinetime::Applications::Apps::FirmwareUpdate:
+        return "FwUpdate";
+      case Pinetime::Applications::Apps::FirmwareValidation:
+        return "FwValidation";
+      case Pinetime::Applications::Apps::NotificationsPreview:
+        return "NotifPreview";
+      case Pinetime::Applications::Apps::Notifications:
+        return "Notifs";
+      case Pinetime::Applications::Apps::Timer:
+        return "Timer";
+      case Pinetime::Applications::Apps::Alarm:
+        return "Alarm";
+      case Pinetime::Applications::Apps::FlashLight:
+        return "FlashLight";
+      case Pinetime::Applications::Apps::BatteryInfo:
+        return "BatteryInfo";
+      case Pinetime::Applications::Apps::Music:
+        return "Music";
+      case Pinetime::Applications::Apps::Paint:
+        return "Paint";
+      case Pinetime::Applications::Apps::Paddle:
+        return "Paddle";
+      case Pinetime::Applications::Apps::Twos:
+        return "Twos";
+      case Pinetime::Applications::Apps::HeartRate:
+        return "HeartRate";
+      case Pinetime::Applications::Apps::Navigation:
+        return "Navigation";
+      case Pinetime::Applications::Apps::StopWatch:
+        return "StopWatch";
+      case Pinetime::Applications::Apps::Metronome:
+        return "Metronome";
+      case Pinetime::Applications::Apps::Motion:
+        return "Motion";
+      case Pinetime::Applications::Apps::Steps:
+        return "Steps";
+      case Pinetime::Applications::Apps::Dice:
+        return "Dice";
+      case Pinetime::Applications::Apps::Weather:
+        return "Weather";
+      case Pinetime::Applications::Apps::PassKey:
+        return "PassKey";
+      case Pinetime::Applications::Apps::QuickSettings:
+        return "QuickSet";
+      case Pinetime::Applications::Apps::Settings:
+        return "Settings";
+      case Pinetime::Applications::Apps::SettingWatchFace:
+        return "SetWatchFace";
+      case Pinetime::Applications::Apps::SettingTimeFormat:
+        return "SetTimeFormat";
+      case Pinetime::Applications::Apps::SettingWeatherFormat:
+        return "SetWeatherForm";
+      case Pinetime::Applications::Apps::SettingDisplay:
+        return "SetDisplay";
+      case Pinetime::Applications::Apps::SettingWakeUp:
+        return "SetWakeUp";
+      case Pinetime::Applications::Apps::SettingSteps:
+        return "SetSteps";
+      case Pinetime::Applications::Apps::SettingSetDateTime:
+        return "SetSetDateTime";
+      case Pinetime::Applications::Apps::SettingChimes:
+        return "SetChimes";
+      case Pinetime::Applications::Apps::SettingShakeThreshold:
+        return "SetShakeThresh";
+      case Pinetime::Applications::Apps::SettingBluetooth:
+        return "SetBluetooth";
+      case Pinetime::Applications::Apps::Error:
+        return "Error";
+      case Pinetime::Applications::Apps::DoubleTimer:
+        return "DoubleTimer";
+    }
+    return "???";
+  }
+
+  template <class Profiler>
+  size_t SlowestMessage(const Profiler& profiler) {
+    size_t slowest = 0;
+    for (size_t i = 1; i < profiler.Size(); i++) {
+      if (profiler.Get(i).maxMicroseconds > profiler.Get(slowest).maxMicroseconds) {
+        slowest = i;
+      }
+    }
+    return slowest;
+  }
 }
 
 SystemInfo::SystemInfo(Pinetime::Applications::DisplayApp* app,
@@ -38,7 +136,8 @@ SystemInfo::SystemInfo(Pinetime::Applications::DisplayApp* app,
                        const Pinetime::Controllers::Ble& bleController,
                        const Pinetime::Drivers::Watchdog& watchdog,
                        Pinetime::Controllers::MotionController& motionController,
-                       const Pinetime::Drivers::Cst816S& touchPanel)
+                       const Pinetime::Drivers::Cst816S& touchPanel,
+                       Pinetime::System::SystemTask& systemTask)
   : app {app},
     dateTimeController {dateTimeController},
     batteryController {batteryController},
@@ -47,6 +146,7 @@ SystemInfo::SystemInfo(Pinetime::Applications::DisplayApp* app,
     watchdog {watchdog},
     motionController {motionController},
     touchPanel {touchPanel},
+    systemTask {systemTask},
     screens {app,
              0,
              {[this]() -> std::unique_ptr<Screen> {
@@ -63,6 +163,18 @@ SystemInfo::SystemInfo(Pinetime::Applications::DisplayApp* app,
               },
               [this]() -> std::unique_ptr<Screen> {
                 return CreateScreen5();
+              },
+              [this]() -> std::unique_ptr<Screen> {
+                return CreateScreen6();
+              },
+              [this]() -> std::unique_ptr<Screen> {
+                return CreateScreen7();
+              },
+              [this]() -> std::unique_ptr<Screen> {
+                return CreateScreen8();
+              },
+              [this]() -> std::unique_ptr<Screen> {
+                return CreateScreen9();
               }},
              Screens::ScreenListModes::UpDown} {
 }
@@ -95,7 +207,7 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen1() {
                         BootloaderVersion::VersionString());
   lv_label_set_align(label, LV_LABEL_ALIGN_CENTER);
   lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
-  return std::make_unique<Screens::Label>(0, 5, label);
+  return std::make_unique<Screens::Label>(0, 9, label);
 }
 
 std::unique_ptr<Screen> SystemInfo::CreateScreen2() {
@@ -174,7 +286,7 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen2() {
                         touchPanel.GetFwVersion(),
                         TARGET_DEVICE_NAME);
   lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
-  return std::make_unique<Screens::Label>(1, 5, label);
+  return std::make_unique<Screens::Label>(1, 9, label);
 }
 
 extern int mallocFailedCount;
@@ -182,20 +294,22 @@ extern int stackOverflowCount;
 std::unique_ptr<Screen> SystemInfo::CreateScreen3() {
   lv_mem_monitor_t mon;
   lv_mem_monitor(&mon);
+  auto arena = Screen::arena.GetStatistics();
 
   lv_obj_t* label = lv_label_create(lv_scr_act(), nullptr);
   lv_label_set_recolor(label, true);
   const auto& bleAddr = bleController.Address();
   lv_label_set_text_fmt(label,
                         "#808080 BLE MAC#\n"
-                        " %02x:%02x:%02x:%02x:%02x:%02x"
-                        "\n"
-                        "\n"
+                        " %02x:%02x:%02x:%02x:%02x:%02x\n"
                         "#808080 Memory heap#\n"
                         " #808080 Free# %d\n"
                         " #808080 Min free# %d\n"
                         " #808080 Alloc err# %d\n"
-                        " #808080 Ovrfl err# %d\n",
+                        " #808080 Ovrfl err# %d\n"
+                        "#808080 Screen arena#\n"
+                        " %d/%d peak %d\n"
+                        " #808080 Heap fallback# %lu\n",
                         bleAddr[5],
                         bleAddr[4],
                         bleAddr[3],
@@ -205,9 +319,13 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen3() {
                         xPortGetFreeHeapSize(),
                         xPortGetMinimumEverFreeHeapSize(),
                         mallocFailedCount,
-                        stackOverflowCount);
+                        stackOverflowCount,
+                        arena.used,
+                        arena.size,
+                        arena.peak,
+                        arena.fallbacks);
   lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
-  return std::make_unique<Screens::Label>(2, 5, label);
+  return std::make_unique<Screens::Label>(2, 9, label);
 }
 
 bool SystemInfo::sortById(const TaskStatus_t& lhs, const TaskStatus_t& rhs) {
@@ -268,10 +386,167 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen4() {
     }
     lv_table_set_cell_value(infoTask, i + 1, 3, buffer);
   }
-  return std::make_unique<Screens::Label>(3, 5, infoTask);
+  return std::make_unique<Screens::Label>(3, 9, infoTask);
 }
 
 std::unique_ptr<Screen> SystemInfo::CreateScreen5() {
+  static constexpr uint8_t maxTaskCount = 8;
+  const auto& profile = systemTask.Monitor().LastProfile();
+
+  lv_obj_t* infoTask = lv_table_create(lv_scr_act(), nullptr);
+  lv_table_set_col_cnt(infoTask, 3);
+  lv_table_set_row_cnt(infoTask, maxTaskCount + 2);
+  lv_obj_set_style_local_pad_all(infoTask, LV_TABLE_PART_CELL1, LV_STATE_DEFAULT, 0);
+  lv_obj_set_style_local_border_color(infoTask, LV_TABLE_PART_CELL1, LV_STATE_DEFAULT, Colors::lightGray);
+
+  lv_table_set_cell_value(infoTask, 0, 0, "Task");
+  lv_table_set_col_width(infoTask, 0, 70);
+  lv_table_set_cell_value(infoTask, 0, 1, "CPU");
+  lv_table_set_col_width(infoTask, 1, 80);
+  lv_table_set_cell_value(infoTask, 0, 2, "Wk/s");
+  lv_table_set_col_width(infoTask, 2, 80);
+
+  // Busiest tasks first
+  std::array<const System::SystemMonitor::TaskProfile*, System::SystemMonitor::maxTasks> tasks;
+  for (uint8_t i = 0; i < profile.nbTasks; i++) {
+    tasks[i] = &profile.tasks[i];
+  }
+  std::sort(tasks.begin(), tasks.begin() + profile.nbTasks, [](const auto* lhs, const auto* rhs) {
+    return lhs->cycles > rhs->cycles;
+  });
+
+  uint8_t row = 1;
+  char buffer[16];
+  for (uint8_t i = 0; i < profile.nbTasks && i < maxTaskCount; i++, row++) {
+    uint16_t load = System::SystemMonitor::CpuLoad(profile, tasks[i]->cycles);
+    lv_table_set_cell_value(infoTask, row, 0, tasks[i]->name);
+    snprintf(buffer, sizeof(buffer), "%d.%d%%", load / 10, load % 10);
+    lv_table_set_cell_value(infoTask, row, 1, buffer);
+    snprintf(buffer, sizeof(buffer), "%lu", tasks[i]->wakeups * configTICK_RATE_HZ / std::max<TickType_t>(profile.duration, 1));
+    lv_table_set_cell_value(infoTask, row, 2, buffer);
+  }
+
+  uint32_t sleep = profile.sleepTicks * 1000 / std::max<TickType_t>(profile.duration, 1);
+  lv_table_set_cell_value(infoTask, row, 0, "Sleep");
+  snprintf(buffer, sizeof(buffer), "%lu.%lu%%", sleep / 10, sleep % 10);
+  lv_table_set_cell_value(infoTask, row, 1, buffer);
+  lv_table_set_row_cnt(infoTask, row + 1);
+  return std::make_unique<Screens::Label>(4, 9, infoTask);
+}
+
+std::unique_ptr<Screen> SystemInfo::CreateScreen6() {
+  auto systemStatistics = systemTask.QueueStatistics();
+  auto displayStatistics = app->QueueStatistics();
+  const auto& monitor = systemTask.Monitor();
+  size_t systemSlowest = SlowestMessage(monitor.SystemMessages());
+  size_t displaySlowest = SlowestMessage(monitor.DisplayMessages());
+
+  lv_obj_t* label = lv_label_create(lv_scr_act(), nullptr);
+  lv_label_set_recolor(label, true);
+  lv_label_set_text_fmt(label,
+                        "#FFFF00 Message queues#\n\n"
+                        "#808080 System# max %d\n"
+                        " %lu sent %lu/%lu\n"
+                        " slowest #%d %dms\n"
+                        "#808080 Display# max %d\n"
+                        " %lu sent %lu/%lu\n"
+                        " slowest #%d %dms\n\n"
+                        "#808080 coalesced/lost#",
+                        systemStatistics.maxDepth,
+                        systemStatistics.pushed,
+                        systemStatistics.coalesced,
+                        systemStatistics.dropped,
+                        static_cast<int>(systemSlowest),
+                        monitor.SystemMessages().Get(systemSlowest).maxMicroseconds / 1000,
+                        displayStatistics.maxDepth,
+                        displayStatistics.pushed,
+                        displayStatistics.coalesced,
+                        displayStatistics.dropped,
+                        static_cast<int>(displaySlowest),
+                        monitor.DisplayMessages().Get(displaySlowest).maxMicroseconds / 1000);
+  lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
+  return std::make_unique<Screens::Label>(5, 9, label);
+}
+
+std::unique_ptr<Screen> SystemInfo::CreateScreen7() {
+  HeapStatistics_t heap;
+  vPortGetHeapStatistics(&heap);
+  const auto& monitor = systemTask.Monitor();
+  // Share of the free heap that can't be allocated in a single block
+  size_t fragmentation = 0;
+  if (heap.xAvailableHeapSpaceInBytes > 0) {
+    fragmentation = 1000 - heap.xSizeOfLargestFreeBlockInBytes * 1000 / heap.xAvailableHeapSpaceInBytes;
+  }
+
+  char histogram[heapHISTOGRAM_BUCKETS * 11 + 2] = {0};
+  size_t length = 0;
+  for (size_t i = 0; i < heapHISTOGRAM_BUCKETS; i++) {
+    length += snprintf(histogram + length,
+                       sizeof(histogram) - length,
+                       (i == 4) ? "\n %u" : " %u",
+                       static_cast<unsigned>(heap.xAllocationSizeHistogram[i]));
+    length = std::min(length, sizeof(histogram) - 1);
+  }
+
+  char peaks[3 * 16 + 1] = {0};
+  length = 0;
+  for (uint8_t i = 0; i < monitor.NbAppHeapPeaks() && i < 3; i++) {
+    const auto& peak = monitor.GetAppHeapPeak(i);
+    length += snprintf(peaks + length, sizeof(peaks) - length, " app %u: %u\n", static_cast<unsigned>(peak.app), peak.bytes);
+    length = std::min(length, sizeof(peaks) - 1);
+  }
+
+  lv_obj_t* label = lv_label_create(lv_scr_act(), nullptr);
+  lv_label_set_recolor(label, true);
+  lv_label_set_text_fmt(label,
+                        "#808080 Largest block# %d\n"
+                        "#808080 Blocks# %d #808080 frag# %d.%d%%\n"
+                        "#808080 Alloc/free# %d/%d\n"
+                        "#808080 Sizes 16..1k+#\n"
+                        "%s\n"
+                        "#808080 App peaks#\n"
+                        "%s",
+                        heap.xSizeOfLargestFreeBlockInBytes,
+                        heap.xNumberOfFreeBlocks,
+                        fragmentation / 10,
+                        fragmentation % 10,
+                        heap.xNumberOfSuccessfulAllocations,
+                        heap.xNumberOfSuccessfulFrees,
+                        histogram,
+                        peaks);
+  lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
+  return std::make_unique<Screens::Label>(6, 9, label);
+}
+
+std::unique_ptr<Screen> SystemInfo::CreateScreen8() {
+  // Rendering cost of the last apps closed, as "app frames ms max"
+  char buffer[DisplayApp::nbRenderStatistics * 48 + 1] = {0};
+  size_t length = 0;
+  for (size_t i = 0; i < app->NbRenderStatistics(); i++) {
+    const auto& statistics = app->RenderStatistics(i);
+    length += snprintf(buffer + length,
+                       sizeof(buffer) - length,
+                       "%s %lu %lu %lu\n",
+                       ToString(statistics.app),
+                       statistics.render.frames,
+                       statistics.render.milliseconds,
+                       statistics.render.maxMilliseconds);
+    length = std::min(length, sizeof(buffer) - 1);
+  }
+
+  lv_obj_t* label = lv_label_create(lv_scr_act(), nullptr);
+  lv_label_set_recolor(label, true);
+  lv_label_set_text_fmt(label,
+                        "#FFFF00 Rendering#\n\n"
+                        "#808080 App frames ms max#\n"
+                        "%s",
+                        buffer);
+  lv_label_set_align(label, LV_LABEL_ALIGN_CENTER);
+  lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
+  return std::make_unique<Screens::Label>(7, 9, label);
+}
+
+std::unique_ptr<Screen> SystemInfo::CreateScreen9() {
   lv_obj_t* label = lv_label_create(lv_scr_act(), nullptr);
   lv_label_set_recolor(label, true);
   lv_label_set_text_static(label,
@@ -285,5 +560,5 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen5() {
                            "#FFFF00 InfiniTime#");
   lv_label_set_align(label, LV_LABEL_ALIGN_CENTER);
   lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
-  return std::make_unique<Screens::Label>(4, 5, label);
+  return std::make_unique<Screens::Label>(8, 9, label);
 }
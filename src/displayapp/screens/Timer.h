@@ -49,6 +49,7 @@ namespace Pinetime::Applications {
   template <>
   struct AppTraits<Apps::Timer> {
     static constexpr Apps app = Apps::Timer;
+    using ScreenType = Screens::Timer;
     static constexpr const char* icon = Screens::Symbols::hourGlass;
 
     static Screens::Screen* Create(AppControllers& controllers) {
@@ -40,6 +40,7 @@ namespace Pinetime {
     template <>
     struct AppTraits<Apps::Twos> {
       static constexpr Apps app = Apps::Twos;
+      using ScreenType = Screens::Twos;
       static constexpr const char* icon = "2";
 
       static Screens::Screen* Create(AppControllers& /*controllers*/) {
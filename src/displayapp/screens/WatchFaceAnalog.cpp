@@ -1,4 +1,5 @@
 #include "displayapp/screens/WatchFaceAnalog.h"
+#include <algorithm>
 #include <cmath>
 #include <lvgl/lvgl.h>
 #include "displayapp/screens/BatteryIcon.h"
@@ -39,6 +40,17 @@ namespace {
                        .y = CoordinateYRelocate(radius * static_cast<int32_t>(Cosine(angle)) / LV_TRIG_SCALE)};
   }
 
+  // LVGL sizes a line object from its origin to the farthest point, and invalidates that whole area when the points
+  // change. The object is moved to the top-left corner of the hand instead, so that only the areas around the old and
+  // the new position of the hand are redrawn.
+  void SetHandPoints(lv_obj_t* line, lv_point_t* points, lv_point_t start, lv_point_t end) {
+    lv_coord_t x = std::min(start.x, end.x);
+    lv_coord_t y = std::min(start.y, end.y);
+    points[0] = {static_cast<lv_coord_t>(start.x - x), static_cast<lv_coord_t>(start.y - y)};
+    points[1] = {static_cast<lv_coord_t>(end.x - x), static_cast<lv_coord_t>(end.y - y)};
+    lv_obj_set_pos(line, x, y);
+    lv_line_set_points(line, points, 2);
+  }
 }
 
 WatchFaceAnalog::WatchFaceAnalog(Controllers::DateTime& dateTimeController,
@@ -178,14 +190,8 @@ void WatchFaceAnalog::UpdateClock() {
 
   if (sMinute != minute) {
     auto const angle = minute * 6;
-    minute_point[0] = CoordinateRelocate(30, angle);
-    minute_point[1] = CoordinateRelocate(MinuteLength, angle);
-
-    minute_point_trace[0] = CoordinateRelocate(5, angle);
-    minute_point_trace[1] = CoordinateRelocate(31, angle);
-
-    lv_line_set_points(minute_body, minute_point, 2);
-    lv_line_set_points(minute_body_trace, minute_point_trace, 2);
+    SetHandPoints(minute_body, minute_point, CoordinateRelocate(30, angle), CoordinateRelocate(MinuteLength, angle));
+    SetHandPoints(minute_body_trace, minute_point_trace, CoordinateRelocate(5, angle), CoordinateRelocate(31, angle));
   }
 
   if (sHour != hour || sMinute != minute) {
@@ -193,23 +199,15 @@ void WatchFaceAnalog::UpdateClock() {
     sMinute = minute;
     auto const angle = (hour * 30 + minute / 2);
 
-    hour_point[0] = CoordinateRelocate(30, angle);
-    hour_point[1] = CoordinateRelocate(HourLength, angle);
-
-    hour_point_trace[0] = CoordinateRelocate(5, angle);
-    hour_point_trace[1] = CoordinateRelocate(31, angle);
-
-    lv_line_set_points(hour_body, hour_point, 2);
-    lv_line_set_points(hour_body_trace, hour_point_trace, 2);
+    SetHandPoints(hour_body, hour_point, CoordinateRelocate(30, angle), CoordinateRelocate(HourLength, angle));
+    SetHandPoints(hour_body_trace, hour_point_trace, CoordinateRelocate(5, angle), CoordinateRelocate(31, angle));
   }
 
   if (sSecond != second) {
     sSecond = second;
     auto const angle = second * 6;
 
-    second_point[0] = CoordinateRelocate(-20, angle);
-    second_point[1] = CoordinateRelocate(SecondLength, angle);
-    lv_line_set_points(second_body, second_point, 2);
+    SetHandPoints(second_body, second_point, CoordinateRelocate(-20, angle), CoordinateRelocate(SecondLength, angle));
   }
 }
 
@@ -91,6 +91,7 @@ namespace Pinetime {
     template <>
     struct WatchFaceTraits<WatchFace::Analog> {
       static constexpr WatchFace watchFace = WatchFace::Analog;
+      using ScreenType = Screens::WatchFaceAnalog;
       static constexpr const char* name = "Analog face";
 
       static Screens::Screen* Create(AppControllers& controllers) {
@@ -105,6 +105,7 @@ namespace Pinetime {
     template <>
     struct WatchFaceTraits<WatchFace::CasioStyleG7710> {
       static constexpr WatchFace watchFace = WatchFace::CasioStyleG7710;
+      using ScreenType = Screens::WatchFaceCasioStyleG7710;
       static constexpr const char* name = "Casio G7710";
 
       static Screens::Screen* Create(AppControllers& controllers) {
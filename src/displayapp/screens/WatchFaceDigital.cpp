@@ -170,9 +170,8 @@ void WatchFaceDigital::Refresh() {
     lv_obj_realign(stepIcon);
   }
 
-  currentWeather = weatherService.Current();
-  if (currentWeather.IsUpdated()) {
-    auto optCurrentWeather = currentWeather.Get();
+  if (weatherVersion != weatherService.Version()) {
+    const auto optCurrentWeather = weatherService.Current(weatherVersion);
     if (optCurrentWeather) {
       int16_t temp = optCurrentWeather->temperature;
       char tempUnit = 'C';
@@ -48,7 +48,8 @@ namespace Pinetime {
         Utility::DirtyValue<uint8_t> heartbeat {};
         Utility::DirtyValue<bool> heartbeatRunning {};
         Utility::DirtyValue<bool> notificationState {};
-        Utility::DirtyValue<std::optional<Pinetime::Controllers::SimpleWeatherService::CurrentWeather>> currentWeather {};
+        // Version of the weather data last shown
+        uint16_t weatherVersion = 0;
 
         Utility::DirtyValue<std::chrono::time_point<std::chrono::system_clock, std::chrono::days>> currentDate;
 
@@ -78,6 +79,7 @@ namespace Pinetime {
     template <>
     struct WatchFaceTraits<WatchFace::Digital> {
       static constexpr WatchFace watchFace = WatchFace::Digital;
+      using ScreenType = Screens::WatchFaceDigital;
       static constexpr const char* name = "Digital face";
 
       static Screens::Screen* Create(AppControllers& controllers) {
@@ -103,6 +103,7 @@ namespace Pinetime {
     template <>
     struct WatchFaceTraits<WatchFace::Infineat> {
       static constexpr WatchFace watchFace = WatchFace::Infineat;
+      using ScreenType = Screens::WatchFaceInfineat;
       static constexpr const char* name = "Infineat face";
 
       static Screens::Screen* Create(AppControllers& controllers) {
@@ -539,9 +539,8 @@ void WatchFacePineTimeStyle::Refresh() {
     }
   }
 
-  currentWeather = weatherService.Current();
-  if (currentWeather.IsUpdated()) {
-    auto optCurrentWeather = currentWeather.Get();
+  if (weatherVersion != weatherService.Version()) {
+    const auto optCurrentWeather = weatherService.Current(weatherVersion);
     if (optCurrentWeather) {
       int16_t temp = optCurrentWeather->temperature;
       if (settingsController.GetWeatherFormat() == Controllers::Settings::WeatherFormat::Imperial) {
@@ -61,7 +61,8 @@ namespace Pinetime {
         Utility::DirtyValue<std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>> currentDateTime {};
         Utility::DirtyValue<uint32_t> stepCount {};
         Utility::DirtyValue<bool> notificationState {};
-        Utility::DirtyValue<std::optional<Pinetime::Controllers::SimpleWeatherService::CurrentWeather>> currentWeather {};
+        // Version of the weather data last shown
+        uint16_t weatherVersion = 0;
 
         static Pinetime::Controllers::Settings::Colors GetNext(Controllers::Settings::Colors color);
         static Pinetime::Controllers::Settings::Colors GetPrevious(Controllers::Settings::Colors color);
@@ -124,6 +125,7 @@ namespace Pinetime {
     template <>
     struct WatchFaceTraits<WatchFace::PineTimeStyle> {
       static constexpr WatchFace watchFace = WatchFace::PineTimeStyle;
+      using ScreenType = Screens::WatchFacePineTimeStyle;
       static constexpr const char* name = "PineTimeStyle";
 
       static Screens::Screen* Create(AppControllers& controllers) {
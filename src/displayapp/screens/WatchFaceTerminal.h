@@ -72,6 +72,7 @@ namespace Pinetime {
     template <>
     struct WatchFaceTraits<WatchFace::Terminal> {
       static constexpr WatchFace watchFace = WatchFace::Terminal;
+      using ScreenType = Screens::WatchFaceTerminal;
       static constexpr const char* name = "Terminal";
 
       static Screens::Screen* Create(AppControllers& controllers) {
@@ -116,83 +116,82 @@ Weather::~Weather() {
 }
 
 void Weather::Refresh() {
-  currentWeather = weatherService.Current();
-  if (currentWeather.IsUpdated()) {
-    auto optCurrentWeather = currentWeather.Get();
-    if (optCurrentWeather) {
-      int16_t temp = optCurrentWeather->temperature;
-      int16_t minTemp = optCurrentWeather->minTemperature;
-      int16_t maxTemp = optCurrentWeather->maxTemperature;
-      lv_obj_set_style_local_text_color(temperature, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, TemperatureColor(temp));
-      char tempUnit = 'C';
-      if (settingsController.GetWeatherFormat() == Controllers::Settings::WeatherFormat::Imperial) {
-        temp = Controllers::SimpleWeatherService::CelsiusToFahrenheit(temp);
-        minTemp = Controllers::SimpleWeatherService::CelsiusToFahrenheit(minTemp);
-        maxTemp = Controllers::SimpleWeatherService::CelsiusToFahrenheit(maxTemp);
-        tempUnit = 'F';
-      }
-      lv_label_set_text(icon, Symbols::GetSymbol(optCurrentWeather->iconId));
-      lv_label_set_text(condition, Symbols::GetCondition(optCurrentWeather->iconId));
-      lv_label_set_text_fmt(temperature, "%d°%c", RoundTemperature(temp), tempUnit);
-      lv_label_set_text_fmt(minTemperature, "%d°", RoundTemperature(minTemp));
-      lv_label_set_text_fmt(maxTemperature, "%d°", RoundTemperature(maxTemp));
-    } else {
-      lv_label_set_text(icon, "");
-      lv_label_set_text(condition, "");
-      lv_label_set_text(temperature, "---");
-      lv_obj_set_style_local_text_color(temperature, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_WHITE);
-      lv_label_set_text(minTemperature, "");
-      lv_label_set_text(maxTemperature, "");
+  if (weatherVersion == weatherService.Version()) {
+    return;
+  }
+
+  // The forecast is copied after the version: if it changes in between, it's copied again at the next refresh
+  const auto optCurrentWeather = weatherService.Current(weatherVersion);
+  if (optCurrentWeather) {
+    int16_t temp = optCurrentWeather->temperature;
+    int16_t minTemp = optCurrentWeather->minTemperature;
+    int16_t maxTemp = optCurrentWeather->maxTemperature;
+    lv_obj_set_style_local_text_color(temperature, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, TemperatureColor(temp));
+    char tempUnit = 'C';
+    if (settingsController.GetWeatherFormat() == Controllers::Settings::WeatherFormat::Imperial) {
+      temp = Controllers::SimpleWeatherService::CelsiusToFahrenheit(temp);
+      minTemp = Controllers::SimpleWeatherService::CelsiusToFahrenheit(minTemp);
+      maxTemp = Controllers::SimpleWeatherService::CelsiusToFahrenheit(maxTemp);
+      tempUnit = 'F';
     }
+    lv_label_set_text(icon, Symbols::GetSymbol(optCurrentWeather->iconId));
+    lv_label_set_text(condition, Symbols::GetCondition(optCurrentWeather->iconId));
+    lv_label_set_text_fmt(temperature, "%d°%c", RoundTemperature(temp), tempUnit);
+    lv_label_set_text_fmt(minTemperature, "%d°", RoundTemperature(minTemp));
+    lv_label_set_text_fmt(maxTemperature, "%d°", RoundTemperature(maxTemp));
+  } else {
+    lv_label_set_text(icon, "");
+    lv_label_set_text(condition, "");
+    lv_label_set_text(temperature, "---");
+    lv_obj_set_style_local_text_color(temperature, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_WHITE);
+    lv_label_set_text(minTemperature, "");
+    lv_label_set_text(maxTemperature, "");
   }
 
-  currentForecast = weatherService.GetForecast();
-  if (currentForecast.IsUpdated()) {
-    auto optCurrentForecast = currentForecast.Get();
-    if (optCurrentForecast) {
-      std::tm localTime = *std::localtime(reinterpret_cast<const time_t*>(&optCurrentForecast->timestamp));
-
-      for (int i = 0; i < Controllers::SimpleWeatherService::MaxNbForecastDays; i++) {
-        int16_t maxTemp = optCurrentForecast->days[i].maxTemperature;
-        int16_t minTemp = optCurrentForecast->days[i].minTemperature;
-        lv_table_set_cell_type(forecast, 2, i, TemperatureStyle(maxTemp));
-        lv_table_set_cell_type(forecast, 3, i, TemperatureStyle(minTemp));
-        if (settingsController.GetWeatherFormat() == Controllers::Settings::WeatherFormat::Imperial) {
-          maxTemp = Controllers::SimpleWeatherService::CelsiusToFahrenheit(maxTemp);
-          minTemp = Controllers::SimpleWeatherService::CelsiusToFahrenheit(minTemp);
-        }
-        uint8_t wday = localTime.tm_wday + i + 1;
-        if (wday > 7) {
-          wday -= 7;
-        }
-        maxTemp = RoundTemperature(maxTemp);
-        minTemp = RoundTemperature(minTemp);
-        const char* dayOfWeek = Controllers::DateTime::DayOfWeekShortToStringLow(static_cast<Controllers::DateTime::Days>(wday));
-        lv_table_set_cell_value(forecast, 0, i, dayOfWeek);
-        lv_table_set_cell_value(forecast, 1, i, Symbols::GetSymbol(optCurrentForecast->days[i].iconId));
-        // Pad cells based on the largest number of digits on each column
-        char maxPadding[3] = "  ";
-        char minPadding[3] = "  ";
-        int diff = snprintf(nullptr, 0, "%d", maxTemp) - snprintf(nullptr, 0, "%d", minTemp);
-        if (diff <= 0) {
-          maxPadding[-diff] = '\0';
-          minPadding[0] = '\0';
-        } else {
-          maxPadding[0] = '\0';
-          minPadding[diff] = '\0';
-        }
-        lv_table_set_cell_value_fmt(forecast, 2, i, "%s%d", maxPadding, maxTemp);
-        lv_table_set_cell_value_fmt(forecast, 3, i, "%s%d", minPadding, minTemp);
+  const auto optCurrentForecast = weatherService.GetForecast();
+  if (optCurrentForecast) {
+    std::tm localTime = *std::localtime(reinterpret_cast<const time_t*>(&optCurrentForecast->timestamp));
+
+    for (int i = 0; i < Controllers::SimpleWeatherService::MaxNbForecastDays; i++) {
+      int16_t maxTemp = optCurrentForecast->days[i].maxTemperature;
+      int16_t minTemp = optCurrentForecast->days[i].minTemperature;
+      lv_table_set_cell_type(forecast, 2, i, TemperatureStyle(maxTemp));
+      lv_table_set_cell_type(forecast, 3, i, TemperatureStyle(minTemp));
+      if (settingsController.GetWeatherFormat() == Controllers::Settings::WeatherFormat::Imperial) {
+        maxTemp = Controllers::SimpleWeatherService::CelsiusToFahrenheit(maxTemp);
+        minTemp = Controllers::SimpleWeatherService::CelsiusToFahrenheit(minTemp);
+      }
+      uint8_t wday = localTime.tm_wday + i + 1;
+      if (wday > 7) {
+        wday -= 7;
       }
-    } else {
-      for (int i = 0; i < Controllers::SimpleWeatherService::MaxNbForecastDays; i++) {
-        lv_table_set_cell_value(forecast, 0, i, "");
-        lv_table_set_cell_value(forecast, 1, i, "");
-        lv_table_set_cell_value(forecast, 2, i, "");
-        lv_table_set_cell_value(forecast, 3, i, "");
-        lv_table_set_cell_type(forecast, 2, i, LV_TABLE_PART_CELL1);
-        lv_table_set_cell_type(forecast, 3, i, LV_TABLE_PART_CELL1);
+      maxTemp = RoundTemperature(maxTemp);
+      minTemp = RoundTemperature(minTemp);
+      const char* dayOfWeek = Controllers::DateTime::DayOfWeekShortToStringLow(static_cast<Controllers::DateTime::Days>(wday));
+      lv_table_set_cell_value(forecast, 0, i, dayOfWeek);
+      lv_table_set_cell_value(forecast, 1, i, Symbols::GetSymbol(optCurrentForecast->days[i].iconId));
+      // Pad cells based on the largest number of digits on each column
+      char maxPadding[3] = "  ";
+      char minPadding[3] = "  ";
+      int diff = snprintf(nullptr, 0, "%d", maxTemp) - snprintf(nullptr, 0, "%d", minTemp);
+      if (diff <= 0) {
+        maxPadding[-diff] = '\0';
+        minPadding[0] = '\0';
+      } else {
+        maxPadding[0] = '\0';
+        minPadding[diff] = '\0';
       }
+      lv_table_set_cell_value_fmt(forecast, 2, i, "%s%d", maxPadding, maxTemp);
+      lv_table_set_cell_value_fmt(forecast, 3, i, "%s%d", minPadding, minTemp);
+    }
+  } else {
+    for (int i = 0; i < Controllers::SimpleWeatherService::MaxNbForecastDays; i++) {
+      lv_table_set_cell_value(forecast, 0, i, "");
+      lv_table_set_cell_value(forecast, 1, i, "");
+      lv_table_set_cell_value(forecast, 2, i, "");
+      lv_table_set_cell_value(forecast, 3, i, "");
+      lv_table_set_cell_type(forecast, 2, i, LV_TABLE_PART_CELL1);
+      lv_table_set_cell_type(forecast, 3, i, LV_TABLE_PART_CELL1);
     }
   }
 }
@@ -7,7 +7,6 @@
 #include "displayapp/apps/Apps.h"
 #include "displayapp/Controllers.h"
 #include "Symbols.h"
-#include "utility/DirtyValue.h"
 
 namespace Pinetime {
 
@@ -29,8 +28,8 @@ namespace Pinetime {
         Controllers::Settings& settingsController;
         Controllers::SimpleWeatherService& weatherService;
 
-        Utility::DirtyValue<std::optional<Controllers::SimpleWeatherService::CurrentWeather>> currentWeather {};
-        Utility::DirtyValue<std::optional<Controllers::SimpleWeatherService::Forecast>> currentForecast {};
+        // Version of the weather data last shown
+        uint16_t weatherVersion = 0;
 
         lv_obj_t* icon;
         lv_obj_t* condition;
@@ -46,6 +45,7 @@ namespace Pinetime {
     template <>
     struct AppTraits<Apps::Weather> {
       static constexpr Apps app = Apps::Weather;
+      using ScreenType = Screens::Weather;
       static constexpr const char* icon = Screens::Symbols::cloudSunRain;
 
       static Screens::Screen* Create(AppControllers& controllers) {
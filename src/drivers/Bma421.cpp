@@ -1,4 +1,5 @@
 #include "drivers/Bma421.h"
+#include <algorithm>
 #include <libraries/delay/nrf_delay.h>
 #include <libraries/log/nrf_log.h>
 #include "drivers/TwiMaster.h"
@@ -130,6 +131,60 @@ Bma421::Values Bma421::Process() {
   return {steps, data.y, data.x, data.z};
 }
 
+void Bma421::SetFifo(bool enable, uint8_t downsampling) {
+  if (not isOk)
+    return;
+  downsampling = std::min(downsampling, maxFifoDownsampling);
+
+  if (enable) {
+    // Downsampled frames must be filtered to avoid aliasing
+    bma4_set_accel_fifo_filter_data(1, &bma);
+    bma4_set_fifo_down_accel(downsampling, &bma);
+    bma4_set_fifo_config(BMA4_FIFO_ALL, 0, &bma);
+    bma4_set_fifo_config(BMA4_FIFO_ACCEL | BMA4_FIFO_HEADER, 1, &bma);
+    // Flush the frames queued before
+    bma4_set_command_register(0xb0, &bma);
+  } else {
+    bma4_set_fifo_config(BMA4_FIFO_ALL, 0, &bma);
+  }
+  fifoEnabled = enable;
+  fifoDownsampling = downsampling;
+}
+
+size_t Bma421::ReadFifo(int16_t* xyz, size_t maxFrames, uint16_t& skippedFrames) {
+  skippedFrames = 0;
+  if (not isOk || not fifoEnabled)
+    return 0;
+
+  uint16_t length = 0;
+  if (bma4_get_fifo_length(&length, &bma) != BMA4_OK || length == 0)
+    return 0;
+
+  // The frames left in the FIFO are read next time
+  struct bma4_fifo_frame fifo = {};
+  fifo.data = fifoData;
+  fifo.length = std::min({static_cast<size_t>(length), sizeof(fifoData), std::min(maxFrames, maxFifoFrames) * fifoFrameSize});
+  if (bma4_read_fifo_data(&fifo, &bma) != BMA4_OK)
+    return 0;
+
+  // Frames are extracted in small batches to keep them off the stack of the caller
+  size_t nbFrames = 0;
+  while (nbFrames < maxFrames) {
+    struct bma4_accel frames[8];
+    uint16_t nbExtracted = std::min<size_t>(8, maxFrames - nbFrames);
+    if (bma4_extract_accel(frames, &nbExtracted, &fifo, &bma) != BMA4_OK || nbExtracted == 0)
+      break;
+    for (uint16_t i = 0; i < nbExtracted; i++, nbFrames++) {
+      // Same scale and axis swap as in Process()
+      xyz[3 * nbFrames] = 1024 * frames[i].y / accelScaleFactors[accel_conf.range];
+      xyz[3 * nbFrames + 1] = 1024 * frames[i].x / accelScaleFactors[accel_conf.range];
+      xyz[3 * nbFrames + 2] = 1024 * frames[i].z / accelScaleFactors[accel_conf.range];
+    }
+  }
+  skippedFrames = fifo.skipped_frame_count;
+  return nbFrames;
+}
+
 bool Bma421::IsOk() const {
   return isOk;
 }
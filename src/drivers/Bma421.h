@@ -29,6 +29,26 @@ namespace Pinetime {
       Values Process();
       void ResetStepCounter();
 
+      // The FIFO queues the accelerations at ODR / 2^downsampling (100Hz / 2^downsampling)
+      static constexpr uint8_t maxFifoDownsampling = 3;
+      static constexpr size_t maxFifoFrames = 32;
+      void SetFifo(bool enable, uint8_t downsampling);
+      /// Reads the accelerations queued in the FIFO, as X/Y/Z triplets in the units of Process(). skippedFrames is the
+      /// number of frames lost because the FIFO was full before this read.
+      size_t ReadFifo(int16_t* xyz, size_t maxFrames, uint16_t& skippedFrames);
+
+      bool IsFifoEnabled() const {
+        return fifoEnabled;
+      }
+
+      uint8_t FifoDownsampling() const {
+        return fifoDownsampling;
+      }
+
+      uint16_t FifoPeriodMs() const {
+        return 10 << fifoDownsampling;
+      }
+
       void Read(uint8_t registerAddress, uint8_t* buffer, size_t size);
       void Write(uint8_t registerAddress, const uint8_t* data, size_t size);
 
@@ -45,6 +65,12 @@ namespace Pinetime {
       bool isOk = false;
       bool isResetOk = false;
       DeviceTypes deviceType = DeviceTypes::Unknown;
+
+      // In header mode, each acceleration frame is a header followed by X/Y/Z
+      static constexpr size_t fifoFrameSize = 7;
+      uint8_t fifoData[maxFifoFrames * fifoFrameSize];
+      bool fifoEnabled = false;
+      uint8_t fifoDownsampling = 0;
     };
   }
 }
\ No newline at end of file
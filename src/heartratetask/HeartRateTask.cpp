@@ -1,12 +1,18 @@
 #include "heartratetask/HeartRateTask.h"
 #include <drivers/Hrs3300.h>
 #include <components/heartrate/HeartRateController.h>
+#include <components/heartrate/HeartRateHistory.h>
+#include <components/motion/MotionController.h>
+#include <cmath>
 #include <nrf_log.h>
 
 using namespace Pinetime::Applications;
 
-HeartRateTask::HeartRateTask(Drivers::Hrs3300& heartRateSensor, Controllers::HeartRateController& controller)
-  : heartRateSensor {heartRateSensor}, controller {controller} {
+HeartRateTask::HeartRateTask(Drivers::Hrs3300& heartRateSensor,
+                             Controllers::HeartRateController& controller,
+                             Controllers::HeartRateHistory& history,
+                             const Controllers::MotionController& motionController)
+  : heartRateSensor {heartRateSensor}, controller {controller}, history {history}, motionController {motionController} {
 }
 
 void HeartRateTask::Start() {
@@ -25,28 +31,27 @@ void HeartRateTask::Process(void* instance) {
 
 void HeartRateTask::Work() {
   int lastBpm = 0;
+  nextBackgroundMeasurement = xTaskGetTickCount() + backgroundMeasurementPeriod;
   while (true) {
     Messages msg;
-    uint32_t delay;
-    if (state == States::Running) {
-      if (measurementStarted) {
-        delay = ppg.deltaTms;
-      } else {
-        delay = 100;
-      }
-    } else {
-      delay = portMAX_DELAY;
-    }
+    // Sleep until the next sample or, when not sampling, until the next background measurement
+    TickType_t deadline = Sampling() ? nextSample : nextBackgroundMeasurement;
+    auto ticksToDeadline = static_cast<int32_t>(deadline - xTaskGetTickCount());
+    uint32_t delay = (ticksToDeadline > 0) ? ticksToDeadline : 0;
 
     if (xQueueReceive(messageQueue, &msg, delay)) {
       switch (msg) {
         case Messages::GoToSleep:
-          StopMeasurement();
+          // A background measurement keeps running while the display is off
+          if (!backgroundMeasurementStarted) {
+            StopMeasurement();
+          }
           state = States::Idle;
           break;
         case Messages::WakeUp:
           state = States::Running;
           if (measurementStarted) {
+            backgroundMeasurementStarted = false;
             lastBpm = 0;
             StartMeasurement();
           }
@@ -55,6 +60,7 @@ void HeartRateTask::Work() {
           if (measurementStarted) {
             break;
           }
+          backgroundMeasurementStarted = false;
           lastBpm = 0;
           StartMeasurement();
           measurementStarted = true;
@@ -67,10 +73,12 @@ void HeartRateTask::Work() {
           measurementStarted = false;
           break;
       }
+      // Messages must not shift the sampling grid: wait for the deadline again
+      continue;
     }
 
-    if (measurementStarted) {
-      int8_t ambient = ppg.Preprocess(heartRateSensor.ReadHrs(), heartRateSensor.ReadAls());
+    if (measurementStarted && state == States::Running) {
+      int8_t ambient = AcquireSample();
       int bpm = ppg.HeartRate();
 
       // If ambient light detected or a reset requested (bpm < 0)
@@ -96,10 +104,81 @@ void HeartRateTask::Work() {
         lastBpm = bpm;
         controller.Update(Controllers::HeartRateController::States::Running, lastBpm);
       }
+    } else {
+      HandleBackgroundMeasurement();
     }
   }
 }
 
+void HeartRateTask::HandleBackgroundMeasurement() {
+  TickType_t now = xTaskGetTickCount();
+  if (!backgroundMeasurementStarted) {
+    if (static_cast<int32_t>(now - nextBackgroundMeasurement) < 0) {
+      return;
+    }
+    StartMeasurement();
+    backgroundMeasurementStarted = true;
+    backgroundMeasurementEnd = now + backgroundMeasurementTimeout;
+    backgroundValidReadings = 0;
+    backgroundBpm = 0;
+    return;
+  }
+
+  int8_t ambient = AcquireSample();
+  int bpm = ppg.HeartRate();
+  if (ambient > 0) {
+    ppg.Reset(true);
+    backgroundValidReadings = 0;
+  } else if (bpm < 0) {
+    ppg.Reset(false);
+    backgroundValidReadings = 0;
+  } else if (bpm > 0 && ppg.Confidence() >= backgroundMeasurementMinConfidence) {
+    backgroundBpm = bpm;
+    backgroundValidReadings++;
+  }
+
+  if (backgroundValidReadings >= backgroundMeasurementValidReadings || static_cast<int32_t>(now - backgroundMeasurementEnd) >= 0) {
+    StopMeasurement();
+    backgroundMeasurementStarted = false;
+    nextBackgroundMeasurement = now + backgroundMeasurementPeriod;
+    // Only keep a reading that survived several consecutive windows
+    if (backgroundValidReadings >= backgroundMeasurementValidReadings) {
+      history.AddMeasurement(backgroundBpm);
+    }
+  }
+}
+
+bool HeartRateTask::Sampling() const {
+  return (measurementStarted && state == States::Running) || backgroundMeasurementStarted;
+}
+
+TickType_t HeartRateTask::SampleDeadline(uint32_t index) const {
+  // Computed from the index rather than accumulated, as deltaTms is not a whole number of ticks
+  uint64_t elapsedMs = static_cast<uint64_t>(index) * Controllers::Ppg::deltaTms;
+  return samplingStart + static_cast<TickType_t>((elapsedMs * configTICK_RATE_HZ) / 1000);
+}
+
+int8_t HeartRateTask::AcquireSample() {
+  TickType_t now = xTaskGetTickCount();
+  // Timestamp the sample with the time it was actually read, so that Ppg can compensate for any remaining jitter
+  auto timestamp = static_cast<uint16_t>((static_cast<uint64_t>(now) * 1000) / configTICK_RATE_HZ);
+  // The accelerometer is sampled by the system task, use its latest values
+  int32_t x = motionController.X();
+  int32_t y = motionController.Y();
+  int32_t z = motionController.Z();
+  auto acceleration = static_cast<uint16_t>(std::sqrt(static_cast<float>(x * x + y * y + z * z)));
+  int8_t ambient = ppg.Preprocess(heartRateSensor.ReadHrs(), heartRateSensor.ReadAls(), timestamp, acceleration);
+
+  sampleCount++;
+  if (static_cast<int32_t>(now - SampleDeadline(sampleCount)) >= 0) {
+    // Too late (the task was blocked for more than a sample period): restart the grid from now
+    samplingStart = now;
+    sampleCount = 1;
+  }
+  nextSample = SampleDeadline(sampleCount);
+  return ambient;
+}
+
 void HeartRateTask::PushMessage(HeartRateTask::Messages msg) {
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
   xQueueSendFromISR(messageQueue, &msg, &xHigherPriorityTaskWoken);
@@ -110,6 +189,9 @@ void HeartRateTask::StartMeasurement() {
   heartRateSensor.Enable();
   ppg.Reset(true);
   vTaskDelay(100);
+  samplingStart = xTaskGetTickCount();
+  nextSample = samplingStart;
+  sampleCount = 0;
 }
 
 void HeartRateTask::StopMeasurement() {
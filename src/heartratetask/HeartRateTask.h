@@ -11,6 +11,8 @@ namespace Pinetime {
 
   namespace Controllers {
     class HeartRateController;
+    class HeartRateHistory;
+    class MotionController;
   }
 
   namespace Applications {
@@ -19,7 +21,10 @@ namespace Pinetime {
       enum class Messages : uint8_t { GoToSleep, WakeUp, StartMeasurement, StopMeasurement };
       enum class States { Idle, Running };
 
-      explicit HeartRateTask(Drivers::Hrs3300& heartRateSensor, Controllers::HeartRateController& controller);
+      HeartRateTask(Drivers::Hrs3300& heartRateSensor,
+                    Controllers::HeartRateController& controller,
+                    Controllers::HeartRateHistory& history,
+                    const Controllers::MotionController& motionController);
       void Start();
       void Work();
       void PushMessage(Messages msg);
@@ -28,14 +33,40 @@ namespace Pinetime {
       static void Process(void* instance);
       void StartMeasurement();
       void StopMeasurement();
+      void HandleBackgroundMeasurement();
+      bool Sampling() const;
+      TickType_t SampleDeadline(uint32_t index) const;
+      int8_t AcquireSample();
+
+      // The sensor is switched on every backgroundMeasurementPeriod, until backgroundMeasurementValidReadings
+      // consecutive readings with at least backgroundMeasurementMinConfidence are available or backgroundMeasurementTimeout
+      // has elapsed
+      static constexpr TickType_t backgroundMeasurementPeriod = pdMS_TO_TICKS(10 * 60 * 1000);
+      static constexpr TickType_t backgroundMeasurementTimeout = pdMS_TO_TICKS(30 * 1000);
+      static constexpr uint8_t backgroundMeasurementValidReadings = 5;
+      static constexpr uint8_t backgroundMeasurementMinConfidence = 50;
 
       TaskHandle_t taskHandle;
       QueueHandle_t messageQueue;
       States state = States::Running;
       Drivers::Hrs3300& heartRateSensor;
       Controllers::HeartRateController& controller;
+      Controllers::HeartRateHistory& history;
+      const Controllers::MotionController& motionController;
       Controllers::Ppg ppg;
       bool measurementStarted = false;
+
+      // Samples are acquired on a fixed grid of Ppg::deltaTms starting at samplingStart, independently of the messages
+      // received in the meantime
+      TickType_t samplingStart = 0;
+      TickType_t nextSample = 0;
+      uint32_t sampleCount = 0;
+
+      bool backgroundMeasurementStarted = false;
+      TickType_t nextBackgroundMeasurement = 0;
+      TickType_t backgroundMeasurementEnd = 0;
+      uint8_t backgroundValidReadings = 0;
+      int backgroundBpm = 0;
     };
 
   }
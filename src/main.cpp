@@ -35,6 +35,8 @@
 #include "components/motor/MotorController.h"
 #include "components/datetime/DateTimeController.h"
 #include "components/heartrate/HeartRateController.h"
+#include "components/heartrate/HeartRateHistory.h"
+#include "components/motion/StepHistory.h"
 #include "components/fs/FS.h"
 #include "drivers/Spi.h"
 #include "drivers/SpiMaster.h"
@@ -94,17 +96,20 @@ Pinetime::Controllers::Battery batteryController;
 Pinetime::Controllers::Ble bleController;
 
 Pinetime::Controllers::HeartRateController heartRateController;
-Pinetime::Applications::HeartRateTask heartRateApp(heartRateSensor, heartRateController);
 
 Pinetime::Controllers::FS fs {spiNorFlash};
 Pinetime::Controllers::Settings settingsController {fs};
 Pinetime::Controllers::MotorController motorController {};
 
 Pinetime::Controllers::DateTime dateTimeController {settingsController};
+Pinetime::Controllers::HeartRateHistory heartRateHistory {fs, dateTimeController};
 Pinetime::Drivers::Watchdog watchdog;
-Pinetime::Controllers::NotificationManager notificationManager;
+Pinetime::Controllers::NotificationManager notificationManager {fs};
 Pinetime::Controllers::MotionController motionController;
-Pinetime::Controllers::AlarmController alarmController {dateTimeController};
+Pinetime::Applications::HeartRateTask heartRateApp(heartRateSensor, heartRateController, heartRateHistory, motionController);
+Pinetime::Controllers::StepHistory stepHistory {fs};
+Pinetime::Controllers::Scheduler scheduler {dateTimeController};
+Pinetime::Controllers::AlarmController alarmController {dateTimeController, scheduler};
 Pinetime::Controllers::TouchHandler touchHandler;
 Pinetime::Controllers::ButtonHandler buttonHandler;
 Pinetime::Controllers::BrightnessController brightnessController {};
@@ -117,10 +122,13 @@ Pinetime::Applications::DisplayApp displayApp(lcd,
                                               watchdog,
                                               notificationManager,
                                               heartRateController,
+                                              heartRateHistory,
                                               settingsController,
                                               motorController,
                                               motionController,
+                                              stepHistory,
                                               alarmController,
+                                              scheduler,
                                               brightnessController,
                                               touchHandler,
                                               fs);
@@ -133,13 +141,16 @@ Pinetime::System::SystemTask systemTask(spi,
                                         bleController,
                                         dateTimeController,
                                         alarmController,
+                                        scheduler,
                                         watchdog,
                                         notificationManager,
                                         heartRateSensor,
                                         motionController,
+                                        stepHistory,
                                         motionSensor,
                                         settingsController,
                                         heartRateController,
+                                        heartRateHistory,
                                         displayApp,
                                         heartRateApp,
                                         fs,
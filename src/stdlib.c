@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <FreeRTOS.h>
+#include "heap_4_infinitime.h"
 
 // Override malloc() and free() to use the memory manager from FreeRTOS.
 // According to the documentation of libc, we also need to override
@@ -7,7 +8,12 @@
 // See https://www.gnu.org/software/libc/manual/html_node/Replacing-malloc.html
 
 void* malloc(size_t size) {
+#if (configHEAP_TRACK_CALLERS == 1)
+  // Account the allocation to the caller of malloc() rather than to malloc() itself
+  return pvPortMallocFrom(size, __builtin_return_address(0));
+#else
   return pvPortMalloc(size);
+#endif
 }
 
 void free(void* ptr) {
@@ -21,7 +27,6 @@ void* calloc(size_t num, size_t size) {
   return NULL;
 }
 
-void *pvPortRealloc(void *ptr, size_t xWantedSize);
 void* realloc( void *ptr, size_t newSize) {
   return pvPortRealloc(ptr, newSize);
 }
@@ -1,8 +1,10 @@
 #pragma once
 #include <cstdint>
+#include "utility/MessagePayload.h"
 
 namespace Pinetime {
   namespace System {
+    // Coalesced messages must stay in the first 32 (see Utility::MessageQueue)
     enum class Messages : uint8_t {
       GoToSleep,
       GoToRunning,
@@ -26,10 +28,21 @@ namespace Pinetime {
       OnPairing,
       SetOffAlarm,
       MeasureBatteryTimerExpired,
+      WeatherExpiryTimerExpired,
+      SaveHistoryTimerExpired,
       BatteryPercentageUpdated,
       StartFileTransfer,
       StopFileTransfer,
-      BleRadioEnableToggle
+      BleRadioEnableToggle,
+      UpdateBleConnection
+    };
+  }
+
+  namespace Utility {
+    template <>
+    struct MessagePayload<System::Messages::BatteryPercentageUpdated> {
+      // Percentage of the battery remaining
+      using Type = uint8_t;
     };
   }
 }
@@ -1,4 +1,69 @@
-#include "systemtask/SystemTask.h"
+#include "systemtask/SystemMonitor.h"
+#include "heap_4_infinitime.h"
+
+namespace {
+  // Updated by the kernel (see FreeRTOSConfig.h)
+  volatile uint32_t taskWakeups[Pinetime::System::SystemMonitor::maxTaskNumber + 1];
+  volatile uint32_t sleepTicks = 0;
+}
+
+extern "C" {
+void SystemMonitorTaskSwitchedIn(uint32_t taskNumber) {
+  if (taskNumber <= Pinetime::System::SystemMonitor::maxTaskNumber) {
+    taskWakeups[taskNumber] = taskWakeups[taskNumber] + 1;
+  }
+}
+
+void SystemMonitorTicksSlept(uint32_t ticks) {
+  sleepTicks = sleepTicks + ticks;
+}
+}
+
+uint16_t Pinetime::System::SystemMonitor::CpuLoad(const Profile& profile, uint32_t cycles) {
+  if (profile.duration == 0) {
+    return 0;
+  }
+  uint64_t cyclesInProfile = static_cast<uint64_t>(profile.duration) * cyclesPerMicrosecond * 1000000 / configTICK_RATE_HZ;
+  return static_cast<uint16_t>(std::min<uint64_t>(static_cast<uint64_t>(cycles) * 1000 / cyclesInProfile, 1000));
+}
+
+void Pinetime::System::SystemMonitor::OnAppExit(Applications::Apps app) {
+  if (app == Applications::Apps::None) {
+    return;
+  }
+  auto bytes = static_cast<uint16_t>(configTOTAL_HEAP_SIZE - xPortGetHeapWatermark());
+  auto* end = appHeapPeaks.begin() + nbAppHeapPeaks;
+  auto* entry = std::find_if(appHeapPeaks.begin(), end, [app](const AppHeapPeak& peak) {
+    return peak.app == app;
+  });
+
+  if (entry == end) {
+    if (nbAppHeapPeaks < maxAppHeapPeaks) {
+      nbAppHeapPeaks++;
+    } else if (bytes > appHeapPeaks.back().bytes) {
+      // Full: drop the smallest peak
+      entry = &appHeapPeaks.back();
+    } else {
+      return;
+    }
+    *entry = {app, bytes};
+  } else if (bytes > entry->bytes) {
+    entry->bytes = bytes;
+  } else {
+    return;
+  }
+
+  // Keep the entries sorted, only the updated entry can be out of place
+  while (entry != appHeapPeaks.begin() && (entry - 1)->bytes < entry->bytes) {
+    std::swap(*entry, *(entry - 1));
+    entry--;
+  }
+}
+
+void Pinetime::System::SystemMonitor::OnAppExited() {
+  vPortResetHeapWatermark();
+}
+
 #if configUSE_TRACE_FACILITY == 1
   // FreeRtosMonitor
   #include <FreeRTOS.h>
@@ -6,18 +71,51 @@
   #include <nrf_log.h>
 
 void Pinetime::System::SystemMonitor::Process() {
-  if (xTaskGetTickCount() - lastTick > 10000) {
-    NRF_LOG_INFO("---------------------------------------\nFree heap : %d", xPortGetFreeHeapSize());
-    TaskStatus_t tasksStatus[10];
-    auto nb = uxTaskGetSystemState(tasksStatus, 10, nullptr);
-    for (uint32_t i = 0; i < nb; i++) {
-      NRF_LOG_INFO("Task [%s] - %d", tasksStatus[i].pcTaskName, tasksStatus[i].usStackHighWaterMark);
-      if (tasksStatus[i].usStackHighWaterMark < 20)
-        NRF_LOG_INFO("WARNING!!! Task %s task is nearly full, only %dB available",
-                     tasksStatus[i].pcTaskName,
-                     tasksStatus[i].usStackHighWaterMark * 4);
+  TickType_t now = xTaskGetTickCount();
+  if (now - lastTick < samplePeriod) {
+    return;
+  }
+
+  TaskStatus_t tasksStatus[maxTasks];
+  auto nb = uxTaskGetSystemState(tasksStatus, maxTasks, nullptr);
+  uint32_t totalSleepTicks = sleepTicks;
+
+  profile.duration = now - lastTick;
+  profile.sleepTicks = totalSleepTicks - lastSleepTicks;
+  profile.freeHeap = xPortGetFreeHeapSize();
+  profile.nbTasks = nb;
+  lastTick = now;
+  lastSleepTicks = totalSleepTicks;
+
+  HeapStatistics_t heapStatistics;
+  vPortGetHeapStatistics(&heapStatistics);
+  NRF_LOG_INFO("---------------------------------------\nFree heap : %d", profile.freeHeap);
+  NRF_LOG_INFO("Largest free block : %d (%d blocks)", heapStatistics.xSizeOfLargestFreeBlockInBytes, heapStatistics.xNumberOfFreeBlocks);
+  NRF_LOG_INFO("Sleep : %d/%d ticks", profile.sleepTicks, profile.duration);
+  for (uint32_t i = 0; i < nb; i++) {
+    const auto& status = tasksStatus[i];
+    auto& task = profile.tasks[i];
+    std::copy_n(status.pcTaskName, configMAX_TASK_NAME_LEN, task.name);
+    task.number = status.xTaskNumber;
+    task.stackHighWaterMark = status.usStackHighWaterMark;
+    task.cycles = 0;
+    task.wakeups = 0;
+    if (status.xTaskNumber <= maxTaskNumber) {
+      // Both counters wrap around, only their difference is meaningful
+      task.cycles = status.ulRunTimeCounter - lastCycles[status.xTaskNumber];
+      lastCycles[status.xTaskNumber] = status.ulRunTimeCounter;
+      uint32_t wakeups = taskWakeups[status.xTaskNumber];
+      task.wakeups = wakeups - lastWakeups[status.xTaskNumber];
+      lastWakeups[status.xTaskNumber] = wakeups;
     }
-    lastTick = xTaskGetTickCount();
+
+    NRF_LOG_INFO("Task [%s] - %d - CPU %d/1000 - %d wakeups",
+                 status.pcTaskName,
+                 status.usStackHighWaterMark,
+                 CpuLoad(profile, task.cycles),
+                 task.wakeups);
+    if (status.usStackHighWaterMark < 20)
+      NRF_LOG_INFO("WARNING!!! Task %s task is nearly full, only %dB available", status.pcTaskName, status.usStackHighWaterMark * 4);
   }
 }
 #else
@@ -1,16 +1,153 @@
 #pragma once
 #include <FreeRTOS.h> // declares configUSE_TRACE_FACILITY
 #include <task.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "systemtask/Messages.h"
+#include "displayapp/Messages.h"
+#include "displayapp/apps/Apps.h"
 
 namespace Pinetime {
   namespace System {
+    // Core clock of the nRF52832, at which the run time counter (the DWT cycle counter) runs
+    static constexpr uint32_t cyclesPerMicrosecond = 64;
+
+    /*
+     * Time spent handling each message received by a task, in CPU cycles converted to microseconds. The cycle counter
+     * doesn't run while the CPU sleeps, but the time during which the task is preempted by other tasks is included.
+     */
+    template <class Message, size_t NbMessages = 32>
+    class MessageProfiler {
+    public:
+      struct Entry {
+        uint16_t count = 0;
+        uint16_t maxMicroseconds = 0;
+        uint32_t totalMicroseconds = 0;
+      };
+
+      void Start() {
+        start = portGET_RUN_TIME_COUNTER_VALUE();
+      }
+
+      void Stop(Message msg) {
+        auto index = static_cast<size_t>(msg);
+        if (index >= NbMessages) {
+          return;
+        }
+        uint32_t microseconds = (portGET_RUN_TIME_COUNTER_VALUE() - start) / cyclesPerMicrosecond;
+        Entry& entry = entries[index];
+        if (entry.count < UINT16_MAX) {
+          entry.count++;
+        }
+        entry.maxMicroseconds = std::max<uint32_t>(entry.maxMicroseconds, std::min<uint32_t>(microseconds, UINT16_MAX));
+        entry.totalMicroseconds += microseconds;
+      }
+
+      static constexpr size_t Size() {
+        return NbMessages;
+      }
+
+      const Entry& Get(size_t index) const {
+        return entries[index];
+      }
+
+    private:
+      uint32_t start = 0;
+      std::array<Entry, NbMessages> entries {};
+    };
+
+    /*
+     * Profiles the CPU usage of the tasks.
+     *
+     * Every samplePeriod, Process() computes the CPU cycles each task ran and the number of times it was switched in
+     * (wakeups) since the previous sample, along with the time spent in tickless idle. The cycle counter stops while the
+     * CPU sleeps, so the idle task is only accounted for the time it runs.
+     *
+     * It also records the peak heap usage while each app is shown, from the heap watermark.
+     */
     class SystemMonitor {
     public:
+      static constexpr TickType_t samplePeriod = 10 * configTICK_RATE_HZ;
+      static constexpr uint8_t maxTasks = 10;
+      // Tasks are numbered from 1, in their creation order
+      static constexpr uint8_t maxTaskNumber = 15;
+      static constexpr uint8_t maxAppHeapPeaks = 8;
+
+      struct TaskProfile {
+        char name[configMAX_TASK_NAME_LEN];
+        uint8_t number;
+        uint16_t stackHighWaterMark;
+        uint32_t cycles;
+        uint32_t wakeups;
+      };
+
+      struct AppHeapPeak {
+        Applications::Apps app;
+        // Heap in use (by every task) at the peak
+        uint16_t bytes;
+      };
+
+      struct Profile {
+        TickType_t duration = 0;
+        TickType_t sleepTicks = 0;
+        uint32_t freeHeap = 0;
+        uint8_t nbTasks = 0;
+        std::array<TaskProfile, maxTasks> tasks {};
+      };
+
       void Process();
-#if configUSE_TRACE_FACILITY == 1
+
+      // Last complete sample
+      const Profile& LastProfile() const {
+        return profile;
+      }
+
+      // CPU load of a task during the given profile, in permille
+      static uint16_t CpuLoad(const Profile& profile, uint32_t cycles);
+
+      // Called by DisplayApp before the screen of the app is deleted, and after it's deleted
+      void OnAppExit(Applications::Apps app);
+      void OnAppExited();
+
+      // Apps with the largest peak heap usage, largest first
+      uint8_t NbAppHeapPeaks() const {
+        return nbAppHeapPeaks;
+      }
+
+      const AppHeapPeak& GetAppHeapPeak(uint8_t index) const {
+        return appHeapPeaks[index];
+      }
+
+      MessageProfiler<Messages>& SystemMessages() {
+        return systemMessages;
+      }
+
+      const MessageProfiler<Messages>& SystemMessages() const {
+        return systemMessages;
+      }
+
+      MessageProfiler<Applications::Display::Messages>& DisplayMessages() {
+        return displayMessages;
+      }
+
+      const MessageProfiler<Applications::Display::Messages>& DisplayMessages() const {
+        return displayMessages;
+      }
+
     private:
-      mutable TickType_t lastTick = 0;
-#endif
+      TickType_t lastTick = 0;
+      uint32_t lastSleepTicks = 0;
+      std::array<uint32_t, maxTaskNumber + 1> lastCycles {};
+      std::array<uint32_t, maxTaskNumber + 1> lastWakeups {};
+      Profile profile;
+
+      std::array<AppHeapPeak, maxAppHeapPeaks> appHeapPeaks {};
+      uint8_t nbAppHeapPeaks = 0;
+
+      MessageProfiler<Messages> systemMessages;
+      MessageProfiler<Applications::Display::Messages> displayMessages;
     };
   }
 }
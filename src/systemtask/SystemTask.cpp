@@ -27,11 +27,21 @@ namespace {
   }
 }
 
-void MeasureBatteryTimerCallback(TimerHandle_t xTimer) {
-  auto* sysTask = static_cast<SystemTask*>(pvTimerGetTimerID(xTimer));
+void MeasureBatteryTimerCallback(void* instance) {
+  auto* sysTask = static_cast<SystemTask*>(instance);
   sysTask->PushMessage(Pinetime::System::Messages::MeasureBatteryTimerExpired);
 }
 
+void WeatherExpiryTimerCallback(void* instance) {
+  auto* sysTask = static_cast<SystemTask*>(instance);
+  sysTask->PushMessage(Pinetime::System::Messages::WeatherExpiryTimerExpired);
+}
+
+void SaveHistoryTimerCallback(void* instance) {
+  auto* sysTask = static_cast<SystemTask*>(instance);
+  sysTask->PushMessage(Pinetime::System::Messages::SaveHistoryTimerExpired);
+}
+
 SystemTask::SystemTask(Drivers::SpiMaster& spi,
                        Pinetime::Drivers::SpiNorFlash& spiNorFlash,
                        Drivers::TwiMaster& twiMaster,
@@ -40,13 +50,16 @@ SystemTask::SystemTask(Drivers::SpiMaster& spi,
                        Controllers::Ble& bleController,
                        Controllers::DateTime& dateTimeController,
                        Controllers::AlarmController& alarmController,
+                       Controllers::Scheduler& scheduler,
                        Drivers::Watchdog& watchdog,
                        Pinetime::Controllers::NotificationManager& notificationManager,
                        Pinetime::Drivers::Hrs3300& heartRateSensor,
                        Pinetime::Controllers::MotionController& motionController,
+                       Pinetime::Controllers::StepHistory& stepHistory,
                        Pinetime::Drivers::Bma421& motionSensor,
                        Controllers::Settings& settingsController,
                        Pinetime::Controllers::HeartRateController& heartRateController,
+                       Pinetime::Controllers::HeartRateHistory& heartRateHistory,
                        Pinetime::Applications::DisplayApp& displayApp,
                        Pinetime::Applications::HeartRateTask& heartRateApp,
                        Pinetime::Controllers::FS& fs,
@@ -60,13 +73,16 @@ SystemTask::SystemTask(Drivers::SpiMaster& spi,
     bleController {bleController},
     dateTimeController {dateTimeController},
     alarmController {alarmController},
+    scheduler {scheduler},
     watchdog {watchdog},
     notificationManager {notificationManager},
     heartRateSensor {heartRateSensor},
     motionSensor {motionSensor},
     settingsController {settingsController},
     heartRateController {heartRateController},
+    heartRateHistory {heartRateHistory},
     motionController {motionController},
+    stepHistory {stepHistory},
     displayApp {displayApp},
     heartRateApp(heartRateApp),
     fs {fs},
@@ -79,17 +95,39 @@ SystemTask::SystemTask(Drivers::SpiMaster& spi,
                      batteryController,
                      spiNorFlash,
                      heartRateController,
+                     heartRateHistory,
                      motionController,
+                     stepHistory,
                      fs) {
 }
 
 void SystemTask::Start() {
-  systemTasksMsgQueue = xQueueCreate(10, 1);
-  if (pdPASS != xTaskCreate(SystemTask::Process, "MAIN", 350, this, 1, &taskHandle)) {
+  // Messages that only signal a state change, handled by reading the latest state
+  messageQueue.Create({Messages::OnNewTime,
+                       Messages::OnChargingEvent,
+                       Messages::MeasureBatteryTimerExpired,
+                       Messages::WeatherExpiryTimerExpired,
+                       Messages::SaveHistoryTimerExpired,
+                       Messages::BatteryPercentageUpdated,
+                       Messages::UpdateBleConnection});
+  eventBus.Subscribe({Topics::TimeChanged, Topics::BatteryLevel}, this, OnEvent);
+  if (pdPASS != xTaskCreate(SystemTask::Process, "MAIN", 450, this, 1, &taskHandle)) {
     APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
   }
 }
 
+void SystemTask::OnEvent(void* instance, Topics topic, uint32_t payload) {
+  auto* systemTask = static_cast<SystemTask*>(instance);
+  switch (topic) {
+    case Topics::TimeChanged:
+      systemTask->PushMessage(Messages::OnNewTime);
+      break;
+    case Topics::BatteryLevel:
+      systemTask->PushMessage({Messages::BatteryPercentageUpdated, payload});
+      break;
+  }
+}
+
 void SystemTask::Process(void* instance) {
   auto* app = static_cast<SystemTask*>(instance);
   NRF_LOG_INFO("systemtask task started!");
@@ -109,6 +147,8 @@ void SystemTask::Work() {
   spiNorFlash.Wakeup();
 
   fs.Init();
+  // Before the BLE stack, which pushes the notifications received
+  notificationManager.Init();
 
   nimbleController.Init();
 
@@ -134,6 +174,8 @@ void SystemTask::Work() {
   motionSensor.Init();
   motionController.Init(motionSensor.DeviceType());
   settingsController.Init();
+  stepHistory.Init();
+  heartRateHistory.Init();
 
   displayApp.Register(this);
   displayApp.Register(&nimbleController.weather());
@@ -175,16 +217,19 @@ void SystemTask::Work() {
 
   batteryController.MeasureVoltage();
 
-  measureBatteryTimer = xTimerCreate("measureBattery", batteryMeasurementPeriod, pdTRUE, this, MeasureBatteryTimerCallback);
-  xTimerStart(measureBatteryTimer, portMAX_DELAY);
+  scheduler.SchedulePeriodic(batteryMeasurementPeriod, batteryMeasurementSlack, MeasureBatteryTimerCallback, this);
+  scheduler.SchedulePeriodic(weatherExpiryPeriod, weatherExpirySlack, WeatherExpiryTimerCallback, this);
+  scheduler.SchedulePeriodic(saveHistoryPeriod, saveHistorySlack, SaveHistoryTimerCallback, this);
 
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "EndlessLoop"
   while (true) {
     UpdateMotion();
 
-    Messages msg;
-    if (xQueueReceive(systemTasksMsgQueue, &msg, 100) == pdTRUE) {
+    MessageQueue::Event event;
+    if (messageQueue.Receive(event, 100)) {
+      Messages msg = event.message;
+      monitor.SystemMessages().Start();
       switch (msg) {
         case Messages::EnableSleeping:
           // Make sure that exiting an app doesn't enable sleeping,
@@ -240,11 +285,11 @@ void SystemTask::Work() {
           heartRateApp.PushMessage(Pinetime::Applications::HeartRateTask::Messages::GoToSleep);
           break;
         case Messages::OnNewTime:
+          // DisplayApp is notified by the event bus
           displayApp.PushMessage(Pinetime::Applications::Display::Messages::RestoreBrightness);
-          displayApp.PushMessage(Pinetime::Applications::Display::Messages::UpdateDateTime);
-          if (alarmController.State() == Controllers::AlarmController::AlarmState::Set) {
-            alarmController.ScheduleAlarm();
-          }
+          scheduler.OnTimeChanged();
+          alarmController.OnTimeChanged();
+          nimbleController.weather().UpdateExpiry();
           break;
         case Messages::OnNewNotification:
           if (settingsController.GetNotificationStatus() == Pinetime::Controllers::Settings::Notification::On) {
@@ -273,12 +318,14 @@ void SystemTask::Work() {
             GoToRunning();
           }
           displayApp.PushMessage(Pinetime::Applications::Display::Messages::BleFirmwareUpdateStarted);
+          nimbleController.StartWorkload(Controllers::ConnectionPolicy::Workloads::FirmwareUpdate);
           break;
         case Messages::BleFirmwareUpdateFinished:
           if (bleController.State() == Pinetime::Controllers::Ble::FirmwareUpdateStates::Validated) {
             NVIC_SystemReset();
           }
           doNotGoToSleep = false;
+          nimbleController.StopWorkload(Controllers::ConnectionPolicy::Workloads::FirmwareUpdate);
           break;
         case Messages::StartFileTransfer:
           NRF_LOG_INFO("[systemtask] FS Started");
@@ -286,11 +333,13 @@ void SystemTask::Work() {
           if (state == SystemTaskState::Sleeping) {
             GoToRunning();
           }
+          nimbleController.StartWorkload(Controllers::ConnectionPolicy::Workloads::FileTransfer);
           // TODO add intent of fs access icon or something
           break;
         case Messages::StopFileTransfer:
           NRF_LOG_INFO("[systemtask] FS Stopped");
           doNotGoToSleep = false;
+          nimbleController.StopWorkload(Controllers::ConnectionPolicy::Workloads::FileTransfer);
           // TODO add intent of fs access icon or something
           break;
         case Messages::OnTouchEvent:
@@ -318,6 +367,9 @@ void SystemTask::Work() {
           HandleButtonAction(action);
         } break;
         case Messages::OnDisplayTaskSleeping:
+          // The filesystem is not available until the next wakeup
+          SaveHistory();
+
           if (BootloaderVersion::IsValid()) {
             // First versions of the bootloader do not expose their version and cannot initialize the SPI NOR FLASH
             // if it's in sleep mode. Avoid bricked device by disabling sleep mode on these versions.
@@ -338,10 +390,8 @@ void SystemTask::Work() {
           stepCounterMustBeReset = true;
           break;
         case Messages::OnNewHour:
-          using Pinetime::Controllers::AlarmController;
           if (settingsController.GetNotificationStatus() != Controllers::Settings::Notification::Sleep &&
-              settingsController.GetChimeOption() == Controllers::Settings::ChimesOption::Hours &&
-              alarmController.State() != AlarmController::AlarmState::Alerting) {
+              settingsController.GetChimeOption() == Controllers::Settings::ChimesOption::Hours && !alarmController.IsAlerting()) {
             // if sleeping, we can't send a chime to displayApp yet (SPI flash switched off)
             // request running first and repush the chime message
             if (state == SystemTaskState::Sleeping) {
@@ -353,10 +403,8 @@ void SystemTask::Work() {
           }
           break;
         case Messages::OnNewHalfHour:
-          using Pinetime::Controllers::AlarmController;
           if (settingsController.GetNotificationStatus() != Controllers::Settings::Notification::Sleep &&
-              settingsController.GetChimeOption() == Controllers::Settings::ChimesOption::HalfHours &&
-              alarmController.State() != AlarmController::AlarmState::Alerting) {
+              settingsController.GetChimeOption() == Controllers::Settings::ChimesOption::HalfHours && !alarmController.IsAlerting()) {
             // if sleeping, we can't send a chime to displayApp yet (SPI flash switched off)
             // request running first and repush the chime message
             if (state == SystemTaskState::Sleeping) {
@@ -377,8 +425,17 @@ void SystemTask::Work() {
         case Messages::MeasureBatteryTimerExpired:
           batteryController.MeasureVoltage();
           break;
+        case Messages::WeatherExpiryTimerExpired:
+          nimbleController.weather().UpdateExpiry();
+          break;
+        case Messages::SaveHistoryTimerExpired:
+          // While sleeping, the history was saved before the SPI flash was put to sleep
+          if (state == SystemTaskState::Running) {
+            SaveHistory();
+          }
+          break;
         case Messages::BatteryPercentageUpdated:
-          nimbleController.NotifyBatteryLevel(batteryController.PercentRemaining());
+          nimbleController.NotifyBatteryLevel(event.Payload<Messages::BatteryPercentageUpdated>());
           break;
         case Messages::OnPairing:
           if (state == SystemTaskState::Sleeping) {
@@ -393,9 +450,13 @@ void SystemTask::Work() {
             nimbleController.DisableRadio();
           }
           break;
+        case Messages::UpdateBleConnection:
+          nimbleController.UpdateConnection();
+          break;
         default:
           break;
       }
+      monitor.SystemMessages().Stop(msg);
     }
 
     if (isBleDiscoveryTimerRunning) {
@@ -409,6 +470,8 @@ void SystemTask::Work() {
       }
     }
 
+    scheduler.Poll();
+    dateTimeController.Poll();
     monitor.Process();
     NoInit_BackUpTime = dateTimeController.CurrentDateTime();
     if (nrf_gpio_pin_read(PinMap::Button) == 0) {
@@ -418,6 +481,14 @@ void SystemTask::Work() {
 #pragma clang diagnostic pop
 }
 
+void SystemTask::SaveHistory() {
+  // Each one only writes to the filesystem if it changed since the last save
+  stepHistory.SaveHistory();
+  heartRateHistory.SaveHistory();
+  notificationManager.SaveNotifications();
+  nimbleController.SaveBond();
+}
+
 void SystemTask::UpdateMotion() {
   if (state == SystemTaskState::GoingToSleep || state == SystemTaskState::WakingUp) {
     return;
@@ -425,7 +496,8 @@ void SystemTask::UpdateMotion() {
 
   if (state == SystemTaskState::Sleeping && !(settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::RaiseWrist) ||
                                               settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::Shake) ||
-                                              motionController.GetService()->IsMotionNotificationSubscribed())) {
+                                              motionController.GetService()->IsMotionNotificationSubscribed() ||
+                                              motionController.GetService()->IsMotionStreamSubscribed())) {
     return;
   }
 
@@ -437,6 +509,11 @@ void SystemTask::UpdateMotion() {
   auto motionValues = motionSensor.Process();
 
   motionController.Update(motionValues.x, motionValues.y, motionValues.z, motionValues.steps);
+  StreamMotion();
+
+  auto now = dateTimeController.CurrentDateTime();
+  auto day = std::chrono::duration_cast<std::chrono::hours>(now.time_since_epoch()).count() / 24;
+  stepHistory.Update(day, dateTimeController.Hours() * 60 + dateTimeController.Minutes(), motionValues.steps);
 
   if (settingsController.GetNotificationStatus() != Controllers::Settings::Notification::Sleep) {
     if ((settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::RaiseWrist) &&
@@ -452,6 +529,29 @@ void SystemTask::UpdateMotion() {
   }
 }
 
+void SystemTask::StreamMotion() {
+  auto* motionService = motionController.GetService();
+  bool streaming = motionService->IsMotionStreamSubscribed();
+  uint8_t downsampling = motionService->MotionStreamDownsampling();
+  if (streaming != motionSensor.IsFifoEnabled() || (streaming && downsampling != motionSensor.FifoDownsampling())) {
+    motionSensor.SetFifo(streaming, downsampling);
+    motionService->ResetMotionStream();
+  }
+  if (!streaming) {
+    return;
+  }
+
+  // Bounded, in case the frames are queued faster than they're sent
+  for (uint8_t i = 0; i < 4; i++) {
+    uint16_t skippedFrames = 0;
+    size_t nbFrames = motionSensor.ReadFifo(motionFrames.data(), Drivers::Bma421::maxFifoFrames, skippedFrames);
+    motionService->OnNewMotionFrames(motionFrames.data(), nbFrames, skippedFrames, motionSensor.FifoPeriodMs());
+    if (nbFrames < Drivers::Bma421::maxFifoFrames) {
+      break;
+    }
+  }
+}
+
 void SystemTask::HandleButtonAction(Controllers::ButtonActions action) {
   if (IsSleeping()) {
     return;
@@ -502,16 +602,14 @@ void SystemTask::OnTouchEvent() {
   }
 }
 
-void SystemTask::PushMessage(System::Messages msg) {
-  if (msg == Messages::GoToSleep && !doNotGoToSleep) {
+void SystemTask::PushMessage(MessageQueue::Event event) {
+  if (event.message == Messages::GoToSleep && !doNotGoToSleep) {
     state = SystemTaskState::GoingToSleep;
   }
 
   if (in_isr()) {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    xQueueSendFromISR(systemTasksMsgQueue, &msg, &xHigherPriorityTaskWoken);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    messageQueue.PushFromISR(event);
   } else {
-    xQueueSend(systemTasksMsgQueue, &msg, portMAX_DELAY);
+    messageQueue.Push(event, portMAX_DELAY);
   }
 }
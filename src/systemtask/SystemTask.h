@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <memory>
 
 #include <FreeRTOS.h>
@@ -7,15 +8,18 @@
 #include <task.h>
 #include <timers.h>
 #include <heartratetask/HeartRateTask.h>
+#include <components/heartrate/HeartRateHistory.h>
 #include <components/settings/Settings.h>
 #include <drivers/Bma421.h>
 #include <drivers/PinMap.h>
 #include <components/motion/MotionController.h>
+#include <components/motion/StepHistory.h>
 
 #include "systemtask/SystemMonitor.h"
 #include "components/ble/NimbleController.h"
 #include "components/ble/NotificationManager.h"
 #include "components/alarm/AlarmController.h"
+#include "components/scheduler/Scheduler.h"
 #include "components/fs/FS.h"
 #include "touchhandler/TouchHandler.h"
 #include "buttonhandler/ButtonHandler.h"
@@ -30,6 +34,9 @@
 
 #include "drivers/Watchdog.h"
 #include "systemtask/Messages.h"
+#include "systemtask/Topics.h"
+#include "utility/EventBus.h"
+#include "utility/MessageQueue.h"
 
 extern std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> NoInit_BackUpTime;
 
@@ -53,6 +60,9 @@ namespace Pinetime {
     class SystemTask {
     public:
       enum class SystemTaskState { Sleeping, Running, GoingToSleep, WakingUp };
+      using MessageQueue = Utility::MessageQueue<Messages, 10>;
+      // SystemTask and DisplayApp
+      using EventBus = Utility::EventBus<Topics, 2>;
       SystemTask(Drivers::SpiMaster& spi,
                  Pinetime::Drivers::SpiNorFlash& spiNorFlash,
                  Drivers::TwiMaster& twiMaster,
@@ -61,13 +71,16 @@ namespace Pinetime {
                  Controllers::Ble& bleController,
                  Controllers::DateTime& dateTimeController,
                  Controllers::AlarmController& alarmController,
+                 Controllers::Scheduler& scheduler,
                  Drivers::Watchdog& watchdog,
                  Pinetime::Controllers::NotificationManager& notificationManager,
                  Pinetime::Drivers::Hrs3300& heartRateSensor,
                  Pinetime::Controllers::MotionController& motionController,
+                 Pinetime::Controllers::StepHistory& stepHistory,
                  Pinetime::Drivers::Bma421& motionSensor,
                  Controllers::Settings& settingsController,
                  Pinetime::Controllers::HeartRateController& heartRateController,
+                 Pinetime::Controllers::HeartRateHistory& heartRateHistory,
                  Pinetime::Applications::DisplayApp& displayApp,
                  Pinetime::Applications::HeartRateTask& heartRateApp,
                  Pinetime::Controllers::FS& fs,
@@ -75,7 +88,7 @@ namespace Pinetime {
                  Pinetime::Controllers::ButtonHandler& buttonHandler);
 
       void Start();
-      void PushMessage(Messages msg);
+      void PushMessage(MessageQueue::Event event);
 
       void OnTouchEvent();
 
@@ -94,6 +107,18 @@ namespace Pinetime {
         return state == SystemTaskState::Sleeping || state == SystemTaskState::WakingUp;
       }
 
+      MessageQueue::Statistics QueueStatistics() const {
+        return messageQueue.GetStatistics();
+      }
+
+      EventBus& Events() {
+        return eventBus;
+      }
+
+      SystemMonitor& Monitor() {
+        return monitor;
+      }
+
     private:
       TaskHandle_t taskHandle;
 
@@ -106,14 +131,18 @@ namespace Pinetime {
       Pinetime::Controllers::Ble& bleController;
       Pinetime::Controllers::DateTime& dateTimeController;
       Pinetime::Controllers::AlarmController& alarmController;
-      QueueHandle_t systemTasksMsgQueue;
+      Pinetime::Controllers::Scheduler& scheduler;
+      MessageQueue messageQueue;
+      EventBus eventBus;
       Pinetime::Drivers::Watchdog& watchdog;
       Pinetime::Controllers::NotificationManager& notificationManager;
       Pinetime::Drivers::Hrs3300& heartRateSensor;
       Pinetime::Drivers::Bma421& motionSensor;
       Pinetime::Controllers::Settings& settingsController;
       Pinetime::Controllers::HeartRateController& heartRateController;
+      Pinetime::Controllers::HeartRateHistory& heartRateHistory;
       Pinetime::Controllers::MotionController& motionController;
+      Pinetime::Controllers::StepHistory& stepHistory;
 
       Pinetime::Applications::DisplayApp& displayApp;
       Pinetime::Applications::HeartRateTask& heartRateApp;
@@ -123,10 +152,10 @@ namespace Pinetime {
       Pinetime::Controllers::NimbleController nimbleController;
 
       static void Process(void* instance);
+      static void OnEvent(void* instance, Topics topic, uint32_t payload);
       void Work();
       bool isBleDiscoveryTimerRunning = false;
       uint8_t bleDiscoveryTimer = 0;
-      TimerHandle_t measureBatteryTimer;
       bool doNotGoToSleep = false;
       SystemTaskState state = SystemTaskState::Running;
 
@@ -134,9 +163,17 @@ namespace Pinetime {
       bool fastWakeUpDone = false;
 
       void GoToRunning();
+      void SaveHistory();
       void UpdateMotion();
+      void StreamMotion();
+      std::array<int16_t, 3 * Drivers::Bma421::maxFifoFrames> motionFrames;
       bool stepCounterMustBeReset = false;
       static constexpr TickType_t batteryMeasurementPeriod = pdMS_TO_TICKS(10 * 60 * 1000);
+      static constexpr TickType_t batteryMeasurementSlack = pdMS_TO_TICKS(60 * 1000);
+      static constexpr TickType_t weatherExpiryPeriod = pdMS_TO_TICKS(60 * 1000);
+      static constexpr TickType_t weatherExpirySlack = pdMS_TO_TICKS(10 * 1000);
+      static constexpr TickType_t saveHistoryPeriod = pdMS_TO_TICKS(60 * 1000);
+      static constexpr TickType_t saveHistorySlack = pdMS_TO_TICKS(30 * 1000);
 
       SystemMonitor monitor;
     };
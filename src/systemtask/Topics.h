@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include "utility/MessagePayload.h"
+
+namespace Pinetime {
+  namespace System {
+    // State notifications published on the event bus of SystemTask (see Utility::EventBus). At most 32 topics.
+    enum class Topics : uint8_t {
+      // The time was set
+      TimeChanged,
+      // Payload: percentage of the battery remaining
+      BatteryLevel,
+    };
+  }
+
+  namespace Utility {
+    template <>
+    struct MessagePayload<System::Topics::BatteryLevel> {
+      using Type = uint8_t;
+    };
+  }
+}
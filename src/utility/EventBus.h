@@ -0,0 +1,78 @@
+#pragma once
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include "utility/MessagePayload.h"
+
+namespace Pinetime {
+  namespace Utility {
+    /*
+     * Publishes state notifications (topics, enum values below 32 with an optional payload, see MessagePayload) to
+     * the tasks that subscribed to them, so that the publisher doesn't need to know them.
+     *
+     * Each subscriber forwards the topics to its own message queue, as coalesced messages (see MessageQueue):
+     * publishing never blocks, from tasks and interrupts, and a busy subscriber doesn't delay the others.
+     *
+     * Subscribers are registered when the tasks start, and are never removed.
+     */
+    template <class Topic, uint8_t MaxSubscribers>
+    class EventBus {
+      static_assert(std::is_enum_v<Topic>, "Topics must be enum values");
+
+    public:
+      // Called by the publisher, possibly from an interrupt: must not block
+      using Handler = void (*)(void* subscriber, Topic topic, uint32_t payload);
+
+      void Subscribe(std::initializer_list<Topic> topics, void* subscriber, Handler handler) {
+        uint32_t mask = 0;
+        for (auto topic : topics) {
+          mask |= Bit(topic);
+        }
+        taskENTER_CRITICAL();
+        configASSERT(nbSubscribers < MaxSubscribers);
+        subscribers[nbSubscribers] = {mask, subscriber, handler};
+        nbSubscribers++;
+        taskEXIT_CRITICAL();
+      }
+
+      void Publish(Topic topic) {
+        Dispatch(topic, 0);
+      }
+
+      template <Topic topic>
+      void Publish(PayloadType<topic> payload) {
+        Dispatch(topic, EncodePayload(payload));
+      }
+
+    private:
+      struct Subscriber {
+        uint32_t topics;
+        void* subscriber;
+        Handler handler;
+      };
+
+      static constexpr uint32_t Bit(Topic topic) {
+        auto value = static_cast<uint8_t>(topic);
+        return (value < 32) ? static_cast<uint32_t>(1) << value : 0;
+      }
+
+      void Dispatch(Topic topic, uint32_t payload) {
+        // Subscribers are only added, and each one is written before it's counted
+        uint8_t count = nbSubscribers.load();
+        for (uint8_t i = 0; i < count; i++) {
+          if ((subscribers[i].topics & Bit(topic)) != 0) {
+            subscribers[i].handler(subscribers[i].subscriber, topic, payload);
+          }
+        }
+      }
+
+      std::array<Subscriber, MaxSubscribers> subscribers {};
+      std::atomic<uint8_t> nbSubscribers {0};
+    };
+  }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Pinetime {
+  namespace Utility {
+    /*
+     * String stored in a fixed-size buffer, with a version incremented on every assignment.
+     *
+     * It's written by one task (a BLE service) and read by another (a screen): the reader compares the version with the
+     * last one it read, and only reads the text when it changed. The version is incremented once the text is written,
+     * so a reader that raced with the writer sees the new version and reads the text again on its next refresh.
+     */
+    template <size_t Capacity>
+    class InlineString {
+    public:
+      InlineString() = default;
+
+      explicit InlineString(std::string_view text) {
+        Assign(text);
+      }
+
+      // The text is truncated to the capacity
+      void Assign(std::string_view text) {
+        length = std::min(text.size(), Capacity);
+        std::copy_n(text.begin(), length, buffer.begin());
+        buffer[length] = '\0';
+        version.fetch_add(1, std::memory_order_release);
+      }
+
+      // NUL terminated
+      const char* CStr() const {
+        return buffer.data();
+      }
+
+      std::string_view View() const {
+        return {buffer.data(), length};
+      }
+
+      uint16_t Version() const {
+        return version.load(std::memory_order_acquire);
+      }
+
+    private:
+      // The last character stays NUL, so that a reader racing with the writer never reads past the buffer
+      std::array<char, Capacity + 1> buffer {};
+      size_t length = 0;
+      std::atomic<uint16_t> version {0};
+    };
+  }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace Pinetime {
+  namespace Utility {
+    /*
+     * Type of the payload carried by a message or a topic (an enum value), void if it has none. Specialized next to
+     * the enums of the messages, for instance:
+     *
+     *   template <>
+     *   struct MessagePayload<System::Messages::BatteryPercentageUpdated> {
+     *     using Type = uint8_t;
+     *   };
+     *
+     * Payloads are stored in 4 bytes, so they must be small trivially copyable values.
+     */
+    template <auto message>
+    struct MessagePayload {
+      using Type = void;
+    };
+
+    template <auto message>
+    using PayloadType = typename MessagePayload<message>::Type;
+
+    template <class T>
+    uint32_t EncodePayload(T value) {
+      static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(uint32_t), "Payloads are stored in 4 bytes");
+      uint32_t raw = 0;
+      std::memcpy(&raw, &value, sizeof(T));
+      return raw;
+    }
+
+    template <class T>
+    T DecodePayload(uint32_t raw) {
+      static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(uint32_t), "Payloads are stored in 4 bytes");
+      T value;
+      std::memcpy(&value, &raw, sizeof(T));
+      return value;
+    }
+  }
+}
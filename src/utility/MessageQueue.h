@@ -0,0 +1,184 @@
+#pragma once
+
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <semphr.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include "utility/MessagePayload.h"
+
+namespace Pinetime {
+  namespace Utility {
+    /*
+     * FIFO of messages (enum values) between tasks and interrupts. A message may carry a payload, whose type is given
+     * by the specialization of MessagePayload for this message.
+     *
+     * Coalesced messages are state notifications with latest-value semantics: while such a message is pending, it's
+     * not queued again, and it's received at the position of its first occurrence with the latest payload pushed. A
+     * slot of the queue is reserved for each of them, so that they never block and are never lost, from interrupts
+     * too. Their enum values must be below 32.
+     *
+     * The other messages share Size slots and are received in the order they were pushed. Push() waits for a free slot
+     * up to its timeout, and PushFromISR() drops the message if there is none, since interrupts can't wait.
+     */
+    template <class Message, UBaseType_t Size, uint8_t MaxCoalesced = 8>
+    class MessageQueue {
+      static_assert(std::is_enum_v<Message>, "Messages must be enum values");
+
+    public:
+      struct Event {
+        Message message;
+        uint32_t payload;
+
+        Event() = default;
+
+        // Implicit, so that messages without payload are pushed as is
+        Event(Message message, uint32_t payload = 0) : message {message}, payload {payload} {
+        }
+
+        template <Message msg>
+        static Event Make(PayloadType<msg> value) {
+          return {msg, EncodePayload(value)};
+        }
+
+        template <Message msg>
+        PayloadType<msg> Payload() const {
+          return DecodePayload<PayloadType<msg>>(payload);
+        }
+      };
+
+      struct Statistics {
+        uint8_t maxDepth;
+        uint32_t pushed;
+        uint32_t coalesced;
+        // Not pushed: no slot was freed before the timeout, or none was free for an interrupt
+        uint32_t dropped;
+      };
+
+      void Create(std::initializer_list<Message> coalescedMessages) {
+        for (auto msg : coalescedMessages) {
+          configASSERT(Bit(msg) != 0 && nbCoalesced < MaxCoalesced);
+          coalescedMask |= Bit(msg);
+          coalescedMessagesList[nbCoalesced++] = msg;
+        }
+        queue = xQueueCreate(Size + nbCoalesced, sizeof(Event));
+        slots = xSemaphoreCreateCounting(Size, Size);
+      }
+
+      // Returns false if the message was dropped
+      bool Push(Event event, TickType_t timeout) {
+        if (Coalesce(event)) {
+          return true;
+        }
+        if (!IsCoalesced(event.message) && xSemaphoreTake(slots, timeout) != pdTRUE) {
+          dropped++;
+          return false;
+        }
+        // A slot is reserved for the message, so the queue can't be full
+        xQueueSend(queue, &event, 0);
+        Account(uxQueueMessagesWaiting(queue));
+        return true;
+      }
+
+      bool PushFromISR(Event event) {
+        if (Coalesce(event)) {
+          return true;
+        }
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        if (!IsCoalesced(event.message) && xSemaphoreTakeFromISR(slots, &xHigherPriorityTaskWoken) != pdTRUE) {
+          dropped++;
+          return false;
+        }
+        xQueueSendFromISR(queue, &event, &xHigherPriorityTaskWoken);
+        Account(uxQueueMessagesWaitingFromISR(queue));
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+        return true;
+      }
+
+      bool Receive(Event& event, TickType_t timeout) {
+        if (xQueueReceive(queue, &event, timeout) != pdTRUE) {
+          return false;
+        }
+        int index = CoalescedIndex(event.message);
+        if (index >= 0) {
+          // Cleared before the payload is read, so that a newer payload is either read now or queued again
+          pending.fetch_and(~Bit(event.message));
+          event.payload = latestPayloads[index].load();
+        } else {
+          xSemaphoreGive(slots);
+        }
+        return true;
+      }
+
+      Statistics GetStatistics() const {
+        return {maxDepth, pushed, coalesced, dropped};
+      }
+
+    private:
+      static_assert(Size + MaxCoalesced <= UINT8_MAX, "Queue depth must fit in the statistics");
+
+      // Messages past the 32th can't be coalesced
+      static constexpr uint32_t Bit(Message msg) {
+        auto value = static_cast<uint8_t>(msg);
+        return (value < 32) ? static_cast<uint32_t>(1) << value : 0;
+      }
+
+      bool IsCoalesced(Message msg) const {
+        return (Bit(msg) & coalescedMask) != 0;
+      }
+
+      int CoalescedIndex(Message msg) const {
+        if (!IsCoalesced(msg)) {
+          return -1;
+        }
+        for (uint8_t i = 0; i < nbCoalesced; i++) {
+          if (coalescedMessagesList[i] == msg) {
+            return i;
+          }
+        }
+        return -1;
+      }
+
+      // Stores the latest payload of a coalesced message, and returns true if the message is already pending
+      bool Coalesce(const Event& event) {
+        int index = CoalescedIndex(event.message);
+        if (index < 0) {
+          return false;
+        }
+        latestPayloads[index] = event.payload;
+        uint32_t bit = Bit(event.message);
+        if ((pending.fetch_or(bit) & bit) != 0) {
+          coalesced++;
+          return true;
+        }
+        return false;
+      }
+
+      void Account(UBaseType_t depth) {
+        pushed++;
+        uint8_t previousMaxDepth = maxDepth.load();
+        while (depth > previousMaxDepth && !maxDepth.compare_exchange_weak(previousMaxDepth, static_cast<uint8_t>(depth))) {
+        }
+      }
+
+      QueueHandle_t queue = nullptr;
+      // Free slots for the messages that are not coalesced
+      SemaphoreHandle_t slots = nullptr;
+
+      uint32_t coalescedMask = 0;
+      std::array<Message, MaxCoalesced> coalescedMessagesList {};
+      uint8_t nbCoalesced = 0;
+      std::atomic<uint32_t> pending {0};
+      std::array<std::atomic<uint32_t>, MaxCoalesced> latestPayloads {};
+
+      // Updated by all the senders, from tasks and interrupts
+      std::atomic<uint8_t> maxDepth {0};
+      std::atomic<uint32_t> pushed {0};
+      std::atomic<uint32_t> coalesced {0};
+      std::atomic<uint32_t> dropped {0};
+    };
+  }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <FreeRTOS.h>
+#include <semphr.h>
+
+namespace Pinetime {
+  namespace Utility {
+    /*
+     * Recursive FreeRTOS mutex, for the state shared by several tasks that is too large or too slow to update in a
+     * critical section (file system accesses, for instance).
+     *
+     * It's created by Init(), which must be called before any other task uses it. It's recursive so that a locked
+     * method can call other locked methods of the same object.
+     */
+    class Mutex {
+    public:
+      void Init() {
+        handle = xSemaphoreCreateRecursiveMutex();
+      }
+
+      void Take() {
+        xSemaphoreTakeRecursive(handle, portMAX_DELAY);
+      }
+
+      void Give() {
+        xSemaphoreGiveRecursive(handle);
+      }
+
+    private:
+      SemaphoreHandle_t handle = nullptr;
+    };
+
+    // Holds the mutex until the end of the scope
+    class Lock {
+    public:
+      explicit Lock(Mutex& mutex) : mutex {mutex} {
+        mutex.Take();
+      }
+
+      ~Lock() {
+        mutex.Give();
+      }
+
+      Lock(const Lock&) = delete;
+      Lock& operator=(const Lock&) = delete;
+
+    private:
+      Mutex& mutex;
+    };
+  }
+}
@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+
+"""Benchmarks the BLE services of a watch running InfiniTime, with this computer as the central.
+
+Each scenario repeats an exchange with one service for the given duration, checks the responses of the watch (a protocol
+regression fails the run with a non-zero exit status) and reports the throughput and the latency of the exchanges.
+With --profile, the CPU used by the BLE tasks of the watch per exchange is computed from the Profiler Service (see
+doc/ProfilerService.md): the scenario runs until a whole profile was sampled while it was running.
+
+Requires bleak (pip install bleak).
+"""
+
+import argparse
+import asyncio
+import os
+import statistics
+import struct
+import sys
+import time
+
+from bleak import BleakClient, BleakError
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import motion_stream_decode  # noqa: E402
+
+FS_TRANSFER_UUID = "adaf0200-4669-6c65-5472-616e73666572"
+ANS_NEW_ALERT_UUID = "00002a46-0000-1000-8000-00805f9b34fb"
+WEATHER_DATA_UUID = "00050001-78fc-48fe-8e23-433b3a1942d0"
+MOTION_STREAM_UUID = "00030004-78fc-48fe-8e23-433b3a1942d0"
+PROFILE_UUID = "00070001-78fc-48fe-8e23-433b3a1942d0"
+
+CPU_FREQUENCY_HZ = 64000000
+BLE_TASKS = ("ble", "ll")
+RESPONSE_TIMEOUT = 5
+
+
+class ProtocolError(Exception):
+    pass
+
+
+class Stats:
+    def __init__(self):
+        self.exchanges = []  # (end time, latency in s, payload bytes)
+        self.lost = 0
+
+    def add(self, start, size):
+        end = time.monotonic()
+        self.exchanges.append((end, end - start, size))
+
+    def between(self, begin, end):
+        return [e for e in self.exchanges if begin <= e[0] < end]
+
+
+class Notifications:
+    """Queue of the notifications of a characteristic."""
+
+    def __init__(self, client, uuid):
+        self.client = client
+        self.uuid = uuid
+        self.queue = asyncio.Queue()
+
+    async def __aenter__(self):
+        await self.client.start_notify(self.uuid, lambda _, data: self.queue.put_nowait(bytes(data)))
+        return self
+
+    async def __aexit__(self, *args):
+        await self.client.stop_notify(self.uuid)
+
+    async def get(self):
+        try:
+            return await asyncio.wait_for(self.queue.get(), RESPONSE_TIMEOUT)
+        except asyncio.TimeoutError:
+            raise ProtocolError("no response from the watch")
+
+
+def check_response(response, command, minimum_size):
+    if len(response) < minimum_size or response[0] != command:
+        raise ProtocolError("unexpected response {}".format(response.hex()))
+    status = struct.unpack_from("<b", response, 1)[0]
+    if status < 0:
+        raise ProtocolError("command 0x{:02x} failed with status {}".format(command, status))
+
+
+async def scenario_fs(client, stats, args):
+    """Writes a file with BLE FS, reads it back, compares it and deletes it."""
+    path = b"/benchmark.bin"
+    content = os.urandom(args.size)
+    # The chunks fill the ATT payload, after the header of the command (write) or of the response (read)
+    write_chunk_size = client.mtu_size - 3 - 12
+    read_chunk_size = client.mtu_size - 3 - 16
+    async with Notifications(client, FS_TRANSFER_UUID) as responses:
+        start = time.monotonic()
+        header = struct.pack("<BBHIQI", 0x20, 0, len(path), 0, time.time_ns(), len(content)) + path
+        await client.write_gatt_char(FS_TRANSFER_UUID, header, response=True)
+        check_response(await responses.get(), 0x21, 20)
+        stats.add(start, 0)
+        for offset in range(0, len(content), write_chunk_size):
+            chunk = content[offset:offset + write_chunk_size]
+            start = time.monotonic()
+            payload = struct.pack("<BBHII", 0x22, 1, 0, offset, len(chunk)) + chunk
+            await client.write_gatt_char(FS_TRANSFER_UUID, payload, response=True)
+            check_response(await responses.get(), 0x21, 20)
+            stats.add(start, len(chunk))
+
+        data = b""
+        request = struct.pack("<BBHII", 0x10, 0, len(path), 0, read_chunk_size) + path
+        while True:
+            start = time.monotonic()
+            await client.write_gatt_char(FS_TRANSFER_UUID, request, response=True)
+            response = await responses.get()
+            check_response(response, 0x11, 16)
+            offset, total, length = struct.unpack_from("<III", response, 4)
+            if offset != len(data) or length != len(response) - 16:
+                raise ProtocolError("unexpected chunk of {} bytes at {}".format(length, offset))
+            data += response[16:]
+            stats.add(start, length)
+            if len(data) >= total or length == 0:
+                break
+            request = struct.pack("<BBHII", 0x12, 1, 0, len(data), read_chunk_size)
+        if data != content:
+            raise ProtocolError("the file read back differs from the file written")
+
+        await client.write_gatt_char(FS_TRANSFER_UUID, struct.pack("<BBH", 0x30, 0, len(path)) + path, response=True)
+        check_response(await responses.get(), 0x31, 2)
+
+
+async def scenario_notifications(client, stats, args):
+    """Sends a burst of notifications through the Alert Notification Service."""
+    for i in range(args.burst):
+        message = "Benchmark {}\0notification {} of a burst of {}".format(i, i + 1, args.burst).encode()
+        payload = bytes([0, 1, 0]) + message
+        start = time.monotonic()
+        await client.write_gatt_char(ANS_NEW_ALERT_UUID, payload, response=True)
+        stats.add(start, len(payload))
+
+
+def hourly_forecast(timestamp, runs, nb_hours=48):
+    payload = struct.pack("<BBQBB", 2, 0, timestamp, nb_hours, len(runs))
+    for first, hours in runs:
+        payload += struct.pack("<BB", first, len(hours))
+        for temperature, icon, precipitation in hours:
+            payload += struct.pack("<hBB", temperature, icon, precipitation)
+    return payload
+
+
+async def scenario_weather(client, stats, args):
+    """Pushes the current weather, the forecast, a full hourly forecast and a delta, and checks that a malformed message
+    is rejected."""
+    # The timestamps are in local time
+    now = int(time.time()) + time.localtime().tm_gmtoff
+    hour = now - now % 3600
+    location = b"Benchmark".ljust(32, b"\0")
+    days = [(1000 + i * 100, 2000 + i * 100, i) for i in range(5)]
+    messages = [
+        struct.pack("<BBQhhh", 0, 0, now, 1500, 1000, 2000) + location + bytes([1]),
+        struct.pack("<BBQB", 1, 0, now, len(days)) + b"".join(struct.pack("<hhB", *day) for day in days),
+        hourly_forecast(hour, [(0, [(1000 + h * 10, h % 9, h * 2) for h in range(48)])]),
+        hourly_forecast(hour, [(3, [(1234, 4, 80)]), (47, [(900, 2, 10)])]),
+    ]
+    for payload in messages:
+        start = time.monotonic()
+        await client.write_gatt_char(WEATHER_DATA_UUID, payload, response=True)
+        stats.add(start, len(payload))
+
+    try:
+        await client.write_gatt_char(WEATHER_DATA_UUID, hourly_forecast(hour, [(46, [(0, 0, 0)] * 3)]), response=True)
+    except BleakError:
+        pass
+    else:
+        raise ProtocolError("a run past the end of the hourly forecast was accepted")
+
+
+async def scenario_motion(client, stats, args):
+    """Receives the accelerometer frames of the motion stream for one second."""
+    await client.write_gatt_char(MOTION_STREAM_UUID, bytes([args.downsampling]), response=True)
+    period_ms = 10 << args.downsampling
+    async with Notifications(client, MOTION_STREAM_UUID) as notifications:
+        end = time.monotonic() + 1
+        expected = None
+        while time.monotonic() < end:
+            start = time.monotonic()
+            payload = await notifications.get()
+            frames = motion_stream_decode.decode(payload, period_ms)
+            if expected is not None and frames[0][0] != expected:
+                stats.lost += (frames[0][0] - expected) & 0xFFFF
+            expected = (frames[-1][0] + 1) & 0xFFFF
+            stats.add(start, len(payload))
+
+
+SCENARIOS = {
+    "fs": scenario_fs,
+    "notifications": scenario_notifications,
+    "weather": scenario_weather,
+    "motion": scenario_motion,
+}
+
+
+def parse_profile(data):
+    """Returns the duration of the profile in seconds and the CPU cycles of the BLE tasks."""
+    _, nb_tasks, _, _, duration = struct.unpack_from("<BBBBI", data, 0)
+    cycles = 0
+    for i in range(nb_tasks):
+        name, task_cycles = struct.unpack_from("<4sI", data, 16 + 16 * i)
+        if name.split(b"\0")[0].decode(errors="replace") in BLE_TASKS:
+            cycles += task_cycles
+    return duration / 1024, cycles
+
+
+async def run(client, name, args):
+    stats = Stats()
+    scenario = SCENARIOS[name]
+    begin = time.monotonic()
+    deadline = begin + args.duration
+
+    # A profile is sampled every 10 seconds: the one read after the second change covers the time between the two
+    # changes, during which the scenario was running
+    profile = await client.read_gatt_char(PROFILE_UUID) if args.profile else None
+    changes = []
+    while time.monotonic() < deadline or (args.profile and len(changes) < 2):
+        await scenario(client, stats, args)
+        if args.profile:
+            new_profile = await client.read_gatt_char(PROFILE_UUID)
+            if new_profile != profile:
+                profile = new_profile
+                changes.append(time.monotonic())
+    end = time.monotonic()
+
+    latencies = [e[1] * 1000 for e in stats.exchanges]
+    size = sum(e[2] for e in stats.exchanges)
+    print("{}: {} exchanges in {:.1f}s, {:.1f} exchanges/s, {:.0f} B/s".format(
+        name, len(latencies), end - begin, len(latencies) / (end - begin), size / (end - begin)))
+    if latencies:
+        latencies.sort()
+        print("  latency (ms): mean {:.1f}, median {:.1f}, p95 {:.1f}, max {:.1f}".format(
+            statistics.mean(latencies), latencies[len(latencies) // 2], latencies[int(len(latencies) * 0.95)], latencies[-1]))
+    if name == "motion":
+        print("  {} frames lost".format(stats.lost))
+    if args.profile:
+        seconds, cycles = parse_profile(profile)
+        exchanges = len(stats.between(changes[0], changes[1]))
+        print("  BLE tasks: {:.2f}% CPU over {:.1f}s, {:.0f} us per exchange".format(
+            100 * cycles / (seconds * CPU_FREQUENCY_HZ), seconds, 1e6 * cycles / CPU_FREQUENCY_HZ / max(exchanges, 1)))
+
+
+async def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("address", help="BLE address of the watch (UUID on macOS)")
+    parser.add_argument("scenarios", nargs="*", default=list(SCENARIOS), help="scenarios to run (default: all): " + ", ".join(SCENARIOS))
+    parser.add_argument("--duration", type=float, default=10, help="minimum duration of each scenario in s (default: 10)")
+    parser.add_argument("--size", type=int, default=4096, help="size of the file of the fs scenario in bytes (default: 4096)")
+    parser.add_argument("--burst", type=int, default=10, help="notifications per burst (default: 10)")
+    parser.add_argument("--downsampling", type=int, default=0, help="rate of the motion stream, 100Hz / 2^downsampling (default: 0)")
+    parser.add_argument("--profile", action="store_true", help="measure the CPU used by the BLE tasks of the watch")
+    args = parser.parse_args()
+
+    unknown = [name for name in args.scenarios if name not in SCENARIOS]
+    if unknown:
+        parser.error("unknown scenarios: " + ", ".join(unknown))
+
+    failed = False
+    async with BleakClient(args.address) as client:
+        print("Connected, MTU {}".format(client.mtu_size))
+        for name in args.scenarios:
+            try:
+                await run(client, name, args)
+            except ProtocolError as error:
+                print("{}: FAILED: {}".format(name, error), file=sys.stderr)
+                failed = True
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(asyncio.run(main()))
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+
+"""Decodes the notifications of the motion stream characteristic (see doc/MotionService.md) into CSV frames."""
+
+import argparse
+import struct
+import sys
+
+
+def read_varint(data, offset):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        if byte & 0x80 == 0:
+            return value, offset
+        shift += 7
+
+
+def to_int16(value):
+    value &= 0xFFFF
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def decode(data, period_ms):
+    """Returns the (sequence, time_ms, x, y, z) frames of a notification."""
+    sequence, time_ms, x, y, z = struct.unpack_from("<HHhhh", data, 0)
+    frames = [(sequence, time_ms, x, y, z)]
+    offset = 10
+    while offset < len(data):
+        deltas = []
+        for _ in range(3):
+            zigzag, offset = read_varint(data, offset)
+            deltas.append((zigzag >> 1) ^ -(zigzag & 1))
+        x, y, z = (to_int16(value + delta) for value, delta in zip((x, y, z), deltas))
+        sequence = (sequence + 1) & 0xFFFF
+        time_ms = (time_ms + period_ms) & 0xFFFF
+        frames.append((sequence, time_ms, x, y, z))
+    return frames
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("notifications", nargs="?", help="file with one notification per line, as hex strings (default: stdin)")
+    parser.add_argument("--downsampling", type=int, choices=range(4), default=0,
+                        help="rate of the stream written to the watch, 100Hz / 2^downsampling (default: 0)")
+    args = parser.parse_args()
+
+    period_ms = 10 << args.downsampling
+    lines = open(args.notifications) if args.notifications else sys.stdin
+    print("sequence,time_ms,x,y,z")
+    expected = None
+    nb_frames = 0
+    nb_lost = 0
+    for line in lines:
+        line = line.strip().replace(":", "").replace(" ", "")
+        if not line:
+            continue
+        for frame in decode(bytes.fromhex(line), period_ms):
+            if expected is not None and frame[0] != expected:
+                nb_lost += (frame[0] - expected) & 0xFFFF
+            expected = (frame[0] + 1) & 0xFFFF
+            nb_frames += 1
+            print(",".join(str(value) for value in frame))
+    print("{} frames, {} lost".format(nb_frames, nb_lost), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
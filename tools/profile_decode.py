@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+
+"""Decodes the profile or the heap statistics read from the Profiler Service (see doc/ProfilerService.md)."""
+
+import argparse
+import struct
+import sys
+
+TICK_RATE_HZ = 1024
+CPU_FREQUENCY_HZ = 64000000
+QUEUES = ["System", "Display"]
+
+
+def decode(data):
+    version, nb_tasks, nb_messages, _, duration, sleep, free_heap = struct.unpack_from("<BBBBIII", data, 0)
+    if version != 1:
+        sys.exit("Unsupported profile version {}".format(version))
+    offset = 16
+    seconds = duration / TICK_RATE_HZ
+    print("Profile of {:.1f}s, sleeping {:.1f}%, free heap {}B".format(seconds, 100 * sleep / max(duration, 1), free_heap))
+
+    print("{:>3} {:<4} {:>7} {:>8} {:>6}".format("#", "Task", "CPU", "Wakeup/s", "Stack"))
+    for _ in range(nb_tasks):
+        name, cycles, wakeups, stack, number, _ = struct.unpack_from("<4sIIHBB", data, offset)
+        offset += 16
+        name = name.split(b"\0")[0].decode(errors="replace")
+        load = 100 * cycles / max(seconds * CPU_FREQUENCY_HZ, 1)
+        print("{:>3} {:<4} {:>6.2f}% {:>8.1f} {:>6}".format(number, name, load, wakeups / max(seconds, 1e-3), stack))
+
+    print("{:<8} {:>3} {:>6} {:>9} {:>9}".format("Queue", "Msg", "Count", "Max (us)", "Avg (us)"))
+    for _ in range(nb_messages):
+        queue, message, count, max_us, total_us = struct.unpack_from("<BBHHI", data, offset)
+        offset += 10
+        queue_name = QUEUES[queue] if queue < len(QUEUES) else str(queue)
+        print("{:<8} {:>3} {:>6} {:>9} {:>9}".format(queue_name, message, count, max_us, total_us // max(count, 1)))
+
+
+def decode_heap(data):
+    version, nb_buckets, nb_peaks, _ = struct.unpack_from("<BBBB", data, 0)
+    if version != 1:
+        sys.exit("Unsupported heap version {}".format(version))
+    (total, free, min_free, largest, smallest, nb_blocks, allocations, frees, failures) = struct.unpack_from("<9I", data, 4)
+    offset = 40
+    print("Heap {}B, free {}B (min {}B)".format(total, free, min_free))
+    print("{} free blocks of {}B to {}B, fragmentation {:.1f}%".format(nb_blocks, smallest, largest, 100 * (1 - largest / max(free, 1))))
+    print("{} allocations, {} frees, {} failures".format(allocations, frees, failures))
+
+    print("{:>8} {:>8}".format("Size", "Count"))
+    for bucket in range(nb_buckets):
+        (count,) = struct.unpack_from("<I", data, offset)
+        offset += 4
+        label = "> {}".format(16 << (bucket - 1)) if bucket == nb_buckets - 1 else "<= {}".format(16 << bucket)
+        print("{:>8} {:>8}".format(label, count))
+
+    print("{:>3} {:>8}".format("App", "Peak (B)"))
+    for _ in range(nb_peaks):
+        app, _, peak = struct.unpack_from("<BBH", data, offset)
+        offset += 4
+        print("{:>3} {:>8}".format(app, peak))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("profile", help="hex string of the characteristic value, or a file containing the raw value")
+    parser.add_argument("--heap", action="store_true", help="decode the heap characteristic instead of the profile")
+    args = parser.parse_args()
+    try:
+        data = bytes.fromhex(args.profile.replace(":", "").replace(" ", ""))
+    except ValueError:
+        with open(args.profile, "rb") as f:
+            data = f.read()
+    if args.heap:
+        decode_heap(data)
+    else:
+        decode(data)
+
+
+if __name__ == "__main__":
+    main()